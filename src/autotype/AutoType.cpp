@@ -24,6 +24,7 @@
 
 #include "config-keepassx.h"
 
+#include "autotype/AutoTypeIndex.h"
 #include "autotype/AutoTypePlatformPlugin.h"
 #include "autotype/AutoTypeSelectDialog.h"
 #include "autotype/WildcardMatcher.h"
@@ -339,8 +340,12 @@ void AutoType::performGlobalAutoType(const QList<QSharedPointer<Database>>& dbLi
     QList<AutoTypeMatch> matchList;
     bool hideExpired = config()->get(Config::AutoTypeHideExpiredEntry).toBool();
 
+    const bool matchTitle = config()->get(Config::AutoTypeEntryTitleMatch).toBool();
+    const bool matchUrl = config()->get(Config::AutoTypeEntryURLMatch).toBool();
+
     for (const auto& db : dbList) {
-        const QList<Entry*> dbEntries = db->rootGroup()->entriesRecursive();
+        // Only entries which can possibly match the window are checked in detail
+        const QList<Entry*> dbEntries = indexOf(db.data())->candidates(m_windowTitleForGlobal, matchTitle, matchUrl);
         for (Entry* entry : dbEntries) {
             if (hideExpired && entry->isExpired()) {
                 continue;
@@ -396,6 +401,29 @@ void AutoType::performGlobalAutoType(const QList<QSharedPointer<Database>>& dbLi
     }
 }
 
+/**
+ * Window matching index of the given database, created on first use
+ */
+AutoTypeIndex* AutoType::indexOf(Database* db)
+{
+    auto it = m_indexes.begin();
+    while (it != m_indexes.end()) {
+        if (!it.value()) {
+            it = m_indexes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    AutoTypeIndex* index = m_indexes.value(db);
+    if (!index) {
+        // owned by the database and deleted together with it
+        index = new AutoTypeIndex(db);
+        m_indexes.insert(db, index);
+    }
+    return index;
+}
+
 void AutoType::restoreWindowState()
 {
 #ifdef Q_OS_MAC
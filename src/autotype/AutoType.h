@@ -19,8 +19,10 @@
 #ifndef KEEPASSX_AUTOTYPE_H
 #define KEEPASSX_AUTOTYPE_H
 
+#include <QHash>
 #include <QMutex>
 #include <QObject>
+#include <QPointer>
 #include <QStringList>
 #include <QWidget>
 
@@ -28,6 +30,7 @@
 
 class AutoTypeAction;
 class AutoTypeExecutor;
+class AutoTypeIndex;
 class AutoTypePlatformInterface;
 class Database;
 class Entry;
@@ -94,6 +97,7 @@ private:
     bool windowMatchesTitle(const QString& windowTitle, const QString& resolvedTitle);
     bool windowMatchesUrl(const QString& windowTitle, const QString& resolvedUrl);
     bool windowMatches(const QString& windowTitle, const QString& windowPattern);
+    AutoTypeIndex* indexOf(Database* db);
     void restoreWindowState();
 
     QMutex m_inAutoType;
@@ -109,6 +113,7 @@ private:
     QString m_windowTitleForGlobal;
     WindowState m_windowState;
     WId m_windowForGlobal;
+    QHash<const Database*, QPointer<AutoTypeIndex>> m_indexes;
 
     Q_DISABLE_COPY(AutoType)
 };
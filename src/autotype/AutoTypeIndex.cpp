@@ -0,0 +1,398 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AutoTypeIndex.h"
+
+#include <QUrl>
+#include <algorithm>
+
+#include "autotype/WildcardMatcher.h"
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Global.h"
+#include "core/Group.h"
+
+namespace
+{
+    // Number of leading characters of a wildcard pattern, title or URL used as bucket key
+    constexpr int PrefixKeyLength = 3;
+} // namespace
+
+AutoTypeIndex::AutoTypeIndex(Database* db)
+    : QObject(db)
+    , m_db(db)
+    , m_dirty(true)
+{
+    // Entries are updated one by one, changes to the group tree rebuild the index
+    connect(db, SIGNAL(entryAdded(Entry*)), SLOT(entryAdded(Entry*)));
+    connect(db, SIGNAL(entryRemoved(Entry*)), SLOT(entryRemoved(Entry*)));
+    connect(db, SIGNAL(groupAdded()), SLOT(invalidate()));
+    connect(db, SIGNAL(groupRemoved()), SLOT(invalidate()));
+}
+
+Database* AutoTypeIndex::database() const
+{
+    return m_db;
+}
+
+void AutoTypeIndex::invalidate()
+{
+    m_dirty = true;
+}
+
+void AutoTypeIndex::entryAdded(Entry* entry)
+{
+    connect(entry, SIGNAL(entryModified()), SLOT(entryModified()), Qt::UniqueConnection);
+    if (!m_dirty) {
+        update(entry);
+    }
+}
+
+void AutoTypeIndex::entryRemoved(Entry* entry)
+{
+    disconnect(entry, SIGNAL(entryModified()), this, SLOT(entryModified()));
+    remove(entry);
+}
+
+void AutoTypeIndex::entryModified()
+{
+    auto entry = qobject_cast<Entry*>(sender());
+    if (entry && !m_dirty) {
+        update(entry);
+    }
+}
+
+/**
+ * Entries whose window associations, title or URL can match the given window title.
+ * Candidates are returned in tree order and still need to be checked with
+ * AutoType::autoTypeSequences, entries with placeholders in their patterns are
+ * always returned.
+ */
+QList<Entry*> AutoTypeIndex::candidates(const QString& windowTitle, bool matchTitle, bool matchUrl)
+{
+    QList<Entry*> entries;
+    if (!m_db || windowTitle.isEmpty()) {
+        return entries;
+    }
+
+    if (m_dirty || m_rootGroup != m_db->rootGroup()) {
+        rebuild();
+    }
+
+    QSet<const Entry*> candidates = m_dynamicRecords;
+
+    const QString foldedTitle = windowTitle.toCaseFolded();
+    for (int length = 0; length <= PrefixKeyLength && length <= foldedTitle.size(); ++length) {
+        const auto bucket = m_wildcardBuckets.values(foldedTitle.left(length));
+        for (const Entry* entry : bucket) {
+            if (candidates.contains(entry)) {
+                continue;
+            }
+            for (const Pattern& pattern : asConst(m_records[entry].patterns)) {
+                if (!pattern.isRegExp && WildcardMatcher(windowTitle).match(pattern.window)) {
+                    candidates.insert(entry);
+                    break;
+                }
+            }
+        }
+    }
+
+    for (const Entry* entry : asConst(m_regExpRecords)) {
+        if (candidates.contains(entry)) {
+            continue;
+        }
+        for (const Pattern& pattern : asConst(m_records[entry].patterns)) {
+            if (pattern.isRegExp && pattern.regExp.indexIn(windowTitle) != -1) {
+                candidates.insert(entry);
+                break;
+            }
+        }
+    }
+
+    if (matchTitle) {
+        candidates.unite(m_dynamicTitleRecords);
+    }
+    if (matchUrl) {
+        candidates.unite(m_dynamicUrlRecords);
+    }
+
+    // The bucket key of a title or URL contained in the window title is one of its substrings
+    if (matchTitle || matchUrl) {
+        for (int start = 0; start < foldedTitle.size(); ++start) {
+            for (int length = 1; length <= PrefixKeyLength && start + length <= foldedTitle.size(); ++length) {
+                const QString key = foldedTitle.mid(start, length);
+                if (matchTitle) {
+                    const auto bucket = m_titleBuckets.values(key);
+                    for (const Entry* entry : bucket) {
+                        if (!candidates.contains(entry)
+                            && windowTitle.contains(m_records[entry].resolvedTitle, Qt::CaseInsensitive)) {
+                            candidates.insert(entry);
+                        }
+                    }
+                }
+                if (matchUrl) {
+                    const auto bucket = m_urlBuckets.values(key);
+                    for (const Entry* entry : bucket) {
+                        const Record& record = m_records[entry];
+                        if (!candidates.contains(entry)
+                            && ((!record.resolvedUrl.isEmpty()
+                                 && windowTitle.contains(record.resolvedUrl, Qt::CaseInsensitive))
+                                || (!record.urlHost.isEmpty()
+                                    && windowTitle.contains(record.urlHost, Qt::CaseInsensitive)))) {
+                            candidates.insert(entry);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    typedef QPair<QVector<int>, Entry*> OrderedEntry;
+    QList<OrderedEntry> ordered;
+    for (const Entry* candidate : asConst(candidates)) {
+        Entry* entry = m_records[candidate].entry;
+        if (entry && entry->group() && entry->group()->database() == m_db) {
+            ordered.append(qMakePair(treePosition(entry), entry));
+        }
+    }
+    std::sort(ordered.begin(), ordered.end(), [](const OrderedEntry& lhs, const OrderedEntry& rhs) {
+        return std::lexicographical_compare(
+            lhs.first.constBegin(), lhs.first.constEnd(), rhs.first.constBegin(), rhs.first.constEnd());
+    });
+
+    for (const auto& candidate : asConst(ordered)) {
+        entries.append(candidate.second);
+    }
+
+    return entries;
+}
+
+void AutoTypeIndex::rebuild()
+{
+    // Every entry can match a window, including those that were not accessed yet
+    m_db->rootGroup()->loadEntriesRecursive();
+
+    QHash<const Entry*, Record> previous = m_records;
+
+    m_records.clear();
+    m_wildcardBuckets.clear();
+    m_regExpRecords.clear();
+    m_dynamicRecords.clear();
+    m_titleBuckets.clear();
+    m_dynamicTitleRecords.clear();
+    m_urlBuckets.clear();
+    m_dynamicUrlRecords.clear();
+
+    const QList<Entry*> entries = m_db->entries();
+    for (Entry* entry : entries) {
+        connect(entry, SIGNAL(entryModified()), SLOT(entryModified()), Qt::UniqueConnection);
+        const QStringList windows = windowsOf(entry);
+
+        // Reuse the compiled data if nothing relevant changed
+        const Record record = previous.take(entry);
+        if (record.entry == entry && record.title == entry->title() && record.url == entry->url()
+            && record.windows == windows) {
+            insert(entry, record);
+        } else {
+            insert(entry, compile(entry, windows));
+        }
+    }
+
+    for (const Record& record : asConst(previous)) {
+        if (record.entry) {
+            disconnect(record.entry, SIGNAL(entryModified()), this, SLOT(entryModified()));
+        }
+    }
+
+    m_rootGroup = m_db->rootGroup();
+    m_dirty = false;
+}
+
+void AutoTypeIndex::insert(Entry* entry, const Record& record)
+{
+    m_records.insert(entry, record);
+
+    if (record.hasDynamicWindow) {
+        m_dynamicRecords.insert(entry);
+    } else {
+        if (record.hasRegExp) {
+            m_regExpRecords.insert(entry);
+        }
+        for (const QString& key : record.wildcardKeys) {
+            m_wildcardBuckets.insert(key, entry);
+        }
+    }
+
+    if (record.hasDynamicTitle) {
+        m_dynamicTitleRecords.insert(entry);
+    } else if (!record.resolvedTitle.isEmpty()) {
+        m_titleBuckets.insert(substringKey(record.resolvedTitle), entry);
+    }
+
+    if (record.hasDynamicUrl) {
+        m_dynamicUrlRecords.insert(entry);
+    } else {
+        for (const QString& key : record.urlKeys) {
+            m_urlBuckets.insert(key, entry);
+        }
+    }
+}
+
+void AutoTypeIndex::remove(const Entry* entry)
+{
+    const auto it = m_records.constFind(entry);
+    if (it == m_records.cend()) {
+        return;
+    }
+
+    const Record& record = it.value();
+    for (const QString& key : record.wildcardKeys) {
+        m_wildcardBuckets.remove(key, entry);
+    }
+    if (!record.resolvedTitle.isEmpty()) {
+        m_titleBuckets.remove(substringKey(record.resolvedTitle), entry);
+    }
+    for (const QString& key : record.urlKeys) {
+        m_urlBuckets.remove(key, entry);
+    }
+    m_regExpRecords.remove(entry);
+    m_dynamicRecords.remove(entry);
+    m_dynamicTitleRecords.remove(entry);
+    m_dynamicUrlRecords.remove(entry);
+
+    m_records.remove(entry);
+}
+
+/**
+ * Recompile a single entry if its title, URL or window associations changed.
+ */
+void AutoTypeIndex::update(Entry* entry)
+{
+    const QStringList windows = windowsOf(entry);
+    const auto it = m_records.constFind(entry);
+    if (it != m_records.cend() && it->entry == entry && it->title == entry->title() && it->url == entry->url()
+        && it->windows == windows) {
+        return;
+    }
+
+    remove(entry);
+    insert(entry, compile(entry, windows));
+}
+
+AutoTypeIndex::Record AutoTypeIndex::compile(Entry* entry, const QStringList& windows)
+{
+    Record record;
+    record.entry = entry;
+    record.title = entry->title();
+    record.url = entry->url();
+    record.windows = windows;
+    record.hasDynamicWindow = false;
+    record.hasRegExp = false;
+
+    for (const QString& window : windows) {
+        if (hasPlaceholder(window)) {
+            // Resolved per lookup by AutoType::autoTypeSequences
+            record.hasDynamicWindow = true;
+            continue;
+        }
+
+        Pattern pattern;
+        pattern.window = window;
+        pattern.isRegExp = window.startsWith("//") && window.endsWith("//") && window.size() >= 4;
+        if (pattern.isRegExp) {
+            pattern.regExp = QRegExp(window.mid(2, window.size() - 4), Qt::CaseInsensitive, QRegExp::RegExp2);
+            record.hasRegExp = true;
+        } else {
+            record.wildcardKeys.insert(prefixKey(window));
+        }
+        record.patterns.append(pattern);
+    }
+
+    record.hasDynamicTitle = hasPlaceholder(record.title);
+    if (!record.hasDynamicTitle) {
+        record.resolvedTitle = record.title;
+    }
+
+    record.hasDynamicUrl = hasPlaceholder(record.url);
+    if (!record.hasDynamicUrl) {
+        record.resolvedUrl = record.url;
+        const QUrl url(record.url);
+        if (url.isValid()) {
+            record.urlHost = url.host();
+        }
+        if (!record.resolvedUrl.isEmpty()) {
+            record.urlKeys.insert(substringKey(record.resolvedUrl));
+        }
+        if (!record.urlHost.isEmpty()) {
+            record.urlKeys.insert(substringKey(record.urlHost));
+        }
+    }
+
+    return record;
+}
+
+QStringList AutoTypeIndex::windowsOf(const Entry* entry)
+{
+    QStringList windows;
+    for (const auto& association : entry->autoTypeAssociations()->getAll()) {
+        windows.append(association.window);
+    }
+    return windows;
+}
+
+/**
+ * Bucket key of a wildcard pattern: the case folded start of its literal prefix.
+ * A window title can only match patterns whose key is a prefix of the title.
+ */
+QString AutoTypeIndex::prefixKey(const QString& window)
+{
+    int wildcard = window.indexOf(WildcardMatcher::Wildcard);
+    const QString prefix = wildcard == -1 ? window : window.left(wildcard);
+    return prefix.toCaseFolded().left(PrefixKeyLength);
+}
+
+/**
+ * Bucket key of a title or URL: its case folded start. A window title can only
+ * contain texts whose key is one of its own substrings.
+ */
+QString AutoTypeIndex::substringKey(const QString& text)
+{
+    return text.toCaseFolded().left(PrefixKeyLength);
+}
+
+bool AutoTypeIndex::hasPlaceholder(const QString& text)
+{
+    return text.contains('{');
+}
+
+/**
+ * Position of an entry in the order of Group::entriesRecursive(): the child
+ * indexes of its groups from the root, followed by its index in its group.
+ * Entries of a group come before the entries of its subgroups.
+ */
+QVector<int> AutoTypeIndex::treePosition(const Entry* entry)
+{
+    QVector<int> position;
+    const Group* group = entry->group();
+    position.append(group->entries().indexOf(const_cast<Entry*>(entry)));
+    position.append(-1);
+    for (; group->parentGroup(); group = group->parentGroup()) {
+        position.append(group->indexInParent());
+    }
+    std::reverse(position.begin(), position.end());
+    return position;
+}
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_AUTOTYPEINDEX_H
+#define KEEPASSXC_AUTOTYPEINDEX_H
+
+#include <QHash>
+#include <QMultiHash>
+#include <QObject>
+#include <QPointer>
+#include <QRegExp>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Window matching index of all entries of a database used by global Auto-Type.
+ *
+ * Window associations are compiled once: regular expressions are built up front
+ * and wildcard patterns are bucketed by their literal prefix. Entry titles and
+ * URLs without placeholders are bucketed by their first characters, so a lookup
+ * only visits the entries whose title or URL can be part of the window title.
+ * Added, removed and modified entries are updated one by one, changes to the
+ * group tree rebuild the index on the next lookup, reusing the compiled data of
+ * all entries that did not change.
+ */
+class AutoTypeIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AutoTypeIndex(Database* db);
+
+    Database* database() const;
+    QList<Entry*> candidates(const QString& windowTitle, bool matchTitle, bool matchUrl);
+
+private slots:
+    void invalidate();
+    void entryAdded(Entry* entry);
+    void entryRemoved(Entry* entry);
+    void entryModified();
+
+private:
+    struct Pattern
+    {
+        QString window;
+        QRegExp regExp;
+        bool isRegExp;
+    };
+
+    struct Record
+    {
+        QPointer<Entry> entry;
+        QString title;
+        QString url;
+        QStringList windows;
+
+        QList<Pattern> patterns;
+        QSet<QString> wildcardKeys;
+        bool hasDynamicWindow;
+        bool hasRegExp;
+        QString resolvedTitle;
+        bool hasDynamicTitle;
+        QString resolvedUrl;
+        QString urlHost;
+        QSet<QString> urlKeys;
+        bool hasDynamicUrl;
+    };
+
+    void rebuild();
+    void insert(Entry* entry, const Record& record);
+    void remove(const Entry* entry);
+    void update(Entry* entry);
+    static Record compile(Entry* entry, const QStringList& windows);
+    static QStringList windowsOf(const Entry* entry);
+    static QString prefixKey(const QString& window);
+    static QString substringKey(const QString& text);
+    static bool hasPlaceholder(const QString& text);
+    static QVector<int> treePosition(const Entry* entry);
+
+    QPointer<Database> m_db;
+    QPointer<Group> m_rootGroup;
+    bool m_dirty;
+    QHash<const Entry*, Record> m_records;
+    QMultiHash<QString, const Entry*> m_wildcardBuckets;
+    QSet<const Entry*> m_regExpRecords;
+    QSet<const Entry*> m_dynamicRecords;
+    QMultiHash<QString, const Entry*> m_titleBuckets;
+    QSet<const Entry*> m_dynamicTitleRecords;
+    QMultiHash<QString, const Entry*> m_urlBuckets;
+    QSet<const Entry*> m_dynamicUrlRecords;
+};
+
+#endif // KEEPASSXC_AUTOTYPEINDEX_H
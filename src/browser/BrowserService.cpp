@@ -38,6 +38,7 @@
 #include "core/Metadata.h"
 #include "core/PasswordGenerator.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 #include "gui/MainWindow.h"
 #include "gui/MessageBox.h"
 #ifdef Q_OS_MACOS
@@ -377,6 +378,7 @@ QJsonArray BrowserService::findMatchingEntries(const QString& dbid,
                                                const StringPairList& keyList,
                                                const bool httpAuth)
 {
+    TRACE_SCOPE("BrowserService::findMatchingEntries");
     Q_UNUSED(dbid);
     const bool alwaysAllowAccess = browserSettings()->alwaysAllowAccess();
     const bool ignoreHttpAuth = browserSettings()->httpAuthPermission();
@@ -610,6 +612,8 @@ BrowserService::searchEntries(const QSharedPointer<Database>& db, const QString&
 
 QList<Entry*> BrowserService::searchEntries(const QString& url, const QString& submitUrl, const StringPairList& keyList)
 {
+    TRACE_SCOPE("BrowserService::searchEntries");
+
     // Check if database is connected with KeePassXC-Browser
     auto databaseConnected = [&](const QSharedPointer<Database>& db) {
         for (const StringPair& keyPair : keyList) {
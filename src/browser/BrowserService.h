@@ -168,6 +168,7 @@ private:
 
     Q_DISABLE_COPY(BrowserService);
 
+    friend class Benchmarks;
     friend class TestBrowser;
 };
 
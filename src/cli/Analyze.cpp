@@ -71,10 +71,12 @@ int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPoint
 
 void Analyze::printHibpFinding(const Entry* entry, int count, QTextStream& out)
 {
-    QString path = entry->title();
-    for (auto g = entry->group(); g && g != g->database()->rootGroup(); g = g->parentGroup()) {
-        path.prepend("/").prepend(g->name());
+    // path below the root group
+    QString path = entry->group()->fullPath().mid(entry->database()->rootGroup()->fullPath().size() + 1);
+    if (!path.isEmpty()) {
+        path += "/";
     }
+    path += entry->title();
 
     out << QObject::tr("Password for '%1' has been leaked %2 time(s)!", "", count).arg(path).arg(count) << endl;
 }
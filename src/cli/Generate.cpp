@@ -59,6 +59,12 @@ const QCommandLineOption Generate::ExcludeSimilarCharsOption =
 
 const QCommandLineOption Generate::IncludeEveryGroupOption =
     QCommandLineOption(QStringList() << "every-group", QObject::tr("Include characters from every selected group"));
+
+const QCommandLineOption Generate::CountOption =
+    QCommandLineOption(QStringList() << "c"
+                                     << "count",
+                       QObject::tr("Number of passwords to generate"),
+                       QObject::tr("count", "CLI parameter"));
 Generate::Generate()
 {
     name = QString("generate");
@@ -72,6 +78,7 @@ Generate::Generate()
     options.append(Generate::ExcludeCharsOption);
     options.append(Generate::ExcludeSimilarCharsOption);
     options.append(Generate::IncludeEveryGroupOption);
+    options.append(Generate::CountOption);
 }
 
 /**
@@ -145,9 +152,19 @@ int Generate::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
+    int count = 1;
+    QString passwordCount = parser->value(Generate::CountOption);
+    if (!passwordCount.isEmpty()) {
+        count = passwordCount.toInt();
+        if (count <= 0) {
+            Utils::STDERR << QObject::tr("Invalid password count %1").arg(passwordCount) << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     auto& out = Utils::STDOUT;
-    QString password = passwordGenerator->generatePassword();
-    out << password << endl;
+    const QStringList passwords = passwordGenerator->generatePasswords(count);
+    out << passwords.join("\n") << endl;
 
     return EXIT_SUCCESS;
 }
@@ -33,6 +33,7 @@
 #include "config-keepassx.h"
 #include "core/Bootstrap.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 #include "crypto/Crypto.h"
 
 #if defined(WITH_ASAN) && defined(WITH_LSAN)
@@ -116,6 +117,28 @@ private:
 };
 #endif
 
+/**
+ * Take a --trace option given before the command name out of the arguments,
+ * the commands do not know about it.
+ */
+QString takeTraceFile(QStringList& arguments)
+{
+    for (int i = 1; i < arguments.size() && arguments.at(i).startsWith('-'); ++i) {
+        const QString argument = arguments.at(i);
+        if (argument == "--trace" && i + 1 < arguments.size()) {
+            const QString fileName = arguments.at(i + 1);
+            arguments.removeAt(i + 1);
+            arguments.removeAt(i);
+            return fileName;
+        }
+        if (argument.startsWith("--trace=")) {
+            arguments.removeAt(i);
+            return argument.mid(8);
+        }
+    }
+    return {};
+}
+
 void enterInteractiveMode(const QStringList& arguments)
 {
     auto& err = Utils::STDERR;
@@ -195,6 +218,8 @@ int main(int argc, char** argv)
     for (int i = 0; i < argc; ++i) {
         arguments << QString(argv[i]);
     }
+    Trace::start(takeTraceFile(arguments));
+
     QCommandLineParser parser;
 
     QString description("KeePassXC command line interface.");
@@ -208,6 +233,10 @@ int main(int argc, char** argv)
 
     QCommandLineOption debugInfoOption(QStringList() << "debug-info", QObject::tr("Displays debugging information."));
     parser.addOption(debugInfoOption);
+#ifdef WITH_XC_TRACING
+    QCommandLineOption traceOption("trace", QObject::tr("Write a performance trace to file."), "file");
+    parser.addOption(traceOption);
+#endif
     parser.addHelpOption();
     parser.addVersionOption();
     // TODO : use the setOptionsAfterPositionalArgumentsMode (Qt 5.6) function
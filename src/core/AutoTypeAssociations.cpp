@@ -17,6 +17,8 @@
 
 #include "AutoTypeAssociations.h"
 
+#include "core/Entry.h"
+
 bool AutoTypeAssociations::Association::operator==(const AutoTypeAssociations::Association& other) const
 {
     return window == other.window && sequence == other.sequence;
@@ -32,6 +34,18 @@ AutoTypeAssociations::AutoTypeAssociations(QObject* parent)
 {
 }
 
+/**
+ * Tell the owning entry about the change before emitting the signal, see
+ * EntryAttachments::notifyModified().
+ */
+void AutoTypeAssociations::notifyModified()
+{
+    if (auto entry = qobject_cast<Entry*>(parent())) {
+        entry->emitModified();
+    }
+    emit modified();
+}
+
 void AutoTypeAssociations::copyDataFrom(const AutoTypeAssociations* other)
 {
     if (m_associations == other->m_associations) {
@@ -41,7 +55,18 @@ void AutoTypeAssociations::copyDataFrom(const AutoTypeAssociations* other)
     emit aboutToReset();
     m_associations = other->m_associations;
     emit reset();
-    emit modified();
+    notifyModified();
+}
+
+/**
+ * Reuse the storage of other if it holds the same associations.
+ * The content does not change, so no signals are emitted.
+ */
+void AutoTypeAssociations::shareDataWith(const AutoTypeAssociations* other)
+{
+    if (m_associations == other->m_associations) {
+        m_associations = other->m_associations;
+    }
 }
 
 void AutoTypeAssociations::add(const AutoTypeAssociations::Association& association)
@@ -50,7 +75,7 @@ void AutoTypeAssociations::add(const AutoTypeAssociations::Association& associat
     emit aboutToAdd(index);
     m_associations.append(association);
     emit added(index);
-    emit modified();
+    notifyModified();
 }
 
 void AutoTypeAssociations::remove(int index)
@@ -60,7 +85,7 @@ void AutoTypeAssociations::remove(int index)
     emit aboutToRemove(index);
     m_associations.removeAt(index);
     emit removed(index);
-    emit modified();
+    notifyModified();
 }
 
 void AutoTypeAssociations::removeEmpty()
@@ -81,7 +106,7 @@ void AutoTypeAssociations::update(int index, const AutoTypeAssociations::Associa
     if (m_associations.at(index) != association) {
         m_associations[index] = association;
         emit dataChanged(index);
-        emit modified();
+        notifyModified();
     }
 }
 
@@ -36,6 +36,7 @@ public:
 
     explicit AutoTypeAssociations(QObject* parent = nullptr);
     void copyDataFrom(const AutoTypeAssociations* other);
+    void shareDataWith(const AutoTypeAssociations* other);
     void add(const AutoTypeAssociations::Association& association);
     void remove(int index);
     void removeEmpty();
@@ -50,6 +51,8 @@ public:
     bool operator!=(const AutoTypeAssociations& other) const;
 
 private:
+    void notifyModified();
+
     QList<AutoTypeAssociations::Association> m_associations;
 
 signals:
@@ -19,6 +19,7 @@
 #include "config-keepassx.h"
 #include "core/Config.h"
 #include "core/Translator.h"
+#include "crypto/SessionCipher.h"
 #include "gui/MessageBox.h"
 
 #ifdef Q_OS_WIN
@@ -84,6 +85,7 @@ namespace Bootstrap
     {
         bootstrap();
         Translator::installTranslators();
+        SessionCipher::setEnabled(config()->get(Config::Security_EncryptProtectedValues).toBool());
 
 #ifdef Q_OS_WIN
         // Qt on Windows uses "MS Shell Dlg 2" as the default font for many widgets, which resolves
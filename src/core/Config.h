@@ -62,6 +62,8 @@ public:
         FaviconDownloadTimeout,
         UpdateCheckMessageShown,
         UseTouchID,
+        LazyEntryLoading,
+        ParallelEntryParsing,
 
         LastDatabases,
         LastKeyFiles,
@@ -103,6 +105,7 @@ public:
         Security_ClearSearch,
         Security_ClearSearchTimeout,
         Security_HideNotes,
+        Security_EncryptProtectedValues,
         Security_LockDatabaseIdle,
         Security_LockDatabaseIdleSeconds,
         Security_LockDatabaseMinimize,
@@ -24,7 +24,9 @@
 #include "core/Tools.h"
 
 CsvParser::CsvParser()
-    : m_ch(0)
+    : m_pos(0)
+    , m_codec(QTextCodec::codecForName("UTF-8"))
+    , m_ch(0)
     , m_comment('#')
     , m_currCol(1)
     , m_currRow(1)
@@ -38,15 +40,10 @@ CsvParser::CsvParser()
     , m_separator(',')
     , m_statusMsg("")
 {
-    m_csv.setBuffer(&m_array);
-    m_ts.setDevice(&m_csv);
-    m_csv.open(QIODevice::ReadOnly);
-    m_ts.setCodec("UTF-8");
 }
 
 CsvParser::~CsvParser()
 {
-    m_csv.close();
 }
 
 bool CsvParser::isFileLoaded()
@@ -98,6 +95,8 @@ bool CsvParser::readFile(QFile* device)
 
 void CsvParser::reset()
 {
+    m_text.clear();
+    m_pos = 0;
     m_ch = 0;
     m_currCol = 1;
     m_currRow = 1;
@@ -106,7 +105,6 @@ void CsvParser::reset()
     m_lastPos = -1;
     m_maxCols = 0;
     m_statusMsg = "";
-    m_ts.seek(0);
     m_table.clear();
     // the following are users' concern :)
     // m_comment = '#';
@@ -125,6 +123,10 @@ void CsvParser::clear()
 
 bool CsvParser::parseFile()
 {
+    // Decode once, a byte order mark overrides the selected codec
+    m_text = QTextCodec::codecForUtfText(m_array, m_codec)->toUnicode(m_array);
+    m_pos = 0;
+
     parseRecord();
     while (!m_isEof) {
         if (!skipEndline()) {
@@ -140,11 +142,17 @@ bool CsvParser::parseFile()
 
 void CsvParser::parseRecord()
 {
-    CsvRow row;
     if (isComment()) {
         skipLine();
         return;
     }
+
+    // Build the row in place, it is dropped again if it turns out to be empty
+    m_table.append(CsvRow());
+    CsvRow& row = m_table.last();
+    if (m_maxCols > 0) {
+        row.reserve(m_maxCols);
+    }
     do {
         parseField(row);
         getChar(m_ch);
@@ -154,10 +162,9 @@ void CsvParser::parseRecord()
         ungetChar();
     }
     if (isEmptyRow(row)) {
-        row.clear();
+        m_table.removeLast();
         return;
     }
-    m_table.push_back(row);
     if (m_maxCols < row.size()) {
         m_maxCols = row.size();
     }
@@ -166,7 +173,8 @@ void CsvParser::parseRecord()
 
 void CsvParser::parseField(CsvRow& row)
 {
-    QString field;
+    row.append(QString());
+    QString& field = row.last();
     peek(m_ch);
     if (!isTerminator(m_ch)) {
         if (isQualifier(m_ch)) {
@@ -175,19 +183,20 @@ void CsvParser::parseField(CsvRow& row)
             parseSimple(field);
         }
     }
-    row.push_back(field);
 }
 
 void CsvParser::parseSimple(QString& s)
 {
-    QChar c;
-    getChar(c);
-    while ((isText(c)) && (!m_isEof)) {
-        s.append(c);
-        getChar(c);
+    const int start = m_pos;
+    const int size = m_text.size();
+    while (m_pos < size && isText(m_text.at(m_pos))) {
+        ++m_pos;
     }
+    s.append(m_text.midRef(start, m_pos - start));
+
+    m_isEof = m_pos >= size;
     if (!m_isEof) {
-        ungetChar();
+        m_lastPos = m_pos;
     }
 }
 
@@ -215,11 +224,19 @@ void CsvParser::parseEscaped(QString& s)
 
 void CsvParser::parseEscapedText(QString& s)
 {
-    getChar(m_ch);
-    while ((!isQualifier(m_ch)) && !m_isEof) {
-        s.append(m_ch);
-        getChar(m_ch);
+    const int start = m_pos;
+    const int size = m_text.size();
+    while (m_pos < size && !isQualifier(m_text.at(m_pos))) {
+        ++m_pos;
     }
+    if (m_pos > start) {
+        s.append(m_text.midRef(start, m_pos - start));
+        m_ch = m_text.at(m_pos - 1);
+        m_lastPos = m_pos - 1;
+    }
+
+    // consume the qualifier, m_ch keeps the last text character at the end of input
+    getChar(m_ch);
 }
 
 bool CsvParser::processEscapeMark(QString& s, QChar c)
@@ -262,22 +279,23 @@ bool CsvParser::processEscapeMark(QString& s, QChar c)
 void CsvParser::fillColumns()
 {
     // fill shorter rows with empty placeholder columns
-    for (int i = 0; i < m_table.size(); ++i) {
-        int gap = m_maxCols - m_table.at(i).size();
+    for (CsvRow& row : m_table) {
+        int gap = m_maxCols - row.size();
         if (gap > 0) {
-            CsvRow r = m_table.at(i);
+            row.reserve(m_maxCols);
             for (int j = 0; j < gap; ++j) {
-                r.append(QString(""));
+                row.append(QString(""));
             }
-            m_table.replace(i, r);
         }
     }
 }
 
 void CsvParser::skipLine()
 {
-    m_ts.readLine();
-    m_ts.seek(m_ts.pos() - 1);
+    // stop at the line break, it is consumed by skipEndline
+    int end = m_text.indexOf('\n', m_pos);
+    m_pos = end < 0 ? m_text.size() : end;
+    m_isEof = m_pos >= m_text.size();
 }
 
 bool CsvParser::skipEndline()
@@ -288,26 +306,29 @@ bool CsvParser::skipEndline()
 
 void CsvParser::getChar(QChar& c)
 {
-    m_isEof = m_ts.atEnd();
+    m_isEof = m_pos >= m_text.size();
     if (!m_isEof) {
-        m_lastPos = m_ts.pos();
-        m_ts >> c;
+        m_lastPos = m_pos;
+        c = m_text.at(m_pos++);
     }
 }
 
 void CsvParser::ungetChar()
 {
-    if (!m_ts.seek(m_lastPos)) {
+    if (m_lastPos < 0) {
         qWarning("CSV Parser: unget lower bound exceeded");
         m_isGood = false;
+        return;
     }
+    m_pos = m_lastPos;
 }
 
 void CsvParser::peek(QChar& c)
 {
-    getChar(c);
+    m_isEof = m_pos >= m_text.size();
     if (!m_isEof) {
-        ungetChar();
+        m_lastPos = m_pos;
+        c = m_text.at(m_pos);
     }
 }
 
@@ -324,7 +345,7 @@ bool CsvParser::isComment()
 {
     bool result = false;
     QChar c2;
-    qint64 pos = m_ts.pos();
+    int pos = m_pos;
 
     do {
         getChar(c2);
@@ -333,7 +354,7 @@ bool CsvParser::isComment()
     if (c2 == m_comment) {
         result = true;
     }
-    m_ts.seek(pos);
+    m_pos = pos;
     return result;
 }
 
@@ -390,7 +411,10 @@ void CsvParser::setComment(const QChar& c)
 
 void CsvParser::setCodec(const QString& s)
 {
-    m_ts.setCodec(QTextCodec::codecForName(s.toLocal8Bit()));
+    QTextCodec* codec = QTextCodec::codecForName(s.toLocal8Bit());
+    if (codec) {
+        m_codec = codec;
+    }
 }
 
 void CsvParser::setFieldSeparator(const QChar& c)
@@ -405,7 +429,7 @@ void CsvParser::setTextQualifier(const QChar& c)
 
 int CsvParser::getFileSize() const
 {
-    return m_csv.size();
+    return m_array.size();
 }
 
 const CsvTable CsvParser::getCsvTable() const
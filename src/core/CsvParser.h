@@ -19,10 +19,10 @@
 #ifndef KEEPASSX_CSVPARSER_H
 #define KEEPASSX_CSVPARSER_H
 
-#include <QBuffer>
 #include <QFile>
-#include <QQueue>
-#include <QTextStream>
+#include <QStringList>
+
+class QTextCodec;
 
 typedef QStringList CsvRow;
 typedef QList<CsvRow> CsvTable;
@@ -54,7 +54,10 @@ protected:
 
 private:
     QByteArray m_array;
-    QBuffer m_csv;
+    // decoded contents of m_array, tokenized by index
+    QString m_text;
+    int m_pos;
+    QTextCodec* m_codec;
     QChar m_ch;
     QChar m_comment;
     unsigned int m_currCol;
@@ -63,12 +66,11 @@ private:
     bool m_isEof;
     bool m_isFileLoaded;
     bool m_isGood;
-    qint64 m_lastPos;
+    int m_lastPos;
     int m_maxCols;
     QChar m_qualifier;
     QChar m_separator;
     QString m_statusMsg;
-    QTextStream m_ts;
 
     void getChar(QChar& c);
     void ungetChar();
@@ -18,6 +18,7 @@
 #include "CustomData.h"
 #include "Clock.h"
 
+#include "core/Entry.h"
 #include "core/Global.h"
 
 const QString CustomData::LastModified = QStringLiteral("_LAST_MODIFIED");
@@ -30,6 +31,19 @@ CustomData::CustomData(QObject* parent)
 {
 }
 
+/**
+ * Tell the owning entry about the change before emitting the signal, see
+ * EntryAttachments::notifyModified(). Groups and the metadata still connect
+ * to customDataModified().
+ */
+void CustomData::notifyModified()
+{
+    if (auto entry = qobject_cast<Entry*>(parent())) {
+        entry->emitModified();
+    }
+    emit customDataModified();
+}
+
 QList<QString> CustomData::keys() const
 {
     return m_data.keys();
@@ -67,7 +81,7 @@ void CustomData::set(const QString& key, const QString& value)
     if (addAttribute || changeValue) {
         m_data.insert(key, value);
         updateLastModified();
-        emit customDataModified();
+        notifyModified();
     }
 
     if (addAttribute) {
@@ -83,7 +97,7 @@ void CustomData::remove(const QString& key)
 
     updateLastModified();
     emit removed(key);
-    emit customDataModified();
+    notifyModified();
 }
 
 void CustomData::rename(const QString& oldKey, const QString& newKey)
@@ -103,7 +117,7 @@ void CustomData::rename(const QString& oldKey, const QString& newKey)
     m_data.insert(newKey, data);
 
     updateLastModified();
-    emit customDataModified();
+    notifyModified();
     emit renamed(oldKey, newKey);
 }
 
@@ -119,7 +133,18 @@ void CustomData::copyDataFrom(const CustomData* other)
 
     updateLastModified();
     emit reset();
-    emit customDataModified();
+    notifyModified();
+}
+
+/**
+ * Reuse the storage of other if it holds the same data.
+ * The content does not change, so no signals are emitted.
+ */
+void CustomData::shareDataWith(const CustomData* other)
+{
+    if (m_data == other->m_data) {
+        m_data = other->m_data;
+    }
 }
 
 QDateTime CustomData::getLastModified() const
@@ -152,7 +177,7 @@ void CustomData::clear()
     m_data.clear();
 
     emit reset();
-    emit customDataModified();
+    notifyModified();
 }
 
 bool CustomData::isEmpty() const
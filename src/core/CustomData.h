@@ -42,6 +42,7 @@ public:
     int size() const;
     int dataSize() const;
     void copyDataFrom(const CustomData* other);
+    void shareDataWith(const CustomData* other);
     QDateTime getLastModified() const;
     bool isProtectedCustomData(const QString& key) const;
     bool operator==(const CustomData& other) const;
@@ -68,6 +69,8 @@ private slots:
     void updateLastModified();
 
 private:
+    void notifyModified();
+
     QHash<QString, QString> m_data;
 };
 
@@ -0,0 +1,180 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CustomIconCache.h"
+
+#include <QGuiApplication>
+#include <QtConcurrent>
+
+namespace
+{
+    // Thread-safe, used on the thread pool
+    QImage scaleImage(const QImage& image, int pixelSize)
+    {
+        return image.scaled(pixelSize, pixelSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    // The ratio QIcon::pixmap() renders for
+    qreal devicePixelRatio()
+    {
+        return QCoreApplication::testAttribute(Qt::AA_UseHighDpiPixmaps) ? qGuiApp->devicePixelRatio() : 1.0;
+    }
+} // namespace
+
+CustomIconCache::CustomIconCache(QObject* parent)
+    : QObject(parent)
+    , m_devicePixelRatio(1.0)
+{
+    for (int size = 0; size < SizeCount; ++size) {
+        m_scaled[size] = false;
+        connect(&m_scaleWatchers[size], &QFutureWatcherBase::finished, this, [this, size] {
+            scalingFinished(static_cast<IconSize>(size));
+        });
+    }
+}
+
+void CustomIconCache::insert(const QUuid& uuid, const QImage& image)
+{
+    Icon icon;
+    icon.image = image;
+    m_icons.insert(uuid, icon);
+}
+
+void CustomIconCache::remove(const QUuid& uuid)
+{
+    m_icons.remove(uuid);
+}
+
+void CustomIconCache::clear()
+{
+    m_icons.clear();
+    resetPixmaps();
+}
+
+QPixmap CustomIconCache::pixmap(const QUuid& uuid, IconSize size)
+{
+    return cachedPixmap(uuid, size, 0);
+}
+
+QPixmap CustomIconCache::pixmap(const QUuid& uuid, IconSize size, DatabaseIcons::Badges badge)
+{
+    return cachedPixmap(uuid, size, badge + 1);
+}
+
+QPixmap CustomIconCache::cachedPixmap(const QUuid& uuid, IconSize size, int badgeSlot)
+{
+    // TODO: This check can go away when we move all QIcon handling outside of core
+    // On older versions of Qt, loading a QPixmap from QImage outside of a GUI
+    // environment causes ASAN to fail and crash on nullptr violation
+    static bool isGui = qApp->inherits("QGuiApplication");
+    if (!isGui || size < 0 || size >= SizeCount || badgeSlot < 0 || badgeSlot >= BadgeSlotCount) {
+        return {};
+    }
+
+    // Pixmaps rendered for another screen are of no use anymore
+    if (!qFuzzyCompare(devicePixelRatio(), m_devicePixelRatio)) {
+        m_devicePixelRatio = devicePixelRatio();
+        resetPixmaps();
+    }
+
+    auto icon = m_icons.find(uuid);
+    if (icon == m_icons.end()) {
+        return {};
+    }
+
+    QPixmap* pixmaps = icon->pixmaps[size];
+    if (pixmaps[0].isNull()) {
+        QImage scaledImage = icon->scaledImages[size];
+        if (scaledImage.isNull()) {
+            scaledImage = scaleImage(icon->image, pixelSize(size));
+            if (!m_scaled[size]) {
+                // Get the other icons of this size ready in the background
+                scaleIcons(size);
+            }
+        }
+
+        pixmaps[0] = QPixmap::fromImage(scaledImage);
+        pixmaps[0].setDevicePixelRatio(m_devicePixelRatio);
+        icon->scaledImages[size] = QImage();
+    }
+
+    if (pixmaps[badgeSlot].isNull()) {
+        pixmaps[badgeSlot] = databaseIcons()->applyBadge(pixmaps[0], static_cast<DatabaseIcons::Badges>(badgeSlot - 1));
+    }
+
+    return pixmaps[badgeSlot];
+}
+
+/**
+ * Scale all icons without a pixmap of the given size on the thread pool.
+ */
+void CustomIconCache::scaleIcons(IconSize size)
+{
+    m_scaled[size] = true;
+
+    QVector<ScaledImage> images;
+    for (auto icon = m_icons.cbegin(); icon != m_icons.cend(); ++icon) {
+        if (icon->pixmaps[size][0].isNull() && icon->scaledImages[size].isNull()) {
+            images.append({icon.key(), icon->image.cacheKey(), icon->image});
+        }
+    }
+
+    const int extent = pixelSize(size);
+    m_scaleWatchers[size].setFuture(QtConcurrent::run([images, extent]() mutable -> QVector<ScaledImage> {
+        for (auto& image : images) {
+            image.image = scaleImage(image.image, extent);
+        }
+        return images;
+    }));
+}
+
+void CustomIconCache::scalingFinished(IconSize size)
+{
+    // Results from before a reset were scaled for the old pixmaps
+    if (!m_scaled[size]) {
+        return;
+    }
+
+    const auto images = m_scaleWatchers[size].result();
+    for (const auto& image : images) {
+        auto icon = m_icons.find(image.uuid);
+        if (icon != m_icons.end() && icon->image.cacheKey() == image.sourceKey && icon->pixmaps[size][0].isNull()) {
+            icon->scaledImages[size] = image.image;
+        }
+    }
+}
+
+void CustomIconCache::resetPixmaps()
+{
+    for (auto& icon : m_icons) {
+        for (int size = 0; size < SizeCount; ++size) {
+            icon.scaledImages[size] = QImage();
+            for (int badgeSlot = 0; badgeSlot < BadgeSlotCount; ++badgeSlot) {
+                icon.pixmaps[size][badgeSlot] = QPixmap();
+            }
+        }
+    }
+
+    for (int size = 0; size < SizeCount; ++size) {
+        m_scaled[size] = false;
+    }
+}
+
+int CustomIconCache::pixelSize(IconSize size) const
+{
+    return qRound(databaseIcons()->iconSize(size) * m_devicePixelRatio);
+}
@@ -0,0 +1,86 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_CUSTOMICONCACHE_H
+#define KEEPASSXC_CUSTOMICONCACHE_H
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QUuid>
+#include <QVector>
+
+#include "core/DatabaseIcons.h"
+
+/**
+ * Pixmaps of the custom icons of one database by icon size and badge.
+ *
+ * A pixmap is only created the first time it is asked for and is kept until its
+ * icon is removed. The first pixmap of a size also scales all other custom icons
+ * to that size on the thread pool, so views painting long lists only need to
+ * convert images that are already prepared.
+ */
+class CustomIconCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CustomIconCache(QObject* parent = nullptr);
+
+    void insert(const QUuid& uuid, const QImage& image);
+    void remove(const QUuid& uuid);
+    void clear();
+
+    QPixmap pixmap(const QUuid& uuid, IconSize size);
+    QPixmap pixmap(const QUuid& uuid, IconSize size, DatabaseIcons::Badges badge);
+
+private:
+    static constexpr int SizeCount = 3;
+    // No badge, followed by one slot per DatabaseIcons::Badges value
+    static constexpr int BadgeSlotCount = 4;
+
+    struct Icon
+    {
+        QImage image;
+        QImage scaledImages[SizeCount];
+        QPixmap pixmaps[SizeCount][BadgeSlotCount];
+    };
+
+    struct ScaledImage
+    {
+        QUuid uuid;
+        qint64 sourceKey;
+        QImage image;
+    };
+
+    QPixmap cachedPixmap(const QUuid& uuid, IconSize size, int badgeSlot);
+    void scaleIcons(IconSize size);
+    void scalingFinished(IconSize size);
+    void resetPixmaps();
+    int pixelSize(IconSize size) const;
+
+    QHash<QUuid, Icon> m_icons;
+    QFutureWatcher<QVector<ScaledImage>> m_scaleWatchers[SizeCount];
+    bool m_scaled[SizeCount];
+    qreal m_devicePixelRatio;
+
+    Q_DISABLE_COPY(CustomIconCache)
+};
+
+#endif // KEEPASSXC_CUSTOMICONCACHE_H
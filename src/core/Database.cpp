@@ -20,10 +20,13 @@
 
 #include "core/AsyncTask.h"
 #include "core/Clock.h"
+#include "core/Config.h"
 #include "core/FileWatcher.h"
 #include "core/Group.h"
 #include "core/Merger.h"
 #include "core/Metadata.h"
+#include "core/Trace.h"
+#include "crypto/SessionCipher.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
@@ -36,6 +39,7 @@
 #include <QTemporaryFile>
 #include <QTimer>
 #include <QXmlStreamReader>
+#include <QtConcurrent>
 
 QHash<QUuid, QPointer<Database>> Database::s_uuidMap;
 
@@ -56,8 +60,11 @@ Database::Database()
 
     connect(m_metadata, SIGNAL(metadataModified()), SLOT(markAsModified()));
     connect(&m_modifiedTimer, SIGNAL(timeout()), SIGNAL(databaseModified()));
-    connect(this, SIGNAL(databaseOpened()), SLOT(updateCommonUsernames()));
-    connect(this, SIGNAL(databaseSaved()), SLOT(updateCommonUsernames()));
+    connect(this, SIGNAL(groupAboutToAdd(Group*,int)), SLOT(indexUsernames(Group*)));
+    connect(this, SIGNAL(groupAboutToRemove(Group*)), SLOT(unindexUsernames(Group*)));
+    connect(this, SIGNAL(groupAdded()), SLOT(invalidateEntryCache()));
+    connect(this, SIGNAL(groupRemoved()), SLOT(invalidateEntryCache()));
+    connect(this, SIGNAL(groupMoved()), SLOT(invalidateEntryCache()));
     connect(m_fileWatcher, &FileWatcher::fileChanged, this, &Database::databaseFileChanged);
 
     m_modified = false;
@@ -137,6 +144,8 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
     setEmitModified(false);
 
     KeePass2Reader reader;
+    reader.setLazyEntryLoading(config()->get(Config::LazyEntryLoading).toBool());
+    reader.setParallelParsing(config()->get(Config::ParallelEntryParsing).toBool());
     if (!reader.readDatabase(&dbFile, std::move(key), this)) {
         if (error) {
             *error = tr("Error while reading the database: %1").arg(reader.errorString());
@@ -153,6 +162,7 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
     emit databaseOpened();
     m_fileWatcher->start(canonicalFilePath(), 30, 1);
     setEmitModified(true);
+    prepareNextKey();
 
     return true;
 }
@@ -254,6 +264,7 @@ bool Database::saveAs(const QString& filePath, QString* error, bool atomic, bool
     QFileInfo fileInfo(filePath);
     auto realFilePath = fileInfo.exists() ? fileInfo.canonicalFilePath() : fileInfo.absoluteFilePath();
     bool isNewFile = !QFile::exists(realFilePath);
+    // Entries that were not accessed yet are streamed by the writer, see Group::streamEntries()
     bool ok = AsyncTask::runAndWaitForFuture([&] { return performSave(realFilePath, error, atomic, backup); });
     if (ok) {
         markAsClean();
@@ -262,6 +273,7 @@ bool Database::saveAs(const QString& filePath, QString* error, bool atomic, bool
             QFile::setPermissions(realFilePath, QFile::ReadUser | QFile::WriteUser);
         }
         m_fileWatcher->start(realFilePath, 30, 1);
+        prepareNextKey();
     } else {
         // Saving failed, don't rewatch file since it does not represent our database
         markAsModified();
@@ -437,6 +449,7 @@ void Database::releaseData()
     m_uuid = QUuid();
 
     m_data.clear();
+    m_nextKey = PreparedKey();
     m_metadata->clear();
 
     setRootGroup(new Group());
@@ -444,7 +457,9 @@ void Database::releaseData()
     m_fileWatcher->stop();
 
     m_deletedObjects.clear();
-    m_commonUsernames.clear();
+
+    // Drop decrypted protected values of all databases, they are decrypted again on demand
+    SessionCipher::clearCache();
 }
 
 /**
@@ -540,6 +555,47 @@ void Database::setRootGroup(Group* group)
 
     m_rootGroup = group;
     m_rootGroup->setParent(this);
+    invalidateEntryCache();
+
+    // Entries of the new tree are counted from scratch, later changes are tracked
+    m_indexedUsernames.clear();
+    m_usernameCounts.clear();
+    m_commonUsernamesValid = false;
+    indexUsernames(m_rootGroup);
+}
+
+/**
+ * All loaded entries of the database in tree order, including the recycle bin.
+ * The list is cached until groups or entries are added, removed or moved,
+ * use it instead of rootGroup()->entriesRecursive() in frequently called code.
+ *
+ * Groups whose entries were not accessed yet are skipped, see
+ * Group::setEntryLoader(). Call rootGroup()->loadEntriesRecursive() first
+ * where every entry is needed.
+ */
+QList<Entry*> Database::entries() const
+{
+    QMutexLocker locker(&m_entryCacheMutex);
+    if (!m_entryCacheValid) {
+        m_entryCache.clear();
+        if (m_rootGroup) {
+            m_rootGroup->walkGroups([this](const Group* group) -> bool {
+                if (!group->hasPendingEntries()) {
+                    m_entryCache.append(group->entries());
+                }
+                return false;
+            });
+        }
+        m_entryCacheValid = true;
+    }
+    return m_entryCache;
+}
+
+void Database::invalidateEntryCache()
+{
+    QMutexLocker locker(&m_entryCacheMutex);
+    m_entryCacheValid = false;
+    m_entryCache.clear();
 }
 
 Metadata* Database::metadata()
@@ -641,15 +697,150 @@ void Database::addDeletedObject(const QUuid& uuid)
     addDeletedObject(delObj);
 }
 
-QList<QString> Database::commonUsernames()
+/**
+ * Most frequently used usernames, ties are sorted by name.
+ * Usernames are counted as entries are added, edited and removed,
+ * the ranking is only recomputed once the counts of its usernames change.
+ *
+ * @param topN maximum number of usernames, -1 for all
+ * @return usernames in descending order of frequency
+ */
+QList<QString> Database::commonUsernames(int topN)
 {
+    if (m_commonUsernamesValid && m_commonUsernamesTopN == topN) {
+        return m_commonUsernames;
+    }
+
+    TRACE_SCOPE("Database::commonUsernames");
+
+    QVector<QPair<QString, int>> usernames;
+    usernames.reserve(m_usernameCounts.size());
+    for (auto it = m_usernameCounts.cbegin(); it != m_usernameCounts.cend(); ++it) {
+        usernames.append({it.key(), it.value()});
+    }
+
+    auto comparator = [](const QPair<QString, int>& arg1, const QPair<QString, int>& arg2) -> bool {
+        if (arg1.second == arg2.second) {
+            return arg1.first < arg2.first;
+        }
+        return arg1.second > arg2.second;
+    };
+
+    const int count = topN < 0 ? usernames.size() : qMin(topN, usernames.size());
+    std::partial_sort(usernames.begin(), usernames.begin() + count, usernames.end(), comparator);
+
+    m_commonUsernames.clear();
+    for (int i = 0; i < count; ++i) {
+        m_commonUsernames.append(usernames[i].first);
+    }
+    m_commonUsernamesTopN = topN;
+    m_commonUsernamesMinCount = count > 0 ? usernames[count - 1].second : 0;
+    m_commonUsernamesValid = true;
+
     return m_commonUsernames;
 }
 
-void Database::updateCommonUsernames(int topN)
+void Database::indexUsername(Entry* entry)
 {
-    m_commonUsernames.clear();
-    m_commonUsernames.append(rootGroup()->usernamesRecursive(topN));
+    updateUsernameIndex(entry, false);
+}
+
+void Database::unindexUsername(Entry* entry)
+{
+    updateUsernameIndex(entry, true);
+}
+
+/**
+ * Groups that were read lazily are counted by the usernames the reader
+ * recorded, their entries are counted once they are loaded, see
+ * Group::setEntryLoader().
+ */
+void Database::indexUsernames(Group* group)
+{
+    group->walkGroups([this](const Group* child) -> bool {
+        if (child->hasPendingEntries()) {
+            for (const QString& username : child->pendingEntryUsernames()) {
+                countUsername(username, 1);
+            }
+        } else {
+            for (const Entry* entry : child->entries()) {
+                updateUsernameIndex(entry, false);
+            }
+        }
+        return false;
+    });
+}
+
+void Database::unindexUsernames(Group* group)
+{
+    group->walkGroups([this](const Group* child) -> bool {
+        if (child->hasPendingEntries()) {
+            for (const QString& username : child->pendingEntryUsernames()) {
+                countUsername(username, -1);
+            }
+        } else {
+            for (const Entry* entry : child->entries()) {
+                updateUsernameIndex(entry, true);
+            }
+        }
+        return false;
+    });
+}
+
+void Database::unindexPendingUsernames(Group* group)
+{
+    for (const QString& username : group->pendingEntryUsernames()) {
+        countUsername(username, -1);
+    }
+}
+
+/**
+ * Count the current username of an entry instead of the one it was last
+ * counted with. Safe to call repeatedly for the same entry.
+ *
+ * @param entry entry that was added, changed or is being removed
+ * @param remove stop counting the username of the entry
+ */
+void Database::updateUsernameIndex(const Entry* entry, bool remove)
+{
+    QString username;
+    if (!remove && !entry->isAttributeReference(EntryAttributes::UserNameKey)) {
+        username = entry->username();
+    }
+
+    const auto indexed = m_indexedUsernames.constFind(entry);
+    if (indexed != m_indexedUsernames.cend()) {
+        if (indexed.value() == username) {
+            return;
+        }
+        countUsername(indexed.value(), -1);
+    }
+
+    if (username.isEmpty()) {
+        m_indexedUsernames.remove(entry);
+    } else {
+        m_indexedUsernames.insert(entry, username);
+        countUsername(username, 1);
+    }
+}
+
+void Database::countUsername(const QString& username, int delta)
+{
+    int& count = m_usernameCounts[username];
+    count += delta;
+    const int newCount = count;
+    if (newCount <= 0) {
+        m_usernameCounts.remove(username);
+    }
+
+    // The ranking only changes if the username is, or can become, one of the most common ones
+    if (m_commonUsernamesValid
+        && (m_commonUsernames.contains(username)
+            || (delta > 0
+                && (m_commonUsernamesTopN < 0 || m_commonUsernames.size() < m_commonUsernamesTopN
+                    || newCount >= m_commonUsernamesMinCount)))) {
+        m_commonUsernamesValid = false;
+    }
 }
 
 const QUuid& Database::cipher() const
@@ -760,6 +951,80 @@ bool Database::setKey(const QSharedPointer<const CompositeKey>& key,
     return true;
 }
 
+/**
+ * Switch to a fresh KDF seed before writing the database.
+ *
+ * The transformed key for the next seed is derived in the background after
+ * opening and after every save (see prepareNextKey()), so saving normally
+ * does not have to run the KDF. If the key or the KDF parameters changed in
+ * the meantime, the key is transformed inline as before.
+ *
+ * @return true on success
+ */
+bool Database::renewTransformSeed()
+{
+    const PreparedKey next = m_nextKey;
+    m_nextKey = PreparedKey();
+
+    if (isPreparedKeyUsable(next)) {
+        // Waiting for a running derivation is never slower than starting over
+        const QByteArray transformedDatabaseKey = next.transformedKey.result();
+        if (!transformedDatabaseKey.isEmpty() && m_data.kdf->setSeed(next.kdf->seed())) {
+            m_keyError.clear();
+            m_data.transformedDatabaseKey->setHash(transformedDatabaseKey);
+            markAsModified();
+            return true;
+        }
+    }
+
+    return setKey(m_data.key, false, true);
+}
+
+/**
+ * Start deriving the transformed key for a new random KDF seed in the background.
+ * The result is picked up by the next call to renewTransformSeed().
+ */
+void Database::prepareNextKey()
+{
+    m_nextKey = PreparedKey();
+
+    if (m_data.isReadOnly || !m_data.key || m_data.key->isEmpty() || !m_data.kdf) {
+        return;
+    }
+
+    // Challenge-response keys take part in the transformation (except for
+    // legacy AES-KDF) and must not prompt for hardware interaction unasked
+    if (!m_data.key->challengeResponseKeys().isEmpty() && m_data.kdf->uuid() != KeePass2::KDF_AES_KDBX3) {
+        return;
+    }
+
+    auto key = m_data.key;
+    auto kdf = m_data.kdf->clone();
+    kdf->randomizeSeed();
+
+    m_nextKey.key = key;
+    m_nextKey.kdf = kdf;
+    m_nextKey.transformedKey = QtConcurrent::run([key, kdf] {
+        QByteArray transformedKey;
+        if (!key->transform(*kdf, transformedKey)) {
+            transformedKey.clear();
+        }
+        return transformedKey;
+    });
+}
+
+bool Database::isPreparedKeyUsable(const PreparedKey& next) const
+{
+    if (!next.key || next.key != m_data.key || !next.kdf || !m_data.kdf || next.kdf->uuid() != m_data.kdf->uuid()) {
+        return false;
+    }
+
+    // Compare all KDF parameters except for the seed
+    auto current = m_data.kdf->clone();
+    current->setSeed(next.kdf->seed());
+    return current->writeParameters() == next.kdf->writeParameters();
+}
+
 QString Database::keyError()
 {
     return m_keyError;
@@ -826,6 +1091,7 @@ void Database::emptyRecycleBin()
 {
     Q_ASSERT(!m_data.isReadOnly);
     if (m_metadata->recycleBinEnabled() && m_metadata->recycleBin()) {
+        BulkUpdate bulkUpdate(this);
         // destroying direct entries of the recycle bin
         QList<Entry*> subEntries = m_metadata->recycleBin()->entries();
         for (Entry* entry : subEntries) {
@@ -848,6 +1114,52 @@ void Database::setEmitModified(bool value)
     m_emitModified = value;
 }
 
+/**
+ * Start a bulk update of the database. Until the matching endBulkUpdate(),
+ * views should not act on individual group and entry signals but refresh
+ * completely once bulkUpdateFinished() is emitted. The databaseModified()
+ * signal is held back and emitted at most once at the end. Bulk updates nest.
+ */
+void Database::beginBulkUpdate()
+{
+    if (m_bulkUpdateDepth++ == 0) {
+        emit bulkUpdateStarted();
+    }
+}
+
+void Database::endBulkUpdate()
+{
+    Q_ASSERT(m_bulkUpdateDepth > 0);
+    if (m_bulkUpdateDepth <= 0 || --m_bulkUpdateDepth > 0) {
+        return;
+    }
+
+    emit bulkUpdateFinished();
+    if (m_modified) {
+        markAsModified();
+    }
+}
+
+bool Database::isBulkUpdating() const
+{
+    return m_bulkUpdateDepth > 0;
+}
+
+Database::BulkUpdate::BulkUpdate(Database* db)
+    : m_db(db)
+{
+    if (m_db) {
+        m_db->beginBulkUpdate();
+    }
+}
+
+Database::BulkUpdate::~BulkUpdate()
+{
+    if (m_db) {
+        m_db->endBulkUpdate();
+    }
+}
+
 bool Database::isModified() const
 {
     return m_modified;
@@ -861,7 +1173,7 @@ bool Database::hasNonDataChanges() const
 void Database::markAsModified()
 {
     m_modified = true;
-    if (m_emitModified && !m_modifiedTimer.isActive()) {
+    if (m_emitModified && m_bulkUpdateDepth == 0 && !m_modifiedTimer.isActive()) {
         // Small time delay prevents numerous consecutive saves due to repeated signals
         m_modifiedTimer.start(150);
     }
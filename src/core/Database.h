@@ -20,6 +20,7 @@
 #define KEEPASSX_DATABASE_H
 
 #include <QDateTime>
+#include <QFuture>
 #include <QHash>
 #include <QMutex>
 #include <QPointer>
@@ -64,6 +65,21 @@ public:
     };
     static const quint32 CompressionAlgorithmMax = CompressionGZip;
 
+    /**
+     * Scope guard that keeps a database in bulk update mode while it exists.
+     */
+    class BulkUpdate
+    {
+    public:
+        explicit BulkUpdate(Database* db);
+        ~BulkUpdate();
+
+    private:
+        Q_DISABLE_COPY(BulkUpdate)
+
+        QPointer<Database> m_db;
+    };
+
     Database();
     explicit Database(const QString& filePath);
     ~Database() override;
@@ -84,6 +100,9 @@ public:
     bool isModified() const;
     bool hasNonDataChanges() const;
     void setEmitModified(bool value);
+    void beginBulkUpdate();
+    void endBulkUpdate();
+    bool isBulkUpdating() const;
     bool isReadOnly() const;
     void setReadOnly(bool readOnly);
     bool isSaving();
@@ -98,6 +117,7 @@ public:
     Group* rootGroup();
     const Group* rootGroup() const;
     void setRootGroup(Group* group);
+    QList<Entry*> entries() const;
     QVariantMap& publicCustomData();
     const QVariantMap& publicCustomData() const;
     void setPublicCustomData(const QVariantMap& customData);
@@ -113,13 +133,14 @@ public:
     bool containsDeletedObject(const DeletedObject& uuid) const;
     void setDeletedObjects(const QList<DeletedObject>& delObjs);
 
-    QList<QString> commonUsernames();
+    QList<QString> commonUsernames(int topN = 10);
 
     QSharedPointer<const CompositeKey> key() const;
     bool setKey(const QSharedPointer<const CompositeKey>& key,
                 bool updateChangedTime = true,
                 bool updateTransformSalt = false,
                 bool transformKey = true);
+    bool renewTransformSeed();
     QString keyError();
     QByteArray challengeResponseKey() const;
     bool challengeMasterSeed(const QByteArray& masterSeed);
@@ -138,8 +159,8 @@ public:
 public slots:
     void markAsModified();
     void markAsClean();
-    void updateCommonUsernames(int topN = 10);
     void markNonDataChange();
+    void invalidateEntryCache();
 
 signals:
     void filePathChanged(const QString& oldPath, const QString& newPath);
@@ -150,11 +171,22 @@ signals:
     void groupRemoved();
     void groupAboutToMove(Group* group, Group* toGroup, int index);
     void groupMoved();
+    void entryAdded(Entry* entry);
+    void entryRemoved(Entry* entry);
     void databaseOpened();
     void databaseModified();
     void databaseSaved();
     void databaseDiscarded();
     void databaseFileChanged();
+    void bulkUpdateStarted();
+    void bulkUpdateFinished();
+
+private slots:
+    void indexUsername(Entry* entry);
+    void unindexUsername(Entry* entry);
+    void indexUsernames(Group* group);
+    void unindexUsernames(Group* group);
+    void unindexPendingUsernames(Group* group);
 
 private:
     struct DatabaseData
@@ -196,7 +228,18 @@ private:
         }
     };
 
+    struct PreparedKey
+    {
+        QSharedPointer<const CompositeKey> key;
+        QSharedPointer<Kdf> kdf;
+        QFuture<QByteArray> transformedKey;
+    };
+
     void createRecycleBin();
+    void updateUsernameIndex(const Entry* entry, bool remove);
+    void countUsername(const QString& username, int delta);
+    void prepareNextKey();
+    bool isPreparedKeyUsable(const PreparedKey& next) const;
 
     bool writeDatabase(QIODevice* device, QString* error = nullptr);
     bool backupDatabase(const QString& filePath);
@@ -205,17 +248,28 @@ private:
 
     QPointer<Metadata> const m_metadata;
     DatabaseData m_data;
+    PreparedKey m_nextKey;
     QPointer<Group> m_rootGroup;
+    mutable QMutex m_entryCacheMutex;
+    mutable QList<Entry*> m_entryCache;
+    mutable bool m_entryCacheValid = false;
     QList<DeletedObject> m_deletedObjects;
     QTimer m_modifiedTimer;
     QMutex m_saveMutex;
     QPointer<FileWatcher> m_fileWatcher;
     bool m_modified = false;
     bool m_emitModified;
+    int m_bulkUpdateDepth = 0;
     bool m_hasNonDataChange = false;
     QString m_keyError;
 
+    // Counted username of every entry and how often each username is used
+    QHash<const Entry*, QString> m_indexedUsernames;
+    QHash<QString, int> m_usernameCounts;
     QList<QString> m_commonUsernames;
+    int m_commonUsernamesTopN = 0;
+    int m_commonUsernamesMinCount = 0;
+    bool m_commonUsernamesValid = false;
 
     QUuid m_uuid;
     static QHash<QUuid, QPointer<Database>> s_uuidMap;
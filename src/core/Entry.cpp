@@ -31,6 +31,23 @@
 #include <QRegularExpression>
 #include <utility>
 
+namespace
+{
+    /**
+     * Copy of a history item component for its compact form, or null if it
+     * is equal in the next newer item.
+     */
+    template <class T> QSharedPointer<T> changedComponent(const T* component, const T* newer)
+    {
+        QSharedPointer<T> copy;
+        if (!newer || *component != *newer) {
+            copy.reset(new T());
+            copy->copyDataFrom(component);
+        }
+        return copy;
+    }
+} // namespace
+
 const int Entry::DefaultIconNumber = 0;
 const int Entry::ResolveMaximumDepth = 10;
 const QString Entry::AutoTypeSequenceUsername = "{USERNAME}{ENTER}";
@@ -41,6 +58,7 @@ Entry::Entry()
     , m_attachments(new EntryAttachments(this))
     , m_autoTypeAssociations(new AutoTypeAssociations(this))
     , m_customData(new CustomData(this))
+    , m_historyMaterialized(false)
     , m_modifiedSinceBegin(false)
     , m_updateTimeinfo(true)
 {
@@ -48,15 +66,7 @@ Entry::Entry()
     m_data.autoTypeEnabled = true;
     m_data.autoTypeObfuscation = 0;
 
-    connect(m_attributes, SIGNAL(entryAttributesModified()), SLOT(updateTotp()));
-    connect(m_attributes, SIGNAL(entryAttributesModified()), this, SIGNAL(entryModified()));
-    connect(m_attributes, SIGNAL(defaultKeyModified()), SLOT(emitDataChanged()));
-    connect(m_attachments, SIGNAL(entryAttachmentsModified()), this, SIGNAL(entryModified()));
-    connect(m_autoTypeAssociations, SIGNAL(modified()), SIGNAL(entryModified()));
-    connect(m_customData, SIGNAL(customDataModified()), this, SIGNAL(entryModified()));
-
-    connect(this, SIGNAL(entryModified()), SLOT(updateTimeinfo()));
-    connect(this, SIGNAL(entryModified()), SLOT(updateModifiedSinceBegin()));
+    // The components report their changes to the entry directly, see emitModified()
 }
 
 Entry::~Entry()
@@ -77,7 +87,7 @@ template <class T> inline bool Entry::set(T& property, const T& value)
 {
     if (property != value) {
         property = value;
-        emit entryModified();
+        emitModified();
         return true;
     }
     return false;
@@ -180,17 +190,19 @@ QPixmap Entry::iconPixmap(IconSize size) const
     QPixmap icon(size, size);
     if (m_data.customIcon.isNull()) {
         icon = databaseIcons()->icon(m_data.iconNumber, size);
+        if (isExpired()) {
+            icon = databaseIcons()->applyBadge(icon, DatabaseIcons::Badges::Expired);
+        }
     } else {
         Q_ASSERT(database());
-        if (database()) {
+        if (database() && isExpired()) {
+            // Custom icons are cached along with their badge
+            icon = database()->metadata()->customIconPixmap(m_data.customIcon, size, DatabaseIcons::Badges::Expired);
+        } else if (database()) {
             icon = database()->metadata()->customIconPixmap(m_data.customIcon, size);
         }
     }
 
-    if (isExpired()) {
-        icon = databaseIcons()->applyBadge(icon, DatabaseIcons::Badges::Expired);
-    }
-
     return icon;
 }
 
@@ -335,7 +347,7 @@ QString Entry::attribute(const QString& key) const
 int Entry::size() const
 {
     int size = 0;
-    const QRegularExpression delimiter(",|:|;");
+    static const QRegularExpression delimiter(",|:|;");
 
     size += this->attributes()->attributesSize();
     size += this->autoTypeAssociations()->associationsSize();
@@ -515,7 +527,7 @@ void Entry::setIcon(int iconNumber)
         m_data.iconNumber = iconNumber;
         m_data.customIcon = QUuid();
 
-        emit entryModified();
+        emitModified();
         emitDataChanged();
     }
 }
@@ -528,7 +540,7 @@ void Entry::setIcon(const QUuid& uuid)
         m_data.customIcon = uuid;
         m_data.iconNumber = 0;
 
-        emit entryModified();
+        emitModified();
         emitDataChanged();
     }
 }
@@ -619,7 +631,7 @@ void Entry::setExpires(const bool& value)
 {
     if (m_data.timeInfo.expires() != value) {
         m_data.timeInfo.setExpires(value);
-        emit entryModified();
+        emitModified();
     }
 }
 
@@ -627,26 +639,114 @@ void Entry::setExpiryTime(const QDateTime& dateTime)
 {
     if (m_data.timeInfo.expiryTime() != dateTime) {
         m_data.timeInfo.setExpiryTime(dateTime);
-        emit entryModified();
+        emitModified();
     }
 }
 
+/**
+ * History items that stay valid until compactHistory() is called. A compact
+ * history is expanded for this, so only use it to edit the items and compact
+ * the history again afterwards. Read it with walkHistoryItems() instead.
+ */
 QList<Entry*> Entry::historyItems()
 {
+    materializeHistory();
     return m_history;
 }
 
-const QList<Entry*>& Entry::historyItems() const
+/**
+ * @return copies of the history items from oldest to newest, owned by the caller
+ */
+QList<Entry*> Entry::cloneHistoryItems() const
 {
-    return m_history;
+    if (!m_historyMaterialized) {
+        return buildHistoryItems();
+    }
+
+    QList<Entry*> historyItems;
+    for (const Entry* historyItem : m_history) {
+        historyItems.append(historyItem->clone(CloneNoFlags));
+    }
+    return historyItems;
+}
+
+int Entry::historyCount() const
+{
+    return m_historyMaterialized ? m_history.size() : m_historyDeltas.size();
 }
 
 void Entry::addHistoryItem(Entry* entry)
 {
     Q_ASSERT(!entry->parent());
 
+    // The caller may still hold the item, keep it as a full Entry
+    materializeHistory();
+
+    // Store unchanged fields only once, whether they match this entry or the previous history item
+    shareHistoryData(entry, this);
+    if (!m_history.isEmpty()) {
+        shareHistoryData(m_history.last(), entry);
+    }
+
     m_history.append(entry);
-    emit entryModified();
+    emitModified();
+}
+
+/**
+ * Append the newest history item to the compact history without building the
+ * other items. Only the previous newest item drops the components that are
+ * equal in the new one, all older items are left alone.
+ */
+void Entry::appendHistoryDelta(Entry* historyItem)
+{
+    Q_ASSERT(!m_historyMaterialized);
+
+    if (!m_historyDeltas.isEmpty()) {
+        HistoryDelta& previous = m_historyDeltas.last();
+        Q_ASSERT(previous.attributes && previous.attachments && previous.autoTypeAssociations && previous.customData);
+        if (*previous.attributes == *historyItem->m_attributes) {
+            previous.attributes.reset();
+        }
+        if (*previous.attachments == *historyItem->m_attachments) {
+            previous.attachments.reset();
+        }
+        if (*previous.autoTypeAssociations == *historyItem->m_autoTypeAssociations) {
+            previous.autoTypeAssociations.reset();
+        }
+        if (*previous.customData == *historyItem->m_customData) {
+            previous.customData.reset();
+        }
+    }
+
+    m_historyDeltas.append(historyDelta(historyItem, nullptr));
+    delete historyItem;
+    emitModified();
+}
+
+/**
+ * Let a history item reuse the storage of all fields that are equal in the
+ * next newer version. History items read from a file or merged from another
+ * database otherwise carry their own copy of every unchanged field.
+ */
+void Entry::shareHistoryData(Entry* historyItem, const Entry* newer)
+{
+    EntryData& data = historyItem->m_data;
+    const EntryData& newerData = newer->m_data;
+    auto share = [](QString& value, const QString& newerValue) {
+        if (value == newerValue) {
+            value = newerValue;
+        }
+    };
+    share(data.foregroundColor, newerData.foregroundColor);
+    share(data.backgroundColor, newerData.backgroundColor);
+    share(data.overrideUrl, newerData.overrideUrl);
+    share(data.tags, newerData.tags);
+    share(data.defaultAutoTypeSequence, newerData.defaultAutoTypeSequence);
+
+    historyItem->m_attributes->shareDataWith(newer->m_attributes);
+    historyItem->m_attachments->shareDataWith(newer->m_attachments);
+    historyItem->m_autoTypeAssociations->shareDataWith(newer->m_autoTypeAssociations);
+    historyItem->m_customData->shareDataWith(newer->m_customData);
 }
 
 void Entry::removeHistoryItems(const QList<Entry*>& historyEntries)
@@ -655,6 +755,7 @@ void Entry::removeHistoryItems(const QList<Entry*>& historyEntries)
         return;
     }
 
+    materializeHistory();
     for (Entry* entry : historyEntries) {
         Q_ASSERT(!entry->parent());
         Q_ASSERT(entry->uuid().isNull() || entry->uuid() == uuid());
@@ -664,7 +765,23 @@ void Entry::removeHistoryItems(const QList<Entry*>& historyEntries)
         delete entry;
     }
 
-    emit entryModified();
+    emitModified();
+}
+
+/**
+ * Remove all history items without building a compact history.
+ */
+void Entry::clearHistory()
+{
+    if (historyCount() == 0) {
+        return;
+    }
+
+    qDeleteAll(m_history);
+    m_history.clear();
+    m_historyDeltas.clear();
+    m_historyMaterialized = false;
+    emitModified();
 }
 
 void Entry::truncateHistory()
@@ -675,50 +792,142 @@ void Entry::truncateHistory()
         return;
     }
 
-    bool changed = false;
+    // Only the oldest items are dropped, compact history is truncated as is
+    const int count = historyCount();
+    int keep = count;
     int histMaxItems = db->metadata()->historyMaxItems();
     if (histMaxItems > -1) {
-        int historyCount = 0;
-        QMutableListIterator<Entry*> i(m_history);
-        i.toBack();
-        while (i.hasPrevious()) {
-            historyCount++;
-            Entry* entry = i.previous();
-            if (historyCount > histMaxItems) {
-                delete entry;
-                i.remove();
-                changed = true;
-            }
-        }
+        keep = qMin(keep, histMaxItems);
     }
 
     int histMaxSize = db->metadata()->historyMaxSize();
     if (histMaxSize > -1) {
         int size = 0;
-        QSet<QByteArray> foundAttachments = attachments()->values();
-
-        QMutableListIterator<Entry*> i(m_history);
-        i.toBack();
-        while (i.hasPrevious()) {
-            Entry* historyItem = i.previous();
-
-            // don't calculate size if it's already above the maximum
-            if (size <= histMaxSize) {
-                size += historyItem->size();
-                foundAttachments += historyItem->attachments()->values();
-            }
-
+        for (int i = 0; i < keep; ++i) {
+            size += historyItemSize(count - 1 - i);
             if (size > histMaxSize) {
-                delete historyItem;
-                i.remove();
-                changed = true;
+                keep = i;
+                break;
             }
         }
     }
 
-    if (changed) {
-        emit entryModified();
+    if (keep == count) {
+        return;
+    }
+
+    if (m_historyMaterialized) {
+        for (int i = keep; i < count; ++i) {
+            delete m_history.takeFirst();
+        }
+    } else {
+        m_historyDeltas = m_historyDeltas.mid(count - keep);
+    }
+    emitModified();
+}
+
+/**
+ * Replace the history items by their compact form, which only stores the
+ * components that differ from the next newer item. Pointers to history
+ * items become invalid, they are built again on the next historyItems() call.
+ */
+void Entry::compactHistory()
+{
+    if (!m_historyMaterialized) {
+        return;
+    }
+
+    QList<HistoryDelta> deltas;
+    deltas.reserve(m_history.size());
+    for (int i = 0; i < m_history.size(); ++i) {
+        const Entry* newer = i + 1 < m_history.size() ? m_history.at(i + 1) : nullptr;
+        deltas.append(historyDelta(m_history.at(i), newer));
+    }
+
+    qDeleteAll(m_history);
+    m_history.clear();
+    m_historyDeltas = deltas;
+    m_historyMaterialized = false;
+}
+
+/**
+ * Compact form of a history item, storing only the components that differ
+ * from the next newer item, or all of them for the newest one.
+ */
+Entry::HistoryDelta Entry::historyDelta(const Entry* historyItem, const Entry* newer)
+{
+    HistoryDelta delta;
+    delta.uuid = historyItem->m_uuid;
+    delta.data = historyItem->m_data;
+    delta.attributes =
+        changedComponent<EntryAttributes>(historyItem->m_attributes, newer ? newer->m_attributes.data() : nullptr);
+    delta.attachments =
+        changedComponent<EntryAttachments>(historyItem->m_attachments, newer ? newer->m_attachments.data() : nullptr);
+    delta.autoTypeAssociations = changedComponent<AutoTypeAssociations>(
+        historyItem->m_autoTypeAssociations, newer ? newer->m_autoTypeAssociations.data() : nullptr);
+    delta.customData =
+        changedComponent<CustomData>(historyItem->m_customData, newer ? newer->m_customData.data() : nullptr);
+    delta.size = historyItem->size();
+    return delta;
+}
+
+void Entry::materializeHistory()
+{
+    if (m_historyMaterialized) {
+        return;
+    }
+
+    m_history = buildHistoryItems();
+    m_historyDeltas.clear();
+    m_historyMaterialized = true;
+}
+
+/**
+ * Build full Entry objects for the compact history items, starting at the
+ * newest item and filling in the components each older item left out.
+ */
+QList<Entry*> Entry::buildHistoryItems() const
+{
+    QList<Entry*> historyItems;
+    const EntryAttributes* attributes = nullptr;
+    const EntryAttachments* attachments = nullptr;
+    const AutoTypeAssociations* autoTypeAssociations = nullptr;
+    const CustomData* customData = nullptr;
+
+    for (int i = m_historyDeltas.size() - 1; i >= 0; --i) {
+        const HistoryDelta& delta = m_historyDeltas.at(i);
+        if (delta.attributes) {
+            attributes = delta.attributes.data();
+        }
+        if (delta.attachments) {
+            attachments = delta.attachments.data();
+        }
+        if (delta.autoTypeAssociations) {
+            autoTypeAssociations = delta.autoTypeAssociations.data();
+        }
+        if (delta.customData) {
+            customData = delta.customData.data();
+        }
+        Q_ASSERT(attributes && attachments && autoTypeAssociations && customData);
+
+        auto historyItem = new Entry();
+        historyItem->setUpdateTimeinfo(false);
+        historyItem->m_uuid = delta.uuid;
+        historyItem->m_data = delta.data;
+        historyItem->m_attributes->copyDataFrom(attributes);
+        historyItem->m_attachments->copyDataFrom(attachments);
+        historyItem->m_autoTypeAssociations->copyDataFrom(autoTypeAssociations);
+        historyItem->m_customData->copyDataFrom(customData);
+        historyItem->setUpdateTimeinfo(true);
+        historyItems.prepend(historyItem);
     }
+
+    return historyItems;
+}
+
+int Entry::historyItemSize(int index) const
+{
+    return m_historyMaterialized ? m_history.at(index)->size() : m_historyDeltas.at(index).size;
 }
 
 bool Entry::equals(const Entry* other, CompareItemOptions options) const
@@ -745,14 +954,18 @@ bool Entry::equals(const Entry* other, CompareItemOptions options) const
         return false;
     }
     if (!options.testFlag(CompareItemIgnoreHistory)) {
-        if (m_history.count() != other->m_history.count()) {
+        if (historyCount() != other->historyCount()) {
             return false;
         }
-        for (int i = 0; i < m_history.count(); ++i) {
-            if (!m_history[i]->equals(other->m_history[i], options)) {
-                return false;
-            }
+        const QList<Entry*> history = cloneHistoryItems();
+        const QList<Entry*> otherHistory = other->cloneHistoryItems();
+        bool equal = true;
+        for (int i = 0; equal && i < history.count(); ++i) {
+            equal = history[i]->equals(otherHistory[i], options);
         }
+        qDeleteAll(history);
+        qDeleteAll(otherHistory);
+        return equal;
     }
     return true;
 }
@@ -785,13 +998,17 @@ Entry* Entry::clone(CloneFlags flags) const
 
     entry->m_autoTypeAssociations->copyDataFrom(m_autoTypeAssociations);
     if (flags & CloneIncludeHistory) {
-        for (Entry* historyItem : m_history) {
+        walkHistoryItems([entry, flags](const Entry* historyItem) -> bool {
             Entry* historyItemClone =
                 historyItem->clone(flags & ~CloneIncludeHistory & ~CloneNewUuid & ~CloneResetTimeInfo);
             historyItemClone->setUpdateTimeinfo(false);
             historyItemClone->setUuid(entry->uuid());
             historyItemClone->setUpdateTimeinfo(true);
             entry->addHistoryItem(historyItemClone);
+            return false;
+        });
+        if (!m_historyMaterialized) {
+            entry->compactHistory();
         }
     }
 
@@ -814,6 +1031,8 @@ Entry* Entry::clone(CloneFlags flags) const
 
 void Entry::copyDataFrom(const Entry* other)
 {
+    const QString oldUsername = username();
+
     setUpdateTimeinfo(false);
     m_data = other->m_data;
     m_customData->copyDataFrom(other->m_customData);
@@ -821,6 +1040,12 @@ void Entry::copyDataFrom(const Entry* other)
     m_attachments->copyDataFrom(other->m_attachments);
     m_autoTypeAssociations->copyDataFrom(other->m_autoTypeAssociations);
     setUpdateTimeinfo(true);
+
+    // Replacing the attributes wholesale does not emit defaultKeyModified(),
+    // so keep the database username index in sync explicitly
+    if (username() != oldUsername) {
+        emitDataChanged();
+    }
 }
 
 void Entry::beginUpdate()
@@ -843,7 +1068,12 @@ bool Entry::endUpdate()
     Q_ASSERT(!m_tmpHistoryItem.isNull());
     if (m_modifiedSinceBegin) {
         m_tmpHistoryItem->setUpdateTimeinfo(true);
-        addHistoryItem(m_tmpHistoryItem.take());
+        if (m_historyMaterialized) {
+            addHistoryItem(m_tmpHistoryItem.take());
+        } else {
+            // Nobody holds items of a compact history, keep it compact
+            appendHistoryDelta(m_tmpHistoryItem.take());
+        }
         truncateHistory();
     }
 
@@ -857,6 +1087,23 @@ void Entry::updateModifiedSinceBegin()
     m_modifiedSinceBegin = true;
 }
 
+/**
+ * Update the modification time and emit entryModified(). Also called by the
+ * components of the entry, which are not connected to it.
+ */
+void Entry::emitModified()
+{
+    updateTimeinfo();
+    updateModifiedSinceBegin();
+    emit entryModified();
+}
+
+void Entry::attributesModified()
+{
+    updateTotp();
+    emitModified();
+}
+
 QString Entry::resolveMultiplePlaceholdersRecursive(const QString& str, int maxDepth) const
 {
     if (maxDepth <= 0) {
@@ -152,10 +152,17 @@ public:
     void setTotp(QSharedPointer<Totp::Settings> settings);
 
     QList<Entry*> historyItems();
-    const QList<Entry*>& historyItems() const;
+    QList<Entry*> cloneHistoryItems() const;
+    int historyCount() const;
+    template <class Func> bool walkHistoryItems(Func func) const;
+    template <class Func> bool walkHistoryAttachments(Func func) const;
+    template <class Func> bool walkHistoryCustomData(Func func) const;
+    template <class Func> void updateHistoryItems(Func func);
     void addHistoryItem(Entry* entry);
     void removeHistoryItems(const QList<Entry*>& historyEntries);
+    void clearHistory();
     void truncateHistory();
+    void compactHistory();
 
     bool equals(const Entry* other, CompareItemOptions options = CompareItemDefault) const;
 
@@ -253,37 +260,164 @@ signals:
     void entryDataChanged(Entry* entry);
     void entryModified();
 
-private slots:
+private:
     void emitDataChanged();
     void updateTimeinfo();
     void updateModifiedSinceBegin();
     void updateTotp();
-
-private:
     QString resolveMultiplePlaceholdersRecursive(const QString& str, int maxDepth) const;
     QString resolvePlaceholderRecursive(const QString& placeholder, int maxDepth) const;
     QString resolveReferencePlaceholderRecursive(const QString& placeholder, int maxDepth) const;
     QString referenceFieldValue(EntryReferenceType referenceType) const;
 
     static QString buildReference(const QUuid& uuid, const QString& field);
+    static void shareHistoryData(Entry* historyItem, const Entry* newer);
     static EntryReferenceType referenceType(const QString& referenceStr);
 
     template <class T> bool set(T& property, const T& value);
 
+    /**
+     * History item without an Entry object of its own. Components that are
+     * equal in the next newer item are not stored, the newest item has all.
+     */
+    struct HistoryDelta
+    {
+        QUuid uuid;
+        EntryData data;
+        QSharedPointer<EntryAttributes> attributes;
+        QSharedPointer<EntryAttachments> attachments;
+        QSharedPointer<AutoTypeAssociations> autoTypeAssociations;
+        QSharedPointer<CustomData> customData;
+        int size;
+    };
+
+    void emitModified();
+    void attributesModified();
+    static HistoryDelta historyDelta(const Entry* historyItem, const Entry* newer);
+    void appendHistoryDelta(Entry* historyItem);
+    void materializeHistory();
+    QList<Entry*> buildHistoryItems() const;
+    int historyItemSize(int index) const;
+
     QUuid m_uuid;
     EntryData m_data;
     QPointer<EntryAttributes> m_attributes;
     QPointer<EntryAttachments> m_attachments;
     QPointer<AutoTypeAssociations> m_autoTypeAssociations;
     QPointer<CustomData> m_customData;
-    QList<Entry*> m_history; // Items sorted from oldest to newest
+    // Items sorted from oldest to newest, only one of the lists is in use
+    QList<Entry*> m_history;
+    QList<HistoryDelta> m_historyDeltas;
+    bool m_historyMaterialized;
 
     QScopedPointer<Entry> m_tmpHistoryItem;
     bool m_modifiedSinceBegin;
     QPointer<Group> m_group;
     bool m_updateTimeinfo;
+
+    friend class AutoTypeAssociations;
+    friend class CustomData;
+    friend class EntryAttachments;
+    friend class EntryAttributes;
+    friend class TestEntry;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Entry::CloneFlags)
 
+/**
+ * Call func for each history item from oldest to newest. Compact history is
+ * only materialized temporarily, so the items must not be kept.
+ *
+ * @param func Function to call, return true to stop the walk
+ * @return true if the walk was stopped by func
+ */
+template <class Func> bool Entry::walkHistoryItems(Func func) const
+{
+    if (m_historyMaterialized) {
+        for (const Entry* historyItem : m_history) {
+            if (func(historyItem)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const QList<Entry*> historyItems = buildHistoryItems();
+    bool stopped = false;
+    for (const Entry* historyItem : historyItems) {
+        if (func(historyItem)) {
+            stopped = true;
+            break;
+        }
+    }
+    qDeleteAll(historyItems);
+    return stopped;
+}
+
+/**
+ * Call func with the attachments of the history items from oldest to newest
+ * without building the items. Attachments that are equal in the next newer
+ * item may be skipped, every distinct set is visited at least once.
+ *
+ * @param func Function to call with a const EntryAttachments*, return true to stop the walk
+ * @return true if the walk was stopped by func
+ */
+template <class Func> bool Entry::walkHistoryAttachments(Func func) const
+{
+    if (m_historyMaterialized) {
+        for (const Entry* historyItem : m_history) {
+            if (func(static_cast<const EntryAttachments*>(historyItem->m_attachments.data()))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    for (const HistoryDelta& delta : m_historyDeltas) {
+        if (delta.attachments && func(static_cast<const EntryAttachments*>(delta.attachments.data()))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Call func with the custom data of the history items like
+ * walkHistoryAttachments().
+ */
+template <class Func> bool Entry::walkHistoryCustomData(Func func) const
+{
+    if (m_historyMaterialized) {
+        for (const Entry* historyItem : m_history) {
+            if (func(static_cast<const CustomData*>(historyItem->m_customData.data()))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    for (const HistoryDelta& delta : m_historyDeltas) {
+        if (delta.customData && func(static_cast<const CustomData*>(delta.customData.data()))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Call func for each history item from oldest to newest to modify it in
+ * place. Compact history is only materialized for the duration of the call.
+ */
+template <class Func> void Entry::updateHistoryItems(Func func)
+{
+    const bool compact = !m_historyMaterialized;
+    materializeHistory();
+    for (int i = 0; i < m_history.size(); ++i) {
+        func(m_history.at(i));
+    }
+    if (compact) {
+        compactHistory();
+    }
+}
+
 #endif // KEEPASSX_ENTRY_H
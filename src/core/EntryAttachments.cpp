@@ -17,16 +17,47 @@
 
 #include "EntryAttachments.h"
 
+#include "core/Entry.h"
 #include "core/Global.h"
+#include "crypto/CryptoHash.h"
 
 #include <QSet>
 #include <QStringList>
 
+EntryAttachments::Blob::Blob(const QByteArray& data)
+    : m_data(data)
+    , m_digest(CryptoHash::hash(data, CryptoHash::Sha256))
+{
+}
+
+const QByteArray& EntryAttachments::Blob::data() const
+{
+    return m_data;
+}
+
+const QByteArray& EntryAttachments::Blob::digest() const
+{
+    return m_digest;
+}
+
 EntryAttachments::EntryAttachments(QObject* parent)
     : QObject(parent)
 {
 }
 
+/**
+ * Tell the owning entry about the change before emitting the signal. Entries
+ * do not connect to their components, that would allocate connection data
+ * for every component of every entry.
+ */
+void EntryAttachments::notifyModified()
+{
+    if (auto entry = qobject_cast<Entry*>(parent())) {
+        entry->emitModified();
+    }
+    emit entryAttachmentsModified();
+}
+
 QList<QString> EntryAttachments::keys() const
 {
     return m_attachments.keys();
@@ -39,16 +70,52 @@ bool EntryAttachments::hasKey(const QString& key) const
 
 QSet<QByteArray> EntryAttachments::values() const
 {
-    return asConst(m_attachments).values().toSet();
+    QSet<QByteArray> values;
+    for (const auto& blob : m_attachments) {
+        values.insert(blob->data());
+    }
+    return values;
 }
 
 QByteArray EntryAttachments::value(const QString& key) const
+{
+    const auto blob = m_attachments.value(key);
+    return blob ? blob->data() : QByteArray();
+}
+
+/**
+ * SHA-256 digest of an attachment, computed once when the content was added.
+ */
+QByteArray EntryAttachments::digest(const QString& key) const
+{
+    const auto blob = m_attachments.value(key);
+    return blob ? blob->digest() : QByteArray();
+}
+
+QSharedPointer<const EntryAttachments::Blob> EntryAttachments::blob(const QString& key) const
 {
     return m_attachments.value(key);
 }
 
 void EntryAttachments::set(const QString& key, const QByteArray& value)
 {
+    const auto blob = m_attachments.value(key);
+    if (blob && blob->data() == value) {
+        emit keyModified(key);
+        return;
+    }
+
+    set(key, QSharedPointer<const Blob>(new Blob(value)));
+}
+
+/**
+ * Reference already hashed content. Use this to share a blob between
+ * entries instead of adding the same data again.
+ */
+void EntryAttachments::set(const QString& key, const QSharedPointer<const Blob>& blob)
+{
+    Q_ASSERT(blob);
+
     bool emitModified = false;
     bool addAttachment = !m_attachments.contains(key);
 
@@ -56,8 +123,8 @@ void EntryAttachments::set(const QString& key, const QByteArray& value)
         emit aboutToBeAdded(key);
     }
 
-    if (addAttachment || m_attachments.value(key) != value) {
-        m_attachments.insert(key, value);
+    if (addAttachment || m_attachments.value(key)->digest() != blob->digest()) {
+        m_attachments.insert(key, blob);
         emitModified = true;
     }
 
@@ -68,7 +135,7 @@ void EntryAttachments::set(const QString& key, const QByteArray& value)
     }
 
     if (emitModified) {
-        emit entryAttachmentsModified();
+        notifyModified();
     }
 }
 
@@ -84,7 +151,7 @@ void EntryAttachments::remove(const QString& key)
     m_attachments.remove(key);
 
     emit removed(key);
-    emit entryAttachmentsModified();
+    notifyModified();
 }
 
 void EntryAttachments::remove(const QStringList& keys)
@@ -108,7 +175,7 @@ void EntryAttachments::remove(const QStringList& keys)
     }
 
     if (isModified) {
-        emit entryAttachmentsModified();
+        notifyModified();
     }
 }
 
@@ -135,7 +202,7 @@ void EntryAttachments::clear()
     m_attachments.clear();
 
     emit reset();
-    emit entryAttachmentsModified();
+    notifyModified();
 }
 
 void EntryAttachments::copyDataFrom(const EntryAttachments* other)
@@ -146,25 +213,49 @@ void EntryAttachments::copyDataFrom(const EntryAttachments* other)
         m_attachments = other->m_attachments;
 
         emit reset();
-        emit entryAttachmentsModified();
+        notifyModified();
+    }
+}
+
+/**
+ * Reuse the storage of other if it references the same content.
+ * The content does not change, so no signals are emitted.
+ */
+void EntryAttachments::shareDataWith(const EntryAttachments* other)
+{
+    if (*this == *other) {
+        m_attachments = other->m_attachments;
     }
 }
 
 bool EntryAttachments::operator==(const EntryAttachments& other) const
 {
-    return m_attachments == other.m_attachments;
+    if (m_attachments.size() != other.m_attachments.size()) {
+        return false;
+    }
+
+    // Compare digests instead of the attachment contents
+    for (auto it = m_attachments.constBegin(), otherIt = other.m_attachments.constBegin();
+         it != m_attachments.constEnd();
+         ++it, ++otherIt) {
+        if (it.key() != otherIt.key()
+            || (it.value() != otherIt.value() && it.value()->digest() != otherIt.value()->digest())) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool EntryAttachments::operator!=(const EntryAttachments& other) const
 {
-    return m_attachments != other.m_attachments;
+    return !(*this == other);
 }
 
 int EntryAttachments::attachmentsSize() const
 {
     int size = 0;
     for (auto it = m_attachments.constBegin(); it != m_attachments.constEnd(); ++it) {
-        size += it.key().toUtf8().size() + it.value().size();
+        size += it.key().toUtf8().size() + it.value()->data().size();
     }
     return size;
 }
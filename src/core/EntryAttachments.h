@@ -20,6 +20,7 @@
 
 #include <QMap>
 #include <QObject>
+#include <QSharedPointer>
 
 class QStringList;
 
@@ -28,18 +29,39 @@ class EntryAttachments : public QObject
     Q_OBJECT
 
 public:
+    /**
+     * Immutable attachment content, addressed by its SHA-256 digest.
+     * Blobs are shared by all entries, history items and copies that
+     * reference the same content, so the digest is computed only once.
+     */
+    class Blob
+    {
+    public:
+        explicit Blob(const QByteArray& data);
+        const QByteArray& data() const;
+        const QByteArray& digest() const;
+
+    private:
+        const QByteArray m_data;
+        const QByteArray m_digest;
+    };
+
     explicit EntryAttachments(QObject* parent = nullptr);
     QList<QString> keys() const;
     bool hasKey(const QString& key) const;
     QSet<QByteArray> values() const;
     QByteArray value(const QString& key) const;
+    QByteArray digest(const QString& key) const;
+    QSharedPointer<const Blob> blob(const QString& key) const;
     void set(const QString& key, const QByteArray& value);
+    void set(const QString& key, const QSharedPointer<const Blob>& blob);
     void remove(const QString& key);
     void remove(const QStringList& keys);
     void rename(const QString& key, const QString& newKey);
     bool isEmpty() const;
     void clear();
     void copyDataFrom(const EntryAttachments* other);
+    void shareDataWith(const EntryAttachments* other);
     bool operator==(const EntryAttachments& other) const;
     bool operator!=(const EntryAttachments& other) const;
     int attachmentsSize() const;
@@ -55,7 +77,9 @@ signals:
     void reset();
 
 private:
-    QMap<QString, QByteArray> m_attachments;
+    void notifyModified();
+
+    QMap<QString, QSharedPointer<const Blob>> m_attachments;
 };
 
 #endif // KEEPASSX_ENTRYATTACHMENTS_H
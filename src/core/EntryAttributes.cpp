@@ -18,7 +18,11 @@
 
 #include "EntryAttributes.h"
 
+#include "core/Entry.h"
 #include "core/Global.h"
+#include "crypto/SessionCipher.h"
+
+#include <algorithm>
 
 const QString EntryAttributes::TitleKey = "Title";
 const QString EntryAttributes::UserNameKey = "UserName";
@@ -37,68 +41,143 @@ const QString EntryAttributes::RememberCmdExecAttr = "_EXEC_CMD";
 EntryAttributes::EntryAttributes(QObject* parent)
     : QObject(parent)
 {
-    clear();
+    // Not clear(), the owning entry may still be under construction
+    for (int i = 0; i < DefaultAttributeCount; ++i) {
+        m_defaults[i].key = DefaultAttributes.at(i);
+        m_defaults[i].value = QString("");
+        m_defaults[i].isProtected = false;
+    }
+}
+
+/**
+ * Tell the owning entry about the change before emitting the signal, see
+ * EntryAttachments::notifyModified().
+ */
+void EntryAttributes::notifyModified()
+{
+    if (auto entry = qobject_cast<Entry*>(parent())) {
+        entry->attributesModified();
+    }
+    emit entryAttributesModified();
+}
+
+void EntryAttributes::notifyDefaultKeyModified()
+{
+    if (auto entry = qobject_cast<Entry*>(parent())) {
+        entry->emitDataChanged();
+    }
+    emit defaultKeyModified();
 }
 
 QList<QString> EntryAttributes::keys() const
 {
-    return m_attributes.keys();
+    // Default attributes in sorted order, merged with the sorted custom keys
+    static const QStringList sortedDefaults = [] {
+        QStringList keys = DefaultAttributes;
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }();
+
+    QList<QString> keyList;
+    keyList.reserve(DefaultAttributeCount + m_custom.size());
+    auto custom = m_custom.constBegin();
+    for (const QString& defaultKey : sortedDefaults) {
+        while (custom != m_custom.constEnd() && custom->key < defaultKey) {
+            keyList.append(custom->key);
+            ++custom;
+        }
+        keyList.append(defaultKey);
+    }
+    for (; custom != m_custom.constEnd(); ++custom) {
+        keyList.append(custom->key);
+    }
+    return keyList;
 }
 
 bool EntryAttributes::hasKey(const QString& key) const
 {
-    return m_attributes.contains(key);
+    return find(key) != nullptr;
 }
 
 QList<QString> EntryAttributes::customKeys() const
 {
     QList<QString> customKeys;
-    const QList<QString> keyList = keys();
-    for (const QString& key : keyList) {
-        if (!isDefaultAttribute(key)) {
-            customKeys.append(key);
-        }
+    customKeys.reserve(m_custom.size());
+    for (const Attribute& attribute : m_custom) {
+        customKeys.append(attribute.key);
     }
     return customKeys;
 }
 
 QString EntryAttributes::value(const QString& key) const
 {
-    return m_attributes.value(key);
+    const Attribute* attribute = find(key);
+    return attribute ? attributeValue(*attribute) : QString();
 }
 
 QList<QString> EntryAttributes::values(const QList<QString>& keys) const
 {
     QList<QString> values;
     for (const QString& key : keys) {
-        values.append(m_attributes.value(key));
+        values.append(value(key));
     }
     return values;
 }
 
 bool EntryAttributes::contains(const QString& key) const
 {
-    return m_attributes.contains(key);
+    return find(key) != nullptr;
 }
 
 bool EntryAttributes::containsValue(const QString& value) const
 {
-    return asConst(m_attributes).values().contains(value);
+    bool hasSealed = false;
+    for (const Attribute& attribute : m_defaults) {
+        hasSealed |= !attribute.sealed.isEmpty();
+        if (attribute.sealed.isEmpty() && attribute.value == value) {
+            return true;
+        }
+    }
+    for (const Attribute& attribute : m_custom) {
+        hasSealed |= !attribute.sealed.isEmpty();
+        if (attribute.sealed.isEmpty() && attribute.value == value) {
+            return true;
+        }
+    }
+
+    // Sealing is deterministic, compare without decrypting
+    QByteArray sealed;
+    if (!hasSealed || !SessionCipher::seal(value, sealed)) {
+        return false;
+    }
+    for (const Attribute& attribute : m_defaults) {
+        if (attribute.sealed == sealed) {
+            return true;
+        }
+    }
+    for (const Attribute& attribute : m_custom) {
+        if (attribute.sealed == sealed) {
+            return true;
+        }
+    }
+    return false;
 }
 
 bool EntryAttributes::isProtected(const QString& key) const
 {
-    return m_protectedAttributes.contains(key);
+    const Attribute* attribute = find(key);
+    return attribute && attribute->isProtected;
 }
 
 bool EntryAttributes::isReference(const QString& key) const
 {
-    if (!m_attributes.contains(key)) {
+    const Attribute* attribute = find(key);
+    if (!attribute) {
         Q_ASSERT(false);
         return false;
     }
 
-    const QString data = value(key);
+    const QString data = attributeValue(*attribute);
     return matchReference(data).hasMatch();
 }
 
@@ -106,8 +185,10 @@ void EntryAttributes::set(const QString& key, const QString& value, bool protect
 {
     bool emitModified = false;
 
-    bool addAttribute = !m_attributes.contains(key);
-    bool changeValue = !addAttribute && (m_attributes.value(key) != value);
+    Attribute* attribute = find(key);
+    bool addAttribute = !attribute;
+    bool changeValue = !addAttribute && (attributeValue(*attribute) != value);
+    bool changeProtection = !addAttribute && (attribute->isProtected != protect);
     bool defaultAttribute = isDefaultAttribute(key);
 
     if (addAttribute && !defaultAttribute) {
@@ -115,25 +196,28 @@ void EntryAttributes::set(const QString& key, const QString& value, bool protect
     }
 
     if (addAttribute || changeValue) {
-        m_attributes.insert(key, value);
         emitModified = true;
     }
 
-    if (protect) {
-        if (!m_protectedAttributes.contains(key)) {
-            emitModified = true;
-        }
-        m_protectedAttributes.insert(key);
-    } else if (m_protectedAttributes.remove(key)) {
+    if (addAttribute) {
+        attribute = &insertCustom(key);
+    }
+
+    if (addAttribute || changeValue || changeProtection) {
+        storeValue(*attribute, value, protect);
+    }
+
+    if (attribute->isProtected != protect) {
+        attribute->isProtected = protect;
         emitModified = true;
     }
 
     if (emitModified) {
-        emit entryAttributesModified();
+        notifyModified();
     }
 
     if (defaultAttribute && changeValue) {
-        emit defaultKeyModified();
+        notifyDefaultKeyModified();
     } else if (addAttribute) {
         emit added(key);
     } else if (emitModified) {
@@ -145,17 +229,17 @@ void EntryAttributes::remove(const QString& key)
 {
     Q_ASSERT(!isDefaultAttribute(key));
 
-    if (!m_attributes.contains(key)) {
+    const int index = customIndex(key);
+    if (index < 0) {
         return;
     }
 
     emit aboutToBeRemoved(key);
 
-    m_attributes.remove(key);
-    m_protectedAttributes.remove(key);
+    m_custom.remove(index);
 
     emit removed(key);
-    emit entryAttributesModified();
+    notifyModified();
 }
 
 void EntryAttributes::rename(const QString& oldKey, const QString& newKey)
@@ -163,29 +247,28 @@ void EntryAttributes::rename(const QString& oldKey, const QString& newKey)
     Q_ASSERT(!isDefaultAttribute(oldKey));
     Q_ASSERT(!isDefaultAttribute(newKey));
 
-    if (!m_attributes.contains(oldKey)) {
+    const int oldIndex = customIndex(oldKey);
+    if (oldIndex < 0) {
         Q_ASSERT(false);
         return;
     }
 
-    if (m_attributes.contains(newKey)) {
+    if (find(newKey)) {
         Q_ASSERT(false);
         return;
     }
 
-    QString data = value(oldKey);
-    bool protect = isProtected(oldKey);
+    QString data = attributeValue(m_custom.at(oldIndex));
+    bool protect = m_custom.at(oldIndex).isProtected;
 
     emit aboutToRename(oldKey, newKey);
 
-    m_attributes.remove(oldKey);
-    m_attributes.insert(newKey, data);
-    if (protect) {
-        m_protectedAttributes.remove(oldKey);
-        m_protectedAttributes.insert(newKey);
-    }
+    m_custom.remove(oldIndex);
+    Attribute& attribute = insertCustom(newKey);
+    storeValue(attribute, data, protect);
+    attribute.isProtected = protect;
 
-    emit entryAttributesModified();
+    notifyModified();
     emit renamed(oldKey, newKey);
 }
 
@@ -197,43 +280,23 @@ void EntryAttributes::copyCustomKeysFrom(const EntryAttributes* other)
 
     emit aboutToBeReset();
 
-    // remove all non-default keys
-    const QList<QString> keyList = keys();
-    for (const QString& key : keyList) {
-        if (!isDefaultAttribute(key)) {
-            m_attributes.remove(key);
-            m_protectedAttributes.remove(key);
-        }
-    }
-
-    const QList<QString> otherKeyList = other->keys();
-    for (const QString& key : otherKeyList) {
-        if (!isDefaultAttribute(key)) {
-            m_attributes.insert(key, other->value(key));
-            if (other->isProtected(key)) {
-                m_protectedAttributes.insert(key);
-            }
-        }
-    }
+    m_custom = other->m_custom;
 
     emit reset();
-    emit entryAttributesModified();
+    notifyModified();
 }
 
 bool EntryAttributes::areCustomKeysDifferent(const EntryAttributes* other)
 {
-    // check if they are equal ignoring the order of the keys
-    if (keys().toSet() != other->keys().toSet()) {
+    // Custom keys are sorted, so equal key sets line up
+    if (m_custom.size() != other->m_custom.size()) {
         return true;
     }
 
-    const QList<QString> keyList = keys();
-    for (const QString& key : keyList) {
-        if (isDefaultAttribute(key)) {
-            continue;
-        }
-
-        if (isProtected(key) != other->isProtected(key) || value(key) != other->value(key)) {
+    for (int i = 0; i < m_custom.size(); ++i) {
+        const Attribute& attribute = m_custom.at(i);
+        const Attribute& otherAttribute = other->m_custom.at(i);
+        if (attribute.key != otherAttribute.key || !isSameAttribute(attribute, otherAttribute)) {
             return true;
         }
     }
@@ -246,22 +309,46 @@ void EntryAttributes::copyDataFrom(const EntryAttributes* other)
     if (*this != *other) {
         emit aboutToBeReset();
 
-        m_attributes = other->m_attributes;
-        m_protectedAttributes = other->m_protectedAttributes;
+        std::copy(other->m_defaults, other->m_defaults + DefaultAttributeCount, m_defaults);
+        m_custom = other->m_custom;
 
         emit reset();
-        emit entryAttributesModified();
+        notifyModified();
+    }
+}
+
+/**
+ * Reuse the storage of all values that are equal in other.
+ * The content does not change, so no signals are emitted.
+ */
+void EntryAttributes::shareDataWith(const EntryAttributes* other)
+{
+    for (int i = 0; i < DefaultAttributeCount; ++i) {
+        shareAttribute(m_defaults[i], other->m_defaults[i]);
+    }
+
+    if (m_custom == other->m_custom) {
+        m_custom = other->m_custom;
+        return;
+    }
+
+    for (Attribute& attribute : m_custom) {
+        const int index = other->customIndex(attribute.key);
+        if (index >= 0) {
+            shareAttribute(attribute, other->m_custom.at(index));
+        }
     }
 }
 
 QUuid EntryAttributes::referenceUuid(const QString& key) const
 {
-    if (!m_attributes.contains(key)) {
+    const Attribute* attribute = find(key);
+    if (!attribute) {
         Q_ASSERT(false);
         return {};
     }
 
-    auto match = matchReference(value(key));
+    auto match = matchReference(attributeValue(*attribute));
     if (match.hasMatch()) {
         const QString uuid = match.captured("SearchText");
         if (!uuid.isEmpty()) {
@@ -274,12 +361,169 @@ QUuid EntryAttributes::referenceUuid(const QString& key) const
 
 bool EntryAttributes::operator==(const EntryAttributes& other) const
 {
-    return (m_attributes == other.m_attributes && m_protectedAttributes == other.m_protectedAttributes);
+    for (int i = 0; i < DefaultAttributeCount; ++i) {
+        if (!isSameAttribute(m_defaults[i], other.m_defaults[i])) {
+            return false;
+        }
+    }
+
+    if (m_custom.size() != other.m_custom.size()) {
+        return false;
+    }
+    for (int i = 0; i < m_custom.size(); ++i) {
+        if (m_custom.at(i).key != other.m_custom.at(i).key || !isSameAttribute(m_custom.at(i), other.m_custom.at(i))) {
+            return false;
+        }
+    }
+    return true;
 }
 
 bool EntryAttributes::operator!=(const EntryAttributes& other) const
 {
-    return (m_attributes != other.m_attributes || m_protectedAttributes != other.m_protectedAttributes);
+    return !(*this == other);
+}
+
+bool EntryAttributes::Attribute::operator==(const Attribute& other) const
+{
+    return key == other.key && value == other.value && sealed == other.sealed && isProtected == other.isProtected;
+}
+
+/**
+ * Slot of a default attribute, -1 for custom keys.
+ * Checks the key length first, this is a lot cheaper than a map lookup.
+ */
+int EntryAttributes::defaultIndex(const QString& key)
+{
+    switch (key.size()) {
+    case 3:
+        return key == URLKey ? 3 : -1;
+    case 5:
+        return key == TitleKey ? 0 : (key == NotesKey ? 4 : -1);
+    case 8:
+        return key == UserNameKey ? 1 : (key == PasswordKey ? 2 : -1);
+    default:
+        return -1;
+    }
+}
+
+QString EntryAttributes::attributeValue(const Attribute& attribute)
+{
+    if (!attribute.sealed.isEmpty()) {
+        return SessionCipher::unseal(attribute.sealed);
+    }
+    return attribute.value;
+}
+
+bool EntryAttributes::isSameAttribute(const Attribute& attribute, const Attribute& other)
+{
+    if (attribute.isProtected != other.isProtected) {
+        return false;
+    }
+
+    const bool sealed = !attribute.sealed.isEmpty();
+    if (sealed != !other.sealed.isEmpty()) {
+        // Sealed on one side only, e.g. after the setting was changed
+        return attributeValue(attribute) == attributeValue(other);
+    }
+    if (sealed) {
+        return attribute.sealed == other.sealed;
+    }
+    return attribute.value == other.value;
+}
+
+void EntryAttributes::shareAttribute(Attribute& attribute, const Attribute& other)
+{
+    if (attribute.key == other.key) {
+        attribute.key = other.key;
+    }
+    if (attribute.value == other.value) {
+        attribute.value = other.value;
+    }
+    if (attribute.sealed == other.sealed) {
+        attribute.sealed = other.sealed;
+    }
+}
+
+/**
+ * Store a value, sealed if it is protected and sealing is enabled.
+ */
+void EntryAttributes::storeValue(Attribute& attribute, const QString& value, bool protect)
+{
+    QByteArray sealed;
+    if (protect && SessionCipher::isEnabled() && SessionCipher::seal(value, sealed)) {
+        attribute.value = QString();
+        attribute.sealed = sealed;
+    } else {
+        attribute.value = value;
+        attribute.sealed.clear();
+    }
+}
+
+/**
+ * The value as it is held in memory: sealed bytes for a sealed value,
+ * the UTF-8 encoded plaintext otherwise.
+ */
+QByteArray EntryAttributes::storedValue(const QString& key) const
+{
+    const Attribute* attribute = find(key);
+    if (!attribute) {
+        return QByteArray();
+    }
+    return attribute->sealed.isEmpty() ? attribute->value.toUtf8() : attribute->sealed;
+}
+
+const EntryAttributes::Attribute* EntryAttributes::find(const QString& key) const
+{
+    const int index = defaultIndex(key);
+    if (index >= 0) {
+        return &m_defaults[index];
+    }
+
+    const int customPos = customIndex(key);
+    return customPos >= 0 ? &m_custom.at(customPos) : nullptr;
+}
+
+EntryAttributes::Attribute* EntryAttributes::find(const QString& key)
+{
+    const int index = defaultIndex(key);
+    if (index >= 0) {
+        return &m_defaults[index];
+    }
+
+    // Non-const access detaches storage shared with other entries
+    const int customPos = customIndex(key);
+    return customPos >= 0 ? &m_custom[customPos] : nullptr;
+}
+
+int EntryAttributes::customLowerBound(const QString& key) const
+{
+    const auto it = std::lower_bound(m_custom.constBegin(),
+                                     m_custom.constEnd(),
+                                     key,
+                                     [](const Attribute& attribute, const QString& k) { return attribute.key < k; });
+    return static_cast<int>(it - m_custom.constBegin());
+}
+
+int EntryAttributes::customIndex(const QString& key) const
+{
+    const int index = customLowerBound(key);
+    if (index < m_custom.size() && m_custom.at(index).key == key) {
+        return index;
+    }
+    return -1;
+}
+
+EntryAttributes::Attribute& EntryAttributes::insertCustom(const QString& key)
+{
+    Q_ASSERT(customIndex(key) < 0 && !isDefaultAttribute(key));
+
+    Attribute attribute;
+    attribute.key = key;
+    attribute.isProtected = false;
+
+    const int index = customLowerBound(key);
+    m_custom.insert(index, attribute);
+    return m_custom[index];
 }
 
 QRegularExpressionMatch EntryAttributes::matchReference(const QString& text)
@@ -295,27 +539,39 @@ void EntryAttributes::clear()
 {
     emit aboutToBeReset();
 
-    m_attributes.clear();
-    m_protectedAttributes.clear();
-
-    for (const QString& key : DefaultAttributes) {
-        m_attributes.insert(key, "");
+    for (int i = 0; i < DefaultAttributeCount; ++i) {
+        m_defaults[i].key = DefaultAttributes.at(i);
+        m_defaults[i].value = QString("");
+        m_defaults[i].sealed.clear();
+        m_defaults[i].isProtected = false;
     }
+    m_custom.clear();
 
     emit reset();
-    emit entryAttributesModified();
+    notifyModified();
 }
 
 int EntryAttributes::attributesSize() const
 {
-    int size = 0;
-    for (auto it = m_attributes.constBegin(); it != m_attributes.constEnd(); ++it) {
-        size += it.key().toUtf8().size() + it.value().toUtf8().size();
+    auto size = [](const Attribute& attribute) -> int {
+        const int keySize = attribute.key.toUtf8().size();
+        if (!attribute.sealed.isEmpty()) {
+            return keySize + SessionCipher::plaintextSize(attribute.sealed);
+        }
+        return keySize + attribute.value.toUtf8().size();
+    };
+
+    int total = 0;
+    for (const Attribute& attribute : m_defaults) {
+        total += size(attribute);
+    }
+    for (const Attribute& attribute : m_custom) {
+        total += size(attribute);
     }
-    return size;
+    return total;
 }
 
 bool EntryAttributes::isDefaultAttribute(const QString& key)
 {
-    return DefaultAttributes.contains(key);
+    return defaultIndex(key) >= 0;
 }
@@ -19,12 +19,11 @@
 #ifndef KEEPASSX_ENTRYATTRIBUTES_H
 #define KEEPASSX_ENTRYATTRIBUTES_H
 
-#include <QMap>
 #include <QObject>
 #include <QRegularExpression>
-#include <QSet>
 #include <QStringList>
 #include <QUuid>
+#include <QVector>
 
 class EntryAttributes : public QObject
 {
@@ -49,6 +48,7 @@ public:
     void clear();
     int attributesSize() const;
     void copyDataFrom(const EntryAttributes* other);
+    void shareDataWith(const EntryAttributes* other);
     QUuid referenceUuid(const QString& key) const;
     bool operator==(const EntryAttributes& other) const;
     bool operator!=(const EntryAttributes& other) const;
@@ -82,8 +82,41 @@ signals:
     void reset();
 
 private:
-    QMap<QString, QString> m_attributes;
-    QSet<QString> m_protectedAttributes;
+    friend class TestEntry;
+
+    struct Attribute
+    {
+        QString key;
+        QString value;
+        // Protected value kept encrypted by SessionCipher, value is empty then
+        QByteArray sealed;
+        bool isProtected;
+
+        bool operator==(const Attribute& other) const;
+    };
+
+    static const int DefaultAttributeCount = 5;
+
+    static int defaultIndex(const QString& key);
+    static QString attributeValue(const Attribute& attribute);
+    static bool isSameAttribute(const Attribute& attribute, const Attribute& other);
+    static void shareAttribute(Attribute& attribute, const Attribute& other);
+    static void storeValue(Attribute& attribute, const QString& value, bool protect);
+
+    void notifyModified();
+    void notifyDefaultKeyModified();
+
+    QByteArray storedValue(const QString& key) const;
+    const Attribute* find(const QString& key) const;
+    Attribute* find(const QString& key);
+    int customLowerBound(const QString& key) const;
+    int customIndex(const QString& key) const;
+    Attribute& insertCustom(const QString& key);
+
+    // Fixed slots for the default attributes in the order of DefaultAttributes,
+    // custom attributes sorted by key
+    Attribute m_defaults[DefaultAttributeCount];
+    QVector<Attribute> m_custom;
 };
 
 #endif // KEEPASSX_ENTRYATTRIBUTES_H
@@ -20,6 +20,7 @@
 
 #include "core/Group.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 
 EntrySearcher::EntrySearcher(bool caseSensitive, bool skipProtected)
     : m_caseSensitive(caseSensitive)
@@ -38,6 +39,7 @@ EntrySearcher::EntrySearcher(bool caseSensitive, bool skipProtected)
  */
 QList<Entry*> EntrySearcher::search(const QList<SearchTerm>& searchTerms, const Group* baseGroup, bool forceSearch)
 {
+    TRACE_SCOPE("EntrySearcher::search");
     Q_ASSERT(baseGroup);
     m_searchTerms = searchTerms;
     return repeat(baseGroup, forceSearch);
@@ -71,7 +73,7 @@ QList<Entry*> EntrySearcher::repeat(const Group* baseGroup, bool forceSearch)
     Q_ASSERT(baseGroup);
 
     QList<Entry*> results;
-    for (const auto group : baseGroup->groupsRecursive(true)) {
+    baseGroup->walkGroups([this, &results, forceSearch](const Group* group) -> bool {
         if (forceSearch || group->resolveSearchingEnabled()) {
             for (const auto entry : group->entries()) {
                 if (searchEntryImpl(entry)) {
@@ -79,7 +81,8 @@ QList<Entry*> EntrySearcher::repeat(const Group* baseGroup, bool forceSearch)
                 }
             }
         }
-    }
+        return false;
+    });
     return results;
 }
 
@@ -148,8 +151,6 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
     auto attributes_keys = entry->attributes()->customKeys();
     auto attributes = QStringList(attributes_keys + entry->attributes()->values(attributes_keys));
     auto attachments = QStringList(entry->attachments()->keys());
-    // Build a group hierarchy to allow searching for e.g. /group1/subgroup*
-    auto hierarchy = entry->group()->hierarchy().join('/').prepend("/");
 
     // By default, empty term matches every entry.
     // However when skipping protected fields, we will recject everything instead
@@ -189,8 +190,9 @@ bool EntrySearcher::searchEntryImpl(const Entry* entry)
             break;
         case Field::Group:
             // Match against the full hierarchy if the word contains a '/' otherwise just the group name
+            // e.g. /group1/subgroup*
             if (term.word.contains('/')) {
-                found = term.regex.match(hierarchy).hasMatch();
+                found = term.regex.match(QString("/") + entry->group()->fullPath()).hasMatch();
             } else {
                 found = term.regex.match(entry->group()->name()).hasMatch();
             }
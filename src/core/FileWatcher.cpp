@@ -18,17 +18,30 @@
 #include "FileWatcher.h"
 
 #include "core/AsyncTask.h"
+#include "core/Clock.h"
 
 #include <QCryptographicHash>
+#include <QDataStream>
+#include <QFileInfo>
 
 #ifdef Q_OS_LINUX
 #include <sys/vfs.h>
 #endif
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    // Files modified this recently can change again without a visible timestamp change
+    constexpr qint64 RacyStampSeconds = 2;
+} // namespace
 
 FileWatcher::FileWatcher(QObject* parent)
     : QObject(parent)
 {
     connect(&m_fileWatcher, SIGNAL(fileChanged(QString)), SLOT(checkFileChanged()));
+    connect(&m_fileWatcher, SIGNAL(directoryChanged(QString)), SLOT(checkFileChanged()));
     connect(&m_fileChecksumTimer, SIGNAL(timeout()), SLOT(checkFileChanged()));
     connect(&m_fileChangeDelayTimer, &QTimer::timeout, this, [this] { emit fileChanged(m_filePath); });
     m_fileChangeDelayTimer.setSingleShot(true);
@@ -57,13 +70,22 @@ void FileWatcher::start(const QString& filePath, int checksumIntervalSeconds, in
     }
     auto objectName = forcePolling ? QLatin1String("_qt_autotest_force_engine_poller") : QLatin1String("");
     m_fileWatcher.setObjectName(objectName);
+#else
+    bool forcePolling = false;
 #endif
 
     m_fileWatcher.addPath(filePath);
     m_filePath = filePath;
 
+    // Watching the directory as well catches files replaced by an atomic rename,
+    // which drops the watch on the file itself. Polled directories are too costly.
+    if (!forcePolling) {
+        m_fileWatcher.addPath(QFileInfo(filePath).absolutePath());
+    }
+
     // Handle file checksum
     m_fileChecksumSizeBytes = checksumSizeKibibytes * 1024;
+    m_fileStamp = calculateFileStamp();
     m_fileChecksum = calculateChecksum();
     if (checksumIntervalSeconds > 0) {
         m_fileChecksumTimer.start(checksumIntervalSeconds * 1000);
@@ -74,11 +96,15 @@ void FileWatcher::start(const QString& filePath, int checksumIntervalSeconds, in
 
 void FileWatcher::stop()
 {
-    if (!m_filePath.isEmpty()) {
-        m_fileWatcher.removePath(m_filePath);
+    if (!m_fileWatcher.files().isEmpty()) {
+        m_fileWatcher.removePaths(m_fileWatcher.files());
+    }
+    if (!m_fileWatcher.directories().isEmpty()) {
+        m_fileWatcher.removePaths(m_fileWatcher.directories());
     }
     m_filePath.clear();
     m_fileChecksum.clear();
+    m_fileStamp.clear();
     m_fileChecksumTimer.stop();
     m_fileChangeDelayTimer.stop();
 }
@@ -106,6 +132,10 @@ bool FileWatcher::shouldIgnoreChanges()
 
 bool FileWatcher::hasSameFileChecksum()
 {
+    const QByteArray stamp = calculateFileStamp();
+    if (!stamp.isEmpty() && stamp == m_fileStamp) {
+        return true;
+    }
     return calculateChecksum() == m_fileChecksum;
 }
 
@@ -118,12 +148,26 @@ void FileWatcher::checkFileChanged()
     // Prevent reentrance
     m_ignoreFileChange = true;
 
-    auto checksum = AsyncTask::runAndWaitForFuture([this]() -> QByteArray { return calculateChecksum(); });
+    // The file is only read when its metadata changed
+    QByteArray stamp;
+    auto checksum = AsyncTask::runAndWaitForFuture([this, &stamp]() -> QByteArray {
+        stamp = calculateFileStamp();
+        if (!stamp.isEmpty() && stamp == m_fileStamp) {
+            return m_fileChecksum;
+        }
+        return calculateChecksum();
+    });
+    m_fileStamp = stamp;
     if (checksum != m_fileChecksum) {
         m_fileChecksum = checksum;
         m_fileChangeDelayTimer.start(0);
     }
 
+    // Watch the new file after it was replaced
+    if (!m_fileWatcher.files().contains(m_filePath) && QFile::exists(m_filePath)) {
+        m_fileWatcher.addPath(m_filePath);
+    }
+
     m_ignoreFileChange = false;
 }
 
@@ -143,3 +187,49 @@ QByteArray FileWatcher::calculateChecksum()
     // prevents unnecessary merge requests on intermittent network shares
     return m_fileChecksum;
 }
+
+/**
+ * Fingerprint of the file metadata that changes whenever the file is written
+ * or replaced: device, inode, size, modification and status change time.
+ * An empty result means the file has to be hashed, either because it cannot
+ * be read or because it was modified so recently that another write within
+ * the timestamp granularity would go unnoticed.
+ */
+QByteArray FileWatcher::calculateFileStamp() const
+{
+    QByteArray stamp;
+    QDataStream stream(&stamp, QIODevice::WriteOnly);
+    qint64 changedSeconds;
+
+#if defined(Q_OS_UNIX)
+    struct stat fileStat;
+    if (::stat(QFile::encodeName(m_filePath).constData(), &fileStat) != 0) {
+        return {};
+    }
+#if defined(Q_OS_MACOS)
+    const auto& modified = fileStat.st_mtimespec;
+    const auto& changed = fileStat.st_ctimespec;
+#else
+    const auto& modified = fileStat.st_mtim;
+    const auto& changed = fileStat.st_ctim;
+#endif
+    stream << quint64(fileStat.st_dev) << quint64(fileStat.st_ino) << qint64(fileStat.st_size);
+    stream << qint64(modified.tv_sec) << qint64(modified.tv_nsec) << qint64(changed.tv_sec)
+           << qint64(changed.tv_nsec);
+    changedSeconds = qMax<qint64>(modified.tv_sec, changed.tv_sec);
+#else
+    QFileInfo fileInfo(m_filePath);
+    if (!fileInfo.exists()) {
+        return {};
+    }
+    const qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+    const qint64 changed = fileInfo.metadataChangeTime().toMSecsSinceEpoch();
+    stream << fileInfo.size() << modified << changed;
+    changedSeconds = qMax(modified, changed) / 1000;
+#endif
+
+    if (Clock::currentSecondsSinceEpoch() - changedSeconds < RacyStampSeconds) {
+        return {};
+    }
+    return stamp;
+}
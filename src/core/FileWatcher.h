@@ -46,11 +46,15 @@ private slots:
 
 private:
     QByteArray calculateChecksum();
+    QByteArray calculateFileStamp() const;
     bool shouldIgnoreChanges();
 
+    friend class TestDatabase;
+
     QString m_filePath;
     QFileSystemWatcher m_fileWatcher;
     QByteArray m_fileChecksum;
+    QByteArray m_fileStamp;
     QTimer m_fileChangeDelayTimer;
     QTimer m_fileIgnoreDelayTimer;
     QTimer m_fileChecksumTimer;
@@ -30,6 +30,7 @@
 #include "keeshare/KeeShare.h"
 #endif
 
+#include <QThread>
 #include <QtConcurrent>
 
 const int Group::DefaultIconNumber = 48;
@@ -42,7 +43,9 @@ Entry::CloneFlags Group::DefaultEntryCloneFlags =
     static_cast<Entry::CloneFlags>(Entry::CloneNewUuid | Entry::CloneResetTimeInfo);
 
 Group::Group()
-    : m_customData(new CustomData(this))
+    : m_loadingEntries(false)
+    , m_customData(new CustomData(this))
+    , m_index(-1)
     , m_updateTimeinfo(true)
 {
     m_data.iconNumber = DefaultIconNumber;
@@ -60,7 +63,12 @@ Group::~Group()
 {
     setUpdateTimeinfo(false);
     // Destroy entries and children manually so DeletedObjects can be added
-    // to database.
+    // to database. Entries that were not loaded yet are recorded by uuid.
+    if (m_db && m_parent) {
+        for (const QUuid& uuid : asConst(m_pendingEntryUuids)) {
+            m_db->addDeletedObject(uuid);
+        }
+    }
     const QList<Entry*> entries = m_entries;
     for (Entry* entry : entries) {
         delete entry;
@@ -147,20 +155,24 @@ QImage Group::icon() const
 QPixmap Group::iconPixmap(IconSize size) const
 {
     QPixmap icon(size, size);
+    const bool expired = isExpired();
     if (m_data.customIcon.isNull()) {
         icon = databaseIcons()->icon(m_data.iconNumber, size);
+        if (expired) {
+            icon = databaseIcons()->applyBadge(icon, DatabaseIcons::Badges::Expired);
+        }
     } else {
         Q_ASSERT(m_db);
-        if (m_db) {
+        if (m_db && expired) {
+            // Custom icons are cached along with their badge
+            icon = m_db->metadata()->customIconPixmap(m_data.customIcon, size, DatabaseIcons::Badges::Expired);
+        } else if (m_db) {
             icon = m_db->metadata()->customIconPixmap(m_data.customIcon, size);
         }
     }
 
-    if (isExpired()) {
-        icon = databaseIcons()->applyBadge(icon, DatabaseIcons::Badges::Expired);
-    }
 #ifdef WITH_XC_KEESHARE
-    else if (KeeShare::isShared(this)) {
+    if (!expired && KeeShare::isShared(this)) {
         icon = KeeShare::indicatorBadge(this, icon);
     }
 #endif
@@ -244,6 +256,17 @@ Entry* Group::lastTopVisibleEntry() const
     return m_lastTopVisibleEntry;
 }
 
+/**
+ * @return uuid of the last top visible entry, also if it was not loaded yet
+ */
+QUuid Group::lastTopVisibleEntryUuid() const
+{
+    if (m_lastTopVisibleEntry) {
+        return m_lastTopVisibleEntry->uuid();
+    }
+    return m_pendingLastTopVisibleEntry;
+}
+
 bool Group::isRecycled() const
 {
     auto group = this;
@@ -270,7 +293,7 @@ bool Group::isExpired() const
 
 bool Group::isEmpty() const
 {
-    return !hasChildren() && m_entries.isEmpty();
+    return !hasChildren() && m_entries.isEmpty() && !m_entryLoader;
 }
 
 CustomData* Group::customData()
@@ -300,6 +323,8 @@ bool Group::equals(const Group* other, CompareItemOptions options) const
     if (m_children.count() != other->m_children.count()) {
         return false;
     }
+    loadPendingEntries();
+    other->loadPendingEntries();
     if (m_entries.count() != other->m_entries.count()) {
         return false;
     }
@@ -324,6 +349,7 @@ void Group::setUuid(const QUuid& uuid)
 void Group::setName(const QString& name)
 {
     if (set(m_data.name, name)) {
+        updateFullPath();
         emit groupDataChanged(this);
     }
 }
@@ -383,6 +409,7 @@ void Group::setSearchingEnabled(TriState enable)
 
 void Group::setLastTopVisibleEntry(Entry* entry)
 {
+    m_pendingLastTopVisibleEntry = QUuid();
     set(m_lastTopVisibleEntry, entry);
 }
 
@@ -434,7 +461,7 @@ void Group::setParent(Group* parent, int index)
         }
     }
 
-    if (m_parent == parent && parent->children().indexOf(this) == index) {
+    if (m_parent == parent && m_index == index) {
         return;
     }
 
@@ -454,16 +481,27 @@ void Group::setParent(Group* parent, int index)
             connectDatabaseSignalsRecursive(parent->m_db);
         }
         QObject::setParent(parent);
+        updateFullPath();
         emit groupAboutToAdd(this, index);
         Q_ASSERT(index <= parent->m_children.size());
         parent->m_children.insert(index, this);
+        parent->updateChildIndexes(index);
     } else {
         emit aboutToMove(this, parent, index);
-        m_parent->m_children.removeAll(this);
+        Group* oldParent = m_parent;
+        const int oldIndex = m_index;
+        oldParent->m_children.removeAt(oldIndex);
         m_parent = parent;
         QObject::setParent(parent);
+        updateFullPath();
         Q_ASSERT(index <= parent->m_children.size());
         parent->m_children.insert(index, this);
+        if (oldParent == parent) {
+            parent->updateChildIndexes(qMin(oldIndex, index));
+        } else {
+            oldParent->updateChildIndexes(oldIndex);
+            parent->updateChildIndexes(index);
+        }
     }
 
     if (m_updateTimeinfo) {
@@ -487,6 +525,7 @@ void Group::setParent(Database* db)
     cleanupParent();
 
     m_parent = nullptr;
+    updateFullPath();
     connectDatabaseSignalsRecursive(db);
 
     QObject::setParent(db);
@@ -518,6 +557,26 @@ QStringList Group::hierarchy(int height) const
     return hierarchy;
 }
 
+/**
+ * Names of all groups from the root group down to this group joined by '/',
+ * the same as hierarchy().join('/'). The path is kept up to date on rename
+ * and move, so this does not allocate.
+ */
+QString Group::fullPath() const
+{
+    return m_fullPath;
+}
+
+/**
+ * Position of this group in the children of its parent, -1 for groups without
+ * a parent. The same as parentGroup()->children().indexOf(this) without the scan.
+ */
+int Group::indexInParent() const
+{
+    Q_ASSERT(!m_parent || m_parent->m_children.value(m_index) == this);
+    return m_index;
+}
+
 bool Group::hasChildren() const
 {
     return !children().isEmpty();
@@ -545,30 +604,24 @@ const QList<Group*>& Group::children() const
 
 QList<Entry*> Group::entries()
 {
+    loadPendingEntries();
     return m_entries;
 }
 
 const QList<Entry*>& Group::entries() const
 {
+    loadPendingEntries();
     return m_entries;
 }
 
-QList<Entry*> Group::entriesRecursive(bool includeHistoryItems) const
+QList<Entry*> Group::entriesRecursive() const
 {
     QList<Entry*> entryList;
-
-    entryList.append(m_entries);
-
-    if (includeHistoryItems) {
-        for (Entry* entry : m_entries) {
-            entryList.append(entry->historyItems());
-        }
-    }
-
-    for (Group* group : m_children) {
-        entryList.append(group->entriesRecursive(includeHistoryItems));
-    }
-
+    walkGroups([&entryList](const Group* group) -> bool {
+        group->loadPendingEntries();
+        entryList.append(group->m_entries);
+        return false;
+    });
     return entryList;
 }
 
@@ -585,18 +638,27 @@ Entry* Group::findEntryByUuid(const QUuid& uuid, bool recursive) const
         return nullptr;
     }
 
-    auto entries = m_entries;
-    if (recursive) {
-        entries = entriesRecursive(false);
-    }
-
-    for (auto entry : entries) {
+    Entry* result = nullptr;
+    auto matches = [&uuid, &result](Entry* entry) -> bool {
         if (entry->uuid() == uuid) {
-            return entry;
+            result = entry;
+            return true;
+        }
+        return false;
+    };
+
+    if (recursive) {
+        walkEntries(matches);
+    } else {
+        loadPendingEntries();
+        for (Entry* entry : m_entries) {
+            if (matches(entry)) {
+                break;
+            }
         }
     }
 
-    return nullptr;
+    return result;
 }
 
 Entry* Group::findEntryByPath(const QString& entryPath)
@@ -665,13 +727,13 @@ Entry* Group::findEntryByPathRecursive(const QString& entryPath, const QString&
 {
     // Return the first entry that matches the full path OR if there is no leading
     // slash, return the first entry title that matches
+    const bool isBelowBasePath = entryPath.startsWith(basePath);
     for (Entry* entry : entries()) {
-        // clang-format off
-        if (entryPath == (basePath + entry->title())
+        // compare against basePath + title without building the string
+        if ((isBelowBasePath && entryPath.midRef(basePath.size()) == entry->title())
             || (!entryPath.startsWith("/") && entry->title() == entryPath)) {
             return entry;
         }
-        // clang-format on
     }
 
     for (Group* group : children()) {
@@ -759,28 +821,28 @@ QString Group::print(bool recursive, bool flatten, int depth)
 QList<const Group*> Group::groupsRecursive(bool includeSelf) const
 {
     QList<const Group*> groupList;
-    if (includeSelf) {
-        groupList.append(this);
-    }
+    walkGroups([&groupList](const Group* group) -> bool {
+        groupList.append(group);
+        return false;
+    });
 
-    for (const Group* group : asConst(m_children)) {
-        groupList.append(group->groupsRecursive(true));
+    if (!includeSelf) {
+        groupList.removeFirst();
     }
-
     return groupList;
 }
 
 QList<Group*> Group::groupsRecursive(bool includeSelf)
 {
     QList<Group*> groupList;
-    if (includeSelf) {
-        groupList.append(this);
-    }
+    walkGroups([&groupList](Group* group) -> bool {
+        groupList.append(group);
+        return false;
+    });
 
-    for (Group* group : asConst(m_children)) {
-        groupList.append(group->groupsRecursive(true));
+    if (!includeSelf) {
+        groupList.removeFirst();
     }
-
     return groupList;
 }
 
@@ -788,20 +850,24 @@ QSet<QUuid> Group::customIconsRecursive() const
 {
     QSet<QUuid> result;
 
-    if (!iconUuid().isNull()) {
-        result.insert(iconUuid());
-    }
+    walkGroups([&result](const Group* group) -> bool {
+        if (!group->iconUuid().isNull()) {
+            result.insert(group->iconUuid());
+        }
+        return false;
+    });
 
-    const QList<Entry*> entryList = entriesRecursive(true);
-    for (Entry* entry : entryList) {
+    auto addIcon = [&result](const Entry* entry) -> bool {
         if (!entry->iconUuid().isNull()) {
             result.insert(entry->iconUuid());
         }
-    }
-
-    for (Group* group : m_children) {
-        result.unite(group->customIconsRecursive());
-    }
+        return false;
+    };
+    walkEntries([&addIcon](const Entry* entry) -> bool {
+        addIcon(entry);
+        entry->walkHistoryItems(addIcon);
+        return false;
+    });
 
     return result;
 }
@@ -810,12 +876,13 @@ QList<QString> Group::usernamesRecursive(int topN) const
 {
     // Collect all usernames and sort for easy counting
     QHash<QString, int> countedUsernames;
-    for (const auto* entry : entriesRecursive()) {
+    walkEntries([&countedUsernames](const Entry* entry) -> bool {
         const auto username = entry->username();
         if (!username.isEmpty() && !entry->isAttributeReference(EntryAttributes::UserNameKey)) {
             countedUsernames.insert(username, ++countedUsernames[username]);
         }
-    }
+        return false;
+    });
 
     // Sort username/frequency pairs by frequency and name
     QList<QPair<QString, int>> sortedUsernames;
@@ -848,13 +915,16 @@ Group* Group::findGroupByUuid(const QUuid& uuid)
         return nullptr;
     }
 
-    for (Group* group : groupsRecursive(true)) {
+    Group* result = nullptr;
+    walkGroups([&uuid, &result](Group* group) -> bool {
         if (group->uuid() == uuid) {
-            return group;
+            result = group;
+            return true;
         }
-    }
+        return false;
+    });
 
-    return nullptr;
+    return result;
 }
 
 Group* Group::findChildByName(const QString& name)
@@ -886,6 +956,7 @@ Group* Group::clone(Entry::CloneFlags entryFlags, Group::CloneFlags groupFlags)
     }
 
     clonedGroup->m_data = m_data;
+    clonedGroup->updateFullPath();
     clonedGroup->m_customData->copyDataFrom(m_customData);
 
     if (groupFlags & Group::CloneIncludeEntries) {
@@ -918,10 +989,12 @@ Group* Group::clone(Entry::CloneFlags entryFlags, Group::CloneFlags groupFlags)
 void Group::copyDataFrom(const Group* other)
 {
     if (set(m_data, other->m_data)) {
+        updateFullPath();
         emit groupDataChanged(this);
     }
     m_customData->copyDataFrom(other->m_customData);
     m_lastTopVisibleEntry = other->m_lastTopVisibleEntry;
+    m_pendingLastTopVisibleEntry = other->m_pendingLastTopVisibleEntry;
 }
 
 void Group::addEntry(Entry* entry)
@@ -929,6 +1002,9 @@ void Group::addEntry(Entry* entry)
     Q_ASSERT(entry);
     Q_ASSERT(!m_entries.contains(entry));
 
+    // New entries go after the ones that were read from the file
+    loadPendingEntries();
+
     emit entryAboutToAdd(entry);
 
     m_entries << entry;
@@ -937,7 +1013,9 @@ void Group::addEntry(Entry* entry)
         connect(entry, SIGNAL(entryModified()), m_db, SLOT(markAsModified()));
     }
 
-    emit groupModified();
+    if (!m_loadingEntries) {
+        emit groupModified();
+    }
     emit entryAdded(entry);
 }
 
@@ -984,6 +1062,130 @@ void Group::moveEntryDown(Entry* entry)
     emit groupNonDataChange();
 }
 
+/**
+ * Defer creating the entries of this group until they are first accessed.
+ * The loader returns new entries in order, owned by the caller. It may be
+ * called more than once and on any thread, streamEntries() builds temporary
+ * entries with it. Loading them does not modify the group or database.
+ *
+ * The uuids are recorded as deleted objects if the group is deleted before
+ * its entries are loaded. The usernames are counted by the database instead
+ * of the entries until then, so the group must not be part of a database yet.
+ *
+ * @param loader creates the entries
+ * @param uuids uuids of the entries
+ * @param usernames usernames of the entries, without empty ones and references
+ */
+void Group::setEntryLoader(const std::function<QList<Entry*>()>& loader,
+                           const QList<QUuid>& uuids,
+                           const QStringList& usernames)
+{
+    Q_ASSERT(!m_db);
+
+    QMutexLocker locker(&m_entryLoaderMutex);
+    m_entryLoader = loader;
+    m_pendingEntryUuids = uuids;
+    m_pendingEntryUsernames = usernames;
+}
+
+/**
+ * Remember the last top visible entry of this group by uuid, until the
+ * deferred entries of its owner are loaded, see setEntryLoader().
+ */
+void Group::setPendingLastTopVisibleEntry(const QUuid& uuid)
+{
+    m_pendingLastTopVisibleEntry = uuid;
+}
+
+bool Group::hasPendingEntries() const
+{
+    QMutexLocker locker(&m_entryLoaderMutex);
+    return static_cast<bool>(m_entryLoader);
+}
+
+const QStringList& Group::pendingEntryUsernames() const
+{
+    return m_pendingEntryUsernames;
+}
+
+std::function<QList<Entry*>()> Group::entryLoader() const
+{
+    QMutexLocker locker(&m_entryLoaderMutex);
+    return m_entryLoader;
+}
+
+/**
+ * Create the deferred entries of this group and all of its descendants,
+ * see setEntryLoader().
+ */
+void Group::loadEntriesRecursive() const
+{
+    walkGroups([](const Group* group) -> bool {
+        group->loadPendingEntries();
+        return false;
+    });
+}
+
+void Group::loadPendingEntries() const
+{
+    if (!hasPendingEntries()) {
+        return;
+    }
+
+    // Entries are parented to the group, so they have to be created on its thread
+    auto group = const_cast<Group*>(this);
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(group, "loadEntries", Qt::BlockingQueuedConnection);
+    } else {
+        group->loadEntries();
+    }
+}
+
+void Group::loadEntries()
+{
+    const std::function<QList<Entry*>()> loader = entryLoader();
+    if (!loader) {
+        return;
+    }
+
+    // The entries are counted by the database again as they are added
+    emit pendingEntriesAboutToLoad(this);
+
+    // Reset the loader first, adding the entries must not load them again
+    {
+        QMutexLocker locker(&m_entryLoaderMutex);
+        m_entryLoader = nullptr;
+        m_pendingEntryUuids.clear();
+        m_pendingEntryUsernames.clear();
+    }
+
+    m_loadingEntries = true;
+    const QList<Entry*> entries = loader();
+    for (Entry* entry : entries) {
+        entry->setGroup(this);
+        entry->setUpdateTimeinfo(true);
+    }
+    m_loadingEntries = false;
+
+    // Groups of the tree that show one of the entries at the top, this is not a modification either
+    Group* root = this;
+    while (root->m_parent) {
+        root = root->m_parent;
+    }
+    root->walkGroups([&entries](Group* group) -> bool {
+        if (!group->m_pendingLastTopVisibleEntry.isNull()) {
+            for (Entry* entry : entries) {
+                if (entry->uuid() == group->m_pendingLastTopVisibleEntry) {
+                    group->m_lastTopVisibleEntry = entry;
+                    group->m_pendingLastTopVisibleEntry = QUuid();
+                    break;
+                }
+            }
+        }
+        return false;
+    });
+}
+
 void Group::connectDatabaseSignalsRecursive(Database* db)
 {
     if (m_db) {
@@ -1010,6 +1212,16 @@ void Group::connectDatabaseSignalsRecursive(Database* db)
         connect(this, SIGNAL(groupMoved()), db, SIGNAL(groupMoved()));
         connect(this, SIGNAL(groupModified()), db, SLOT(markAsModified()));
         connect(this, SIGNAL(groupNonDataChange()), db, SLOT(markNonDataChange()));
+        connect(this, SIGNAL(entryAdded(Entry*)), db, SLOT(invalidateEntryCache()));
+        connect(this, SIGNAL(entryRemoved(Entry*)), db, SLOT(invalidateEntryCache()));
+        connect(this, SIGNAL(entryAdded(Entry*)), db, SIGNAL(entryAdded(Entry*)));
+        connect(this, SIGNAL(entryRemoved(Entry*)), db, SIGNAL(entryRemoved(Entry*)));
+        connect(this, SIGNAL(entryMovedUp()), db, SLOT(invalidateEntryCache()));
+        connect(this, SIGNAL(entryMovedDown()), db, SLOT(invalidateEntryCache()));
+        connect(this, SIGNAL(entryAdded(Entry*)), db, SLOT(indexUsername(Entry*)));
+        connect(this, SIGNAL(entryRemoved(Entry*)), db, SLOT(unindexUsername(Entry*)));
+        connect(this, SIGNAL(entryDataChanged(Entry*)), db, SLOT(indexUsername(Entry*)));
+        connect(this, SIGNAL(pendingEntriesAboutToLoad(Group*)), db, SLOT(unindexPendingUsernames(Group*)));
         // clang-format on
     }
 
@@ -1024,15 +1236,46 @@ void Group::cleanupParent()
 {
     if (m_parent) {
         emit groupAboutToRemove(this);
-        m_parent->m_children.removeAll(this);
+        m_parent->m_children.removeAt(m_index);
+        m_parent->updateChildIndexes(m_index);
+        m_index = -1;
         emit groupModified();
         emit groupRemoved();
     }
 }
 
+/**
+ * Recompute the cached path of this group and all of its descendants,
+ * parents are visited first.
+ */
+void Group::updateFullPath()
+{
+    walkGroups([](Group* group) -> bool {
+        if (group->m_parent) {
+            group->m_fullPath = group->m_parent->m_fullPath + '/' + group->m_data.name;
+        } else {
+            group->m_fullPath = group->m_data.name;
+        }
+        return false;
+    });
+}
+
+/**
+ * Update the cached position of all children starting at from.
+ */
+void Group::updateChildIndexes(int from)
+{
+    for (int i = from; i < m_children.size(); ++i) {
+        m_children[i]->m_index = i;
+    }
+}
+
 void Group::recCreateDelObjects()
 {
     if (m_db) {
+        for (const QUuid& uuid : asConst(m_pendingEntryUuids)) {
+            m_db->addDeletedObject(uuid);
+        }
         for (Entry* entry : asConst(m_entries)) {
             m_db->addDeletedObject(entry->uuid());
         }
@@ -1090,8 +1333,12 @@ QStringList Group::locate(const QString& locateTerm, const QString& currentPath)
         return response;
     }
 
+    // reuse one buffer for the entry paths instead of allocating one per entry
+    loadPendingEntries();
+    QString entryPath = currentPath;
     for (const Entry* entry : asConst(m_entries)) {
-        QString entryPath = currentPath + entry->title();
+        entryPath.truncate(currentPath.size());
+        entryPath += entry->title();
         if (entryPath.contains(locateTerm, Qt::CaseInsensitive)) {
             response << entryPath;
         }
@@ -1175,7 +1422,7 @@ void Group::applyGroupIconToChildGroups()
 
 void Group::applyGroupIconToChildEntries()
 {
-    for (Entry* recursiveEntry : entriesRecursive(false)) {
+    for (Entry* recursiveEntry : entriesRecursive()) {
         applyGroupIconTo(recursiveEntry);
     }
 }
@@ -1190,10 +1437,15 @@ void Group::sortChildrenRecursively(bool reverse)
                            : name1.compare(name2, Qt::CaseInsensitive) < 0;
         });
 
+    updateChildIndexes(0);
+
     for (auto child : m_children) {
         child->sortChildrenRecursively(reverse);
     }
 
+    if (m_db) {
+        m_db->invalidateEntryCache();
+    }
     emit groupModified();
 }
 
@@ -20,8 +20,12 @@
 #define KEEPASSX_GROUP_H
 
 #include <QImage>
+#include <QMutex>
 #include <QPixmap>
 #include <QPointer>
+#include <QVarLengthArray>
+
+#include <functional>
 
 #include "core/CustomData.h"
 #include "core/Database.h"
@@ -98,6 +102,7 @@ public:
     bool resolveSearchingEnabled() const;
     bool resolveAutoTypeEnabled() const;
     Entry* lastTopVisibleEntry() const;
+    QUuid lastTopVisibleEntryUuid() const;
     bool isExpired() const;
     bool isRecycled() const;
     bool isEmpty() const;
@@ -142,6 +147,8 @@ public:
     const Group* parentGroup() const;
     void setParent(Group* parent, int index = -1);
     QStringList hierarchy(int height = -1) const;
+    QString fullPath() const;
+    int indexInParent() const;
     bool hasChildren() const;
 
     Database* database();
@@ -152,9 +159,13 @@ public:
     const QList<Entry*>& entries() const;
     Entry* findEntryRecursive(const QString& text, EntryReferenceType referenceType, Group* group = nullptr);
     QList<Entry*> referencesRecursive(const Entry* entry) const;
-    QList<Entry*> entriesRecursive(bool includeHistoryItems = false) const;
+    QList<Entry*> entriesRecursive() const;
     QList<const Group*> groupsRecursive(bool includeSelf) const;
     QList<Group*> groupsRecursive(bool includeSelf);
+    template <class Func> bool walkGroups(Func func) const;
+    template <class Func> bool walkGroups(Func func);
+    template <class Func> bool walkEntries(Func func) const;
+    template <class Func> bool streamEntries(Func func) const;
     QSet<QUuid> customIconsRecursive() const;
     QList<QString> usernamesRecursive(int topN = -1) const;
 
@@ -177,6 +188,14 @@ public:
 
     void sortChildrenRecursively(bool reverse = false);
 
+    void setEntryLoader(const std::function<QList<Entry*>()>& loader,
+                        const QList<QUuid>& uuids,
+                        const QStringList& usernames);
+    void setPendingLastTopVisibleEntry(const QUuid& uuid);
+    bool hasPendingEntries() const;
+    const QStringList& pendingEntryUsernames() const;
+    void loadEntriesRecursive() const;
+
 signals:
     void groupDataChanged(Group* group);
     void groupAboutToAdd(Group* group, int index);
@@ -196,18 +215,24 @@ signals:
     void entryAboutToMoveDown(int row);
     void entryMovedDown();
     void entryDataChanged(Entry* entry);
+    void pendingEntriesAboutToLoad(Group* group);
 
 private slots:
     void updateTimeinfo();
+    void loadEntries();
 
 private:
     template <class P, class V> bool set(P& property, const V& value);
 
     void setParent(Database* db);
 
+    void loadPendingEntries() const;
+    std::function<QList<Entry*>()> entryLoader() const;
     void connectDatabaseSignalsRecursive(Database* db);
     void cleanupParent();
     void recCreateDelObjects();
+    void updateFullPath();
+    void updateChildIndexes(int from);
 
     Entry* findEntryByPathRecursive(const QString& entryPath, const QString& basePath);
     Group* findGroupByPathRecursive(const QString& groupPath, const QString& basePath);
@@ -218,10 +243,21 @@ private:
     QPointer<Entry> m_lastTopVisibleEntry;
     QList<Group*> m_children;
     QList<Entry*> m_entries;
+    // creates the entries of a lazily read group on first access, see setEntryLoader()
+    std::function<QList<Entry*>()> m_entryLoader;
+    mutable QMutex m_entryLoaderMutex;
+    QList<QUuid> m_pendingEntryUuids;
+    QStringList m_pendingEntryUsernames;
+    QUuid m_pendingLastTopVisibleEntry;
+    bool m_loadingEntries;
 
     QPointer<CustomData> m_customData;
 
     QPointer<Group> m_parent;
+    // names from the root group down to this group joined by '/', see fullPath()
+    QString m_fullPath;
+    // position in m_parent->m_children, see indexInParent()
+    int m_index;
 
     bool m_updateTimeinfo;
 
@@ -232,4 +268,85 @@ private:
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Group::CloneFlags)
 
+/**
+ * Visit this group and all of its descendants in pre-order without building
+ * intermediate lists. The walk stops as soon as func returns true.
+ *
+ * @return true if the walk was stopped by func
+ */
+template <class Func> bool Group::walkGroups(Func func) const
+{
+    QVarLengthArray<const Group*, 32> stack;
+    stack.append(this);
+    while (!stack.isEmpty()) {
+        const Group* group = stack.last();
+        stack.removeLast();
+        if (func(group)) {
+            return true;
+        }
+        for (int i = group->m_children.size() - 1; i >= 0; --i) {
+            stack.append(group->m_children.at(i));
+        }
+    }
+    return false;
+}
+
+template <class Func> bool Group::walkGroups(Func func)
+{
+    return static_cast<const Group*>(this)->walkGroups(
+        [&func](const Group* group) -> bool { return func(const_cast<Group*>(group)); });
+}
+
+/**
+ * Visit all entries of this group and its descendants in the order of
+ * entriesRecursive(). The walk stops as soon as func returns true.
+ * History items are not visited, walk them per entry with
+ * Entry::walkHistoryItems().
+ *
+ * @return true if the walk was stopped by func
+ */
+template <class Func> bool Group::walkEntries(Func func) const
+{
+    return walkGroups([&func](const Group* group) -> bool {
+        group->loadPendingEntries();
+        for (Entry* entry : group->m_entries) {
+            if (func(entry)) {
+                return true;
+            }
+        }
+        return false;
+    });
+}
+
+/**
+ * Visit the entries of this group without loading deferred entries, see
+ * setEntryLoader(). Those are built for the walk and deleted afterwards, so
+ * func must not keep them and they have no group.
+ *
+ * @return true if the walk was stopped by func
+ */
+template <class Func> bool Group::streamEntries(Func func) const
+{
+    const std::function<QList<Entry*>()> loader = entryLoader();
+    if (!loader) {
+        for (const Entry* entry : m_entries) {
+            if (func(entry)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const QList<Entry*> entries = loader();
+    bool stopped = false;
+    for (const Entry* entry : entries) {
+        if (func(entry)) {
+            stopped = true;
+            break;
+        }
+    }
+    qDeleteAll(entries);
+    return stopped;
+}
+
 #endif // KEEPASSX_GROUP_H
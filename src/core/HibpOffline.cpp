@@ -80,7 +80,9 @@ namespace HibpOffline
     report(QSharedPointer<Database> db, QIODevice& hibpInput, QList<QPair<const Entry*, int>>& findings, QString* error)
     {
         QMultiHash<QByteArray, const Entry*> entriesBySha1;
-        for (const auto* entry : db->rootGroup()->entriesRecursive()) {
+        db->rootGroup()->loadEntriesRecursive();
+        const auto entries = db->entries();
+        for (const auto* entry : entries) {
             if (!entry->isRecycled()) {
                 const auto sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
                 entriesBySha1.insert(sha1, entry);
@@ -0,0 +1,200 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IconDownloadQueue.h"
+#include "core/Global.h"
+#include "core/IconDownloader.h"
+
+#include <QUrl>
+
+namespace
+{
+    // Browsers open about six connections per host, stay below that
+    constexpr int DefaultMaxDownloads = 8;
+    constexpr int DefaultMaxDownloadsPerHost = 2;
+} // namespace
+
+IconDownloadQueue::IconDownloadQueue(QObject* parent)
+    : QObject(parent)
+    , m_maxDownloads(DefaultMaxDownloads)
+    , m_maxDownloadsPerHost(DefaultMaxDownloadsPerHost)
+    , m_urlsRemaining(0)
+{
+}
+
+IconDownloadQueue::~IconDownloadQueue()
+{
+    abort();
+}
+
+void IconDownloadQueue::setMaxDownloads(int count)
+{
+    m_maxDownloads = qMax(1, count);
+}
+
+void IconDownloadQueue::setMaxDownloadsPerHost(int count)
+{
+    m_maxDownloadsPerHost = qMax(1, count);
+}
+
+/*
+ * Add one URL to download the favicon for.
+ *
+ * Invoke this function once for every URL, then call download().
+ * URLs of a site that is already queued only join its download.
+ */
+void IconDownloadQueue::add(const QString& url)
+{
+    const auto key = siteKey(url);
+    auto download = m_downloads.find(key);
+    if (download == m_downloads.end() && !key.isEmpty()) {
+        auto downloader = new IconDownloader(this);
+        downloader->setUrl(url);
+        if (downloader->host().isEmpty()) {
+            delete downloader;
+        } else {
+            connect(downloader,
+                    SIGNAL(finished(const QString&, const QImage&)),
+                    SLOT(downloadFinished(const QString&, const QImage&)));
+            Download newDownload;
+            newDownload.downloader = downloader;
+            newDownload.host = downloader->host();
+            download = m_downloads.insert(key, newDownload);
+            m_queue << key;
+        }
+    }
+
+    if (download == m_downloads.end()) {
+        // Nothing to fetch for this URL, it fails right away
+        if (!m_invalidUrls.contains(url)) {
+            m_invalidUrls << url;
+            ++m_urlsRemaining;
+        }
+    } else if (!download->urls.contains(url)) {
+        download->urls << url;
+        ++m_urlsRemaining;
+    }
+}
+
+/*
+ * Start downloading the favicons of all added URLs.
+ */
+void IconDownloadQueue::download()
+{
+    if (!m_invalidUrls.isEmpty()) {
+        const auto urls = m_invalidUrls;
+        m_invalidUrls.clear();
+        m_urlsRemaining -= urls.size();
+        emit finished(urls, {});
+    }
+
+    startDownloads();
+}
+
+int IconDownloadQueue::urlsRemaining() const
+{
+    return m_urlsRemaining;
+}
+
+/*
+ * Key of the site a URL belongs to, made of its scheme, host and port.
+ *
+ * IconDownloader derives all favicon locations from these, so every
+ * URL with the same key yields the same icon. Returns an empty string
+ * for URLs without a host.
+ */
+QString IconDownloadQueue::siteKey(const QString& url)
+{
+    QUrl siteUrl(url);
+    if (siteUrl.scheme().isEmpty()) {
+        siteUrl.setUrl(QString("https://%1").arg(siteUrl.toString()));
+    }
+
+    if (!siteUrl.isValid() || siteUrl.host().isEmpty()) {
+        return {};
+    }
+
+    // QUrl already normalizes the scheme and host to lower case
+    return siteUrl
+        .adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment)
+        .toString();
+}
+
+/*
+ * Abort all downloads and forget the added URLs.
+ */
+void IconDownloadQueue::abort()
+{
+    for (const auto& download : asConst(m_downloads)) {
+        download.downloader->disconnect(this);
+        delete download.downloader;
+    }
+
+    m_downloads.clear();
+    m_queue.clear();
+    m_hostLoad.clear();
+    m_invalidUrls.clear();
+    m_urlsRemaining = 0;
+}
+
+/*
+ * Start queued downloads in order, as far as the limits allow.
+ */
+void IconDownloadQueue::startDownloads()
+{
+    int running = m_downloads.size() - m_queue.size();
+    for (auto key = m_queue.begin(); key != m_queue.end() && running < m_maxDownloads;) {
+        const auto download = m_downloads.value(*key);
+        int& load = m_hostLoad[download.host];
+        if (load >= m_maxDownloadsPerHost) {
+            ++key;
+            continue;
+        }
+
+        ++load;
+        ++running;
+        key = m_queue.erase(key);
+        download.downloader->download();
+    }
+
+    if (m_downloads.isEmpty()) {
+        emit allFinished();
+    }
+}
+
+/*
+ * Called when the favicon of a site has been downloaded or could not be found.
+ */
+void IconDownloadQueue::downloadFinished(const QString& url, const QImage& icon)
+{
+    const auto key = siteKey(url);
+    if (!m_downloads.contains(key)) {
+        return;
+    }
+
+    const auto download = m_downloads.take(key);
+    if (--m_hostLoad[download.host] <= 0) {
+        m_hostLoad.remove(download.host);
+    }
+    m_urlsRemaining -= download.urls.size();
+    download.downloader->deleteLater();
+
+    // Share the result with every URL of this site
+    emit finished(download.urls, icon);
+
+    startDownloads();
+}
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_ICONDOWNLOADQUEUE_H
+#define KEEPASSXC_ICONDOWNLOADQUEUE_H
+
+#include "config-keepassx.h"
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QStringList>
+
+#ifndef WITH_XC_NETWORKING
+#error This file requires KeePassXC to be built with network support.
+#endif
+
+class IconDownloader;
+
+/*
+ * Download the favicons of many URLs in the background.
+ *
+ * URLs are grouped by scheme, host and port so every site is only
+ * fetched once, and the result is shared by all URLs of that site.
+ * The number of concurrent downloads is limited overall and per
+ * contacted host.
+ *
+ * Usage: add() all URLs, then call download() and process the
+ * `finished` signal for every site. `allFinished` is emitted once
+ * no download is left.
+ */
+class IconDownloadQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IconDownloadQueue(QObject* parent = nullptr);
+    ~IconDownloadQueue() override;
+
+    void setMaxDownloads(int count);
+    void setMaxDownloadsPerHost(int count);
+
+    void add(const QString& url);
+    void download();
+    int urlsRemaining() const;
+
+    static QString siteKey(const QString& url);
+
+signals:
+    void finished(const QStringList& urls, const QImage& icon);
+    void allFinished();
+
+public slots:
+    void abort();
+
+private slots:
+    void downloadFinished(const QString& url, const QImage& icon);
+
+private:
+    struct Download
+    {
+        IconDownloader* downloader;
+        QString host;
+        QStringList urls;
+    };
+
+    void startDownloads();
+
+    QHash<QString, Download> m_downloads; // Unfinished downloads by site key
+    QStringList m_queue; // Site keys of the downloads not started yet
+    QHash<QString, int> m_hostLoad;
+    QStringList m_invalidUrls;
+    int m_maxDownloads;
+    int m_maxDownloadsPerHost;
+    int m_urlsRemaining;
+};
+
+#endif // KEEPASSXC_ICONDOWNLOADQUEUE_H
@@ -21,6 +21,7 @@
 
 #include <QHostInfo>
 #include <QImageReader>
+#include <QtConcurrent>
 #include <QtNetwork>
 
 #define MAX_REDIRECTS 5
@@ -32,10 +33,13 @@ IconDownloader::IconDownloader(QObject* parent)
 {
     m_timeout.setSingleShot(true);
     connect(&m_timeout, SIGNAL(timeout()), SLOT(abortDownload()));
+    connect(&m_parseWatcher, SIGNAL(finished()), SLOT(parseFinished()));
 }
 
 IconDownloader::~IconDownloader()
 {
+    // Don't move on to the next URL while being destroyed
+    m_urlsToTry.clear();
     abortDownload();
 }
 
@@ -117,11 +121,14 @@ void IconDownloader::setUrl(const QString& entryUrl)
     }
 
     // Add a direct pull of the website's own favicon.ico file
-    m_urlsToTry.append(QUrl(url.scheme() + "://" + fullyQualifiedDomain + "/favicon.ico"));
+    QUrl faviconUrl(url.scheme() + "://" + fullyQualifiedDomain + "/favicon.ico");
+    faviconUrl.setPort(url.port());
+    m_urlsToTry.append(faviconUrl);
 
     // Also try a direct pull of the second-level domain (if possible)
     if (!hostIsIp && fullyQualifiedDomain != secondLevelDomain) {
-        m_urlsToTry.append(QUrl(url.scheme() + "://" + secondLevelDomain + "/favicon.ico"));
+        faviconUrl.setHost(secondLevelDomain);
+        m_urlsToTry.append(faviconUrl);
     }
 }
 
@@ -141,6 +148,14 @@ void IconDownloader::download()
     }
 }
 
+/**
+ * Host contacted first by download(), empty if there is nothing to download.
+ */
+QString IconDownloader::host() const
+{
+    return m_urlsToTry.isEmpty() ? QString() : m_urlsToTry.first().host();
+}
+
 void IconDownloader::abortDownload()
 {
     if (m_reply) {
@@ -167,9 +182,6 @@ void IconDownloader::fetchReadyRead()
 
 void IconDownloader::fetchFinished()
 {
-    QImage image;
-    QString url = m_url;
-
     bool error = (m_reply->error() != QNetworkReply::NoError);
     QUrl redirectTarget = getRedirectTarget(m_reply);
 
@@ -189,14 +201,28 @@ void IconDownloader::fetchFinished()
             }
         } else {
             // No redirect, and we theoretically have some icon data now.
-            image = parseImage(m_bytesReceived);
+            // Decode it on the thread pool to keep the GUI responsive.
+            const QByteArray imageBytes = m_bytesReceived;
+            m_bytesReceived.clear();
+            m_parseWatcher.setFuture(QtConcurrent::run([imageBytes] { return parseImage(imageBytes); }));
+            return;
         }
     }
 
+    imageReceived(QImage());
+}
+
+void IconDownloader::parseFinished()
+{
+    imageReceived(m_parseWatcher.result());
+}
+
+void IconDownloader::imageReceived(const QImage& image)
+{
     if (!image.isNull()) {
         // Valid icon received
         m_timeout.stop();
-        emit finished(url, image);
+        emit finished(m_url, image);
     } else if (!m_urlsToTry.empty()) {
         // Try the next url
         m_redirects = 0;
@@ -204,7 +230,7 @@ void IconDownloader::fetchFinished()
     } else {
         // No icon found
         m_timeout.stop();
-        emit finished(url, image);
+        emit finished(m_url, image);
     }
 }
 
@@ -212,27 +238,35 @@ void IconDownloader::fetchFinished()
  * Parse fetched image bytes.
  *
  * Parses the given byte array into a QImage. Unlike QImage::loadFromData(), this method
- * tries to extract the highest resolution image from .ICO files.
+ * tries to extract the highest resolution image from .ICO files. Images larger than
+ * 128x128 are scaled down, smaller ones retain their original size.
+ *
+ * Thread-safe, called on the thread pool.
  *
  * @param imageBytes raw image bytes
  * @return parsed image
  */
-QImage IconDownloader::parseImage(QByteArray& imageBytes) const
+QImage IconDownloader::parseImage(const QByteArray& imageBytes)
 {
-    QBuffer buff(&imageBytes);
+    QBuffer buff;
+    buff.setData(imageBytes);
     buff.open(QIODevice::ReadOnly);
     QImageReader reader(&buff);
 
+    QImage img;
     if (reader.imageCount() <= 0) {
-        return reader.read();
+        img = reader.read();
+    } else {
+        for (int i = 0; i < reader.imageCount(); ++i) {
+            if (img.isNull() || reader.size().width() > img.size().width()) {
+                img = reader.read();
+            }
+            reader.jumpToNextImage();
+        }
     }
 
-    QImage img;
-    for (int i = 0; i < reader.imageCount(); ++i) {
-        if (img.isNull() || reader.size().width() > img.size().width()) {
-            img = reader.read();
-        }
-        reader.jumpToNextImage();
+    if (img.width() > 128 || img.height() > 128) {
+        img = img.scaled(128, 128);
     }
 
     return img;
@@ -18,6 +18,7 @@
 #ifndef KEEPASSXC_ICONDOWNLOADER_H
 #define KEEPASSXC_ICONDOWNLOADER_H
 
+#include <QFutureWatcher>
 #include <QImage>
 #include <QObject>
 #include <QTimer>
@@ -37,6 +38,7 @@ public:
 
     void setUrl(const QString& entryUrl);
     void download();
+    QString host() const;
 
 signals:
     void finished(const QString& entryUrl, const QImage& image);
@@ -47,10 +49,12 @@ public slots:
 private slots:
     void fetchFinished();
     void fetchReadyRead();
+    void parseFinished();
 
 private:
     void fetchFavicon(const QUrl& url);
-    QImage parseImage(QByteArray& imageBytes) const;
+    void imageReceived(const QImage& image);
+    static QImage parseImage(const QByteArray& imageBytes);
 
     QString m_url;
     QUrl m_fetchUrl;
@@ -58,6 +62,7 @@ private:
     QByteArray m_bytesReceived;
     QNetworkReply* m_reply;
     QTimer m_timeout;
+    QFutureWatcher<QImage> m_parseWatcher;
     int m_redirects;
 };
 
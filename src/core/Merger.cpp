@@ -21,6 +21,7 @@
 #include "core/Database.h"
 #include "core/Entry.h"
 #include "core/Metadata.h"
+#include "core/Trace.h"
 
 Merger::Merger(const Database* sourceDb, Database* targetDb)
     : m_mode(Group::Default)
@@ -62,6 +63,9 @@ void Merger::resetForcedMergeMode()
 
 QStringList Merger::merge()
 {
+    TRACE_SCOPE("Merger::merge");
+    Database::BulkUpdate bulkUpdate(m_context.m_targetDb);
+
     // Order of merge steps is important - it is possible that we
     // create some items before deleting them afterwards
     ChangeList changes;
@@ -408,8 +412,9 @@ Merger::resolveEntryConflict(const MergeContext& context, const Entry* sourceEnt
 bool Merger::mergeHistory(const Entry* sourceEntry, Entry* targetEntry, Group::MergeMode mergeMethod)
 {
     Q_UNUSED(mergeMethod);
-    const auto targetHistoryItems = targetEntry->historyItems();
-    const auto sourceHistoryItems = sourceEntry->historyItems();
+    // Copies, so compact history is not expanded for good
+    const QList<Entry*> targetHistoryItems = targetEntry->cloneHistoryItems();
+    const QList<Entry*> sourceHistoryItems = sourceEntry->cloneHistoryItems();
     const int comparison = compare(sourceEntry->timeInfo().lastModificationTime(),
                                    targetEntry->timeInfo().lastModificationTime(),
                                    CompareItemIgnoreMilliseconds);
@@ -492,6 +497,8 @@ bool Merger::mergeHistory(const Entry* sourceEntry, Entry* targetEntry, Group::M
         changed = true;
         break;
     }
+    qDeleteAll(targetHistoryItems);
+    qDeleteAll(sourceHistoryItems);
     if (!changed) {
         qDeleteAll(updatedHistoryItems);
         return false;
@@ -502,12 +509,13 @@ bool Merger::mergeHistory(const Entry* sourceEntry, Entry* targetEntry, Group::M
     const bool blockedSignals = targetEntry->blockSignals(true);
     bool updateTimeInfo = targetEntry->canUpdateTimeinfo();
     targetEntry->setUpdateTimeinfo(false);
-    targetEntry->removeHistoryItems(targetHistoryItems);
+    targetEntry->clearHistory();
     for (Entry* historyItem : merged) {
         Q_ASSERT(!historyItem->parent());
         targetEntry->addHistoryItem(historyItem);
     }
     targetEntry->truncateHistory();
+    targetEntry->compactHistory();
     targetEntry->blockSignals(blockedSignals);
     targetEntry->setUpdateTimeinfo(updateTimeInfo);
     Q_ASSERT(timeInfo == targetEntry->timeInfo());
@@ -583,7 +591,7 @@ Merger::ChangeList Merger::mergeDeletions(const MergeContext& context)
             // keep deleted group since it was changed after deletion date
             continue;
         }
-        if (!group->entriesRecursive(false).isEmpty() || !group->groupsRecursive(false).isEmpty()) {
+        if (!group->entries().isEmpty() || !group->children().isEmpty()) {
             // keep deleted group since it contains undeleted content
             continue;
         }
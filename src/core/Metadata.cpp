@@ -16,10 +16,10 @@
  */
 
 #include "Metadata.h"
-#include <QApplication>
 #include <QtCore/QCryptographicHash>
 
 #include "core/Clock.h"
+#include "core/CustomIconCache.h"
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
 #include "core/Group.h"
@@ -30,6 +30,7 @@ const int Metadata::DefaultHistoryMaxSize = 6 * 1024 * 1024;
 
 Metadata::Metadata(QObject* parent)
     : QObject(parent)
+    , m_customIconCache(new CustomIconCache(this))
     , m_customData(new CustomData(this))
     , m_updateDatetime(true)
 {
@@ -65,7 +66,7 @@ void Metadata::init()
 void Metadata::clear()
 {
     init();
-    m_customIcons.clear();
+    m_customIconCache->clear();
     m_customIconsRaw.clear();
     m_customIconsOrder.clear();
     m_customIconsHashes.clear();
@@ -187,7 +188,15 @@ QPixmap Metadata::customIconPixmap(const QUuid& uuid, IconSize size) const
     if (!hasCustomIcon(uuid)) {
         return {};
     }
-    return m_customIcons.value(uuid).pixmap(databaseIcons()->iconSize(size));
+    return m_customIconCache->pixmap(uuid, size);
+}
+
+QPixmap Metadata::customIconPixmap(const QUuid& uuid, IconSize size, DatabaseIcons::Badges badge) const
+{
+    if (!hasCustomIcon(uuid)) {
+        return {};
+    }
+    return m_customIconCache->pixmap(uuid, size, badge);
 }
 
 QHash<QUuid, QPixmap> Metadata::customIconsPixmaps(IconSize size) const
@@ -373,18 +382,8 @@ void Metadata::addCustomIcon(const QUuid& uuid, const QImage& image)
     m_customIconsHashes[hash] = uuid;
     Q_ASSERT(m_customIconsRaw.count() == m_customIconsOrder.count());
 
-    // TODO: This check can go away when we move all QIcon handling outside of core
-    // On older versions of Qt, loading a QPixmap from QImage outside of a GUI
-    // environment causes ASAN to fail and crash on nullptr violation
-    static bool isGui = qApp->inherits("QGuiApplication");
-    if (isGui) {
-        // Generate QIcon with pre-baked resolutions
-        auto basePixmap = QPixmap::fromImage(image.scaled(64, 64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-        QIcon icon(basePixmap);
-        m_customIcons.insert(uuid, icon);
-    } else {
-        m_customIcons.insert(uuid, QIcon());
-    }
+    // Pixmaps are only created once they are needed
+    m_customIconCache->insert(uuid, image);
 
     emit metadataModified();
 }
@@ -400,7 +399,7 @@ void Metadata::removeCustomIcon(const QUuid& uuid)
         m_customIconsHashes.remove(hash);
     }
 
-    m_customIcons.remove(uuid);
+    m_customIconCache->remove(uuid);
     m_customIconsRaw.remove(uuid);
     m_customIconsOrder.removeAll(uuid);
     Q_ASSERT(m_customIconsRaw.count() == m_customIconsOrder.count());
@@ -29,8 +29,10 @@
 #include <QUuid>
 
 #include "core/CustomData.h"
+#include "core/DatabaseIcons.h"
 #include "core/Global.h"
 
+class CustomIconCache;
 class Database;
 class Group;
 
@@ -86,6 +88,7 @@ public:
     QImage customIcon(const QUuid& uuid) const;
     bool hasCustomIcon(const QUuid& uuid) const;
     QPixmap customIconPixmap(const QUuid& uuid, IconSize size = IconSize::Default) const;
+    QPixmap customIconPixmap(const QUuid& uuid, IconSize size, DatabaseIcons::Badges badge) const;
     QHash<QUuid, QPixmap> customIconsPixmaps(IconSize size = IconSize::Default) const;
     QList<QUuid> customIconsOrder() const;
     bool recycleBinEnabled() const;
@@ -160,7 +163,7 @@ private:
 
     MetadataData m_data;
 
-    QHash<QUuid, QIcon> m_customIcons;
+    CustomIconCache* m_customIconCache;
     QHash<QUuid, QImage> m_customIconsRaw;
     QList<QUuid> m_customIconsOrder;
     QHash<QByteArray, QUuid> m_customIconsHashes;
@@ -66,6 +66,16 @@ void PasswordGenerator::setExcludedChars(const QString& chars)
 }
 
 QString PasswordGenerator::generatePassword() const
+{
+    return generatePasswords(1).first();
+}
+
+/**
+ * Generate several passwords with the same settings. The character groups are
+ * only built once and randomness is drawn in large blocks, which makes bulk
+ * generation considerably faster than repeated calls to generatePassword().
+ */
+QStringList PasswordGenerator::generatePasswords(int count) const
 {
     Q_ASSERT(isValid());
 
@@ -78,24 +88,42 @@ QString PasswordGenerator::generatePassword() const
         }
     }
 
+    // Avoid fetching a whole block of randomness for a single short password
+    const qint64 expectedBytes = static_cast<qint64>(count) * m_length * 8;
+    RandomBuffer random(static_cast<int>(qMin(expectedBytes, static_cast<qint64>(RandomBuffer::DefaultSize))));
+
+    QStringList passwords;
+    passwords.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        passwords.append(generatePassword(groups, passwordChars, random));
+    }
+
+    return passwords;
+}
+
+QString PasswordGenerator::generatePassword(const QVector<PasswordGroup>& groups,
+                                            const QVector<QChar>& passwordChars,
+                                            RandomBuffer& random) const
+{
     QString password;
+    password.reserve(m_length);
 
     if (m_flags & CharFromEveryGroup) {
         for (const auto& group : groups) {
-            int pos = randomGen()->randomUInt(static_cast<quint32>(group.size()));
+            int pos = random.randomUInt(static_cast<quint32>(group.size()));
 
             password.append(group[pos]);
         }
 
         for (int i = groups.size(); i < m_length; i++) {
-            int pos = randomGen()->randomUInt(static_cast<quint32>(passwordChars.size()));
+            int pos = random.randomUInt(static_cast<quint32>(passwordChars.size()));
 
             password.append(passwordChars[pos]);
         }
 
         // shuffle chars
         for (int i = (password.size() - 1); i >= 1; i--) {
-            int j = randomGen()->randomUInt(static_cast<quint32>(i + 1));
+            int j = random.randomUInt(static_cast<quint32>(i + 1));
 
             QChar tmp = password[i];
             password[i] = password[j];
@@ -103,7 +131,7 @@ QString PasswordGenerator::generatePassword() const
         }
     } else {
         for (int i = 0; i < m_length; i++) {
-            int pos = randomGen()->randomUInt(static_cast<quint32>(passwordChars.size()));
+            int pos = random.randomUInt(static_cast<quint32>(passwordChars.size()));
 
             password.append(passwordChars[pos]);
         }
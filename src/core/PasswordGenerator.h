@@ -21,8 +21,11 @@
 
 #include <QFlags>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 
+class RandomBuffer;
+
 typedef QVector<QChar> PasswordGroup;
 
 class PasswordGenerator
@@ -66,6 +69,7 @@ public:
     bool isValid() const;
 
     QString generatePassword() const;
+    QStringList generatePasswords(int count) const;
 
     static const int DefaultLength = 32;
     static const char* DefaultAdditionalChars;
@@ -73,6 +77,9 @@ public:
 
 private:
     QVector<PasswordGroup> passwordGroups() const;
+    QString generatePassword(const QVector<PasswordGroup>& groups,
+                             const QVector<QChar>& passwordChars,
+                             RandomBuffer& random) const;
     int numCharClasses() const;
 
     int m_length;
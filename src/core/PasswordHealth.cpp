@@ -105,10 +105,12 @@ PasswordHealth::Quality PasswordHealth::quality() const
 HealthChecker::HealthChecker(QSharedPointer<Database> db)
 {
     // Build the cache of re-used passwords
-    for (const auto* entry : db->rootGroup()->entriesRecursive()) {
+    db->rootGroup()->loadEntriesRecursive();
+    const auto entries = db->entries();
+    for (const auto* entry : entries) {
         if (!entry->isRecycled() && !entry->isAttributeReference("Password")) {
             m_reuse[entry->password()]
-                << QApplication::tr("Used in %1/%2").arg(entry->group()->hierarchy().join('/'), entry->title());
+                << QApplication::tr("Used in %1/%2").arg(entry->group()->fullPath(), entry->title());
         }
     }
 }
@@ -0,0 +1,170 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Trace.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+
+#include "core/Global.h"
+
+namespace
+{
+    // Upper bound for the recorded spans, a trace left running must not use up all memory
+    const int MaxEvents = 1000000;
+
+    struct Event
+    {
+        const char* name;
+        qint64 start;
+        qint64 duration;
+        int thread;
+    };
+
+    struct TraceState
+    {
+        QMutex mutex;
+        QElapsedTimer timer;
+        QVector<Event> events;
+        QString fileName;
+    };
+
+    Q_GLOBAL_STATIC(TraceState, state)
+    QAtomicInt enabled(0);
+
+    // Small, stable thread numbers are easier to read in trace viewers than thread handles
+    int threadIndex()
+    {
+        static QAtomicInt threads(0);
+        thread_local int index = threads.fetchAndAddRelaxed(1) + 1;
+        return index;
+    }
+
+    void finishTrace()
+    {
+        Trace::finish();
+    }
+} // namespace
+
+namespace Trace
+{
+    /**
+     * Start recording spans, to be written to fileName or the file named by
+     * the KEEPASSXC_TRACE environment variable if fileName is empty.
+     *
+     * @return true if tracing was started
+     */
+    bool start(const QString& fileName)
+    {
+#ifdef WITH_XC_TRACING
+        const QString traceFile = fileName.isEmpty() ? QString::fromLocal8Bit(qgetenv("KEEPASSXC_TRACE")) : fileName;
+        if (traceFile.isEmpty() || isEnabled()) {
+            return false;
+        }
+
+        {
+            QMutexLocker locker(&state->mutex);
+            state->fileName = traceFile;
+            state->events.clear();
+            state->timer.start();
+        }
+        enabled.storeRelease(1);
+
+        if (QCoreApplication::instance()) {
+            qAddPostRoutine(finishTrace);
+        }
+        return true;
+#else
+        Q_UNUSED(fileName);
+        return false;
+#endif
+    }
+
+    /**
+     * Stop recording and write all spans recorded so far.
+     *
+     * @return true if the trace file was written
+     */
+    bool finish()
+    {
+        if (!enabled.testAndSetOrdered(1, 0)) {
+            return false;
+        }
+
+        QMutexLocker locker(&state->mutex);
+        const qint64 pid = QCoreApplication::applicationPid();
+
+        QJsonArray traceEvents;
+        for (const Event& event : asConst(state->events)) {
+            QJsonObject traceEvent;
+            traceEvent["name"] = QString::fromLatin1(event.name);
+            traceEvent["ph"] = QStringLiteral("X");
+            // Chrome trace timestamps are in microseconds
+            traceEvent["ts"] = event.start / 1000.0;
+            traceEvent["dur"] = event.duration / 1000.0;
+            traceEvent["pid"] = pid;
+            traceEvent["tid"] = event.thread;
+            traceEvents.append(traceEvent);
+        }
+        state->events.clear();
+
+        QJsonObject trace;
+        trace["traceEvents"] = traceEvents;
+        trace["displayTimeUnit"] = QStringLiteral("ms");
+
+        QFile file(state->fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning("Unable to write trace file %s: %s", qPrintable(state->fileName), qPrintable(file.errorString()));
+            return false;
+        }
+        file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+        return true;
+    }
+
+    bool isEnabled()
+    {
+        return enabled.loadAcquire() != 0;
+    }
+
+    Span::Span(const char* name)
+        : m_name(name)
+        , m_start(isEnabled() ? state->timer.nsecsElapsed() : -1)
+    {
+    }
+
+    Span::~Span()
+    {
+        if (m_start < 0 || !isEnabled()) {
+            return;
+        }
+
+        const qint64 end = state->timer.nsecsElapsed();
+        const int thread = threadIndex();
+        QMutexLocker locker(&state->mutex);
+        if (state->events.size() < MaxEvents) {
+            state->events.append({m_name, m_start, end - m_start, thread});
+        }
+    }
+} // namespace Trace
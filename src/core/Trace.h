@@ -0,0 +1,64 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TRACE_H
+#define KEEPASSXC_TRACE_H
+
+#include <QString>
+#include <QtGlobal>
+
+#include "config-keepassx.h"
+
+/**
+ * Lightweight tracing of slow operations.
+ *
+ * Spans are recorded only after start() was called, with the --trace option
+ * or the KEEPASSXC_TRACE environment variable, and written as Chrome trace
+ * event JSON (chrome://tracing, Perfetto) when the application quits.
+ * Use the TRACE_SCOPE macro to time the rest of a scope, it compiles to
+ * nothing without WITH_XC_TRACING.
+ */
+namespace Trace
+{
+    bool start(const QString& fileName = {});
+    bool finish();
+    bool isEnabled();
+
+    class Span
+    {
+    public:
+        // name must be a string literal, it is stored as a pointer
+        explicit Span(const char* name);
+        ~Span();
+
+    private:
+        Q_DISABLE_COPY(Span)
+
+        const char* m_name;
+        qint64 m_start;
+    };
+} // namespace Trace
+
+#ifdef WITH_XC_TRACING
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif // KEEPASSXC_TRACE_H
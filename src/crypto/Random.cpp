@@ -17,6 +17,7 @@
 
 #include "Random.h"
 
+#include <cstring>
 #include <gcrypt.h>
 
 #include "core/Global.h"
@@ -91,6 +92,47 @@ Random::Random(RandomBackend* backend)
 {
 }
 
+RandomBuffer::RandomBuffer(int size)
+    : m_buffer(qMax(size, 4) & ~3, '\0')
+    , m_position(m_buffer.size())
+{
+}
+
+RandomBuffer::~RandomBuffer()
+{
+    m_buffer.fill('\0');
+}
+
+quint32 RandomBuffer::randomUInt(quint32 limit)
+{
+    Q_ASSERT(limit != 0);
+
+    quint32 rand;
+    const quint32 ceil = QUINT32_MAX - (QUINT32_MAX % limit) - 1;
+
+    // Same rejection sampling as Random::randomUInt to avoid modulo bias
+    do {
+        rand = nextUInt();
+    } while (rand > ceil);
+
+    return (rand % limit);
+}
+
+quint32 RandomBuffer::nextUInt()
+{
+    if (m_position >= m_buffer.size()) {
+        randomGen()->randomize(m_buffer);
+        m_position = 0;
+    }
+
+    quint32 rand;
+    memcpy(&rand, m_buffer.constData() + m_position, sizeof(rand));
+    // Every random byte is used only once
+    memset(m_buffer.data() + m_position, 0, sizeof(rand));
+    m_position += sizeof(rand);
+    return rand;
+}
+
 void RandomBackendGcrypt::randomize(void* data, int len)
 {
     Q_ASSERT(Crypto::initialized());
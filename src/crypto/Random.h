@@ -61,6 +61,33 @@ private:
     Q_DISABLE_COPY(Random)
 };
 
+/**
+ * Draws random numbers from a block of randomness which is fetched from
+ * the Random instance in one go and refilled when exhausted. Generating
+ * many small numbers costs one backend call per block instead of one per number.
+ */
+class RandomBuffer
+{
+public:
+    explicit RandomBuffer(int size = DefaultSize);
+    ~RandomBuffer();
+
+    /**
+     * Generate a random quint32 in the range [0, @p limit)
+     */
+    quint32 randomUInt(quint32 limit);
+
+    static const int DefaultSize = 4096;
+
+private:
+    quint32 nextUInt();
+
+    QByteArray m_buffer;
+    int m_position;
+
+    Q_DISABLE_COPY(RandomBuffer)
+};
+
 inline Random* randomGen()
 {
     return Random::instance();
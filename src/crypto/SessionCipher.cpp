@@ -0,0 +1,165 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SessionCipher.h"
+
+#include <QAtomicInt>
+#include <QCache>
+#include <QMutex>
+
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
+#include "crypto/SymmetricCipher.h"
+
+namespace
+{
+    QAtomicInt g_enabled(0);
+
+    QMutex g_cacheMutex;
+    QCache<QByteArray, QString> g_cache(SessionCipher::CacheSize);
+
+    const int NonceSize = 12;
+
+    bool processValue(const QByteArray& key, const QByteArray& nonce, QByteArray& data)
+    {
+        SymmetricCipher cipher(SymmetricCipher::ChaCha20, SymmetricCipher::Stream, SymmetricCipher::Encrypt);
+        return cipher.init(key, nonce) && cipher.processInPlace(data);
+    }
+} // namespace
+
+bool SessionCipher::isEnabled()
+{
+    return g_enabled.load() != 0;
+}
+
+/**
+ * Enable sealing of values that are stored from now on.
+ * Values that were sealed before remain readable.
+ */
+void SessionCipher::setEnabled(bool enabled)
+{
+    g_enabled.store(enabled ? 1 : 0);
+}
+
+const QByteArray& SessionCipher::sessionKey()
+{
+    static const QByteArray key = randomGen()->randomArray(32);
+    return key;
+}
+
+/**
+ * Encrypt a value under the session key.
+ *
+ * The nonce is derived from the value, so the same value is always sealed
+ * to the same data during a session.
+ *
+ * @param value plaintext value
+ * @param sealed nonce followed by the encrypted UTF-8 value
+ * @return true on success
+ */
+bool SessionCipher::seal(const QString& value, QByteArray& sealed)
+{
+    QByteArray data = value.toUtf8();
+    const bool ok = sealData(data, sealed);
+    data.fill('\0');
+    return ok;
+}
+
+/**
+ * Decrypt a value sealed with seal(). Recently used values are served from
+ * the plaintext cache.
+ */
+QString SessionCipher::unseal(const QByteArray& sealed)
+{
+    if (sealed.size() < NonceSize) {
+        return {};
+    }
+
+    QMutexLocker locker(&g_cacheMutex);
+    if (const QString* cached = g_cache.object(sealed)) {
+        return *cached;
+    }
+    locker.unlock();
+
+    QByteArray data = sealed.mid(NonceSize);
+    if (!processValue(sessionKey(), sealed.left(NonceSize), data)) {
+        qWarning("SessionCipher::unseal: failed to decrypt value");
+        return {};
+    }
+    const QString value = QString::fromUtf8(data);
+    data.fill('\0');
+
+    locker.relock();
+    g_cache.insert(sealed, new QString(value));
+    return value;
+}
+
+/**
+ * Encrypt arbitrary bytes under the session key, like seal().
+ *
+ * @param data plaintext bytes
+ * @param sealed nonce followed by the encrypted bytes
+ * @return true on success
+ */
+bool SessionCipher::sealData(const QByteArray& data, QByteArray& sealed)
+{
+    const QByteArray nonce = CryptoHash::hmac(data, sessionKey(), CryptoHash::Sha256).left(NonceSize);
+    QByteArray encrypted = data;
+    if (!processValue(sessionKey(), nonce, encrypted)) {
+        encrypted.fill('\0');
+        return false;
+    }
+
+    sealed = nonce + encrypted;
+    return true;
+}
+
+/**
+ * Decrypt bytes sealed with sealData(). Unlike unseal() the plaintext is not
+ * cached, the caller has to wipe it after use.
+ */
+bool SessionCipher::unsealData(const QByteArray& sealed, QByteArray& data)
+{
+    if (sealed.size() < NonceSize) {
+        return false;
+    }
+
+    data = sealed.mid(NonceSize);
+    if (!processValue(sessionKey(), sealed.left(NonceSize), data)) {
+        data.fill('\0');
+        data.clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @return size of the UTF-8 encoded plaintext of a sealed value
+ */
+int SessionCipher::plaintextSize(const QByteArray& sealed)
+{
+    return qMax(sealed.size() - NonceSize, 0);
+}
+
+/**
+ * Drop all cached plaintext values, e.g. when a database is locked.
+ */
+void SessionCipher::clearCache()
+{
+    QMutexLocker locker(&g_cacheMutex);
+    g_cache.clear();
+}
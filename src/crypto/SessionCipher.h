@@ -0,0 +1,51 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_SESSIONCIPHER_H
+#define KEEPASSXC_SESSIONCIPHER_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * Keeps sensitive values encrypted in memory under a random key that is
+ * generated once per process and never stored.
+ *
+ * Sealing is deterministic: equal values result in equal sealed data, so
+ * sealed values can still be compared and shared without decrypting them.
+ * Recently unsealed values are kept in a small plaintext cache.
+ */
+class SessionCipher
+{
+public:
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    static bool seal(const QString& value, QByteArray& sealed);
+    static QString unseal(const QByteArray& sealed);
+    static bool sealData(const QByteArray& data, QByteArray& sealed);
+    static bool unsealData(const QByteArray& sealed, QByteArray& data);
+    static int plaintextSize(const QByteArray& sealed);
+    static void clearCache();
+
+    static const int CacheSize = 64;
+
+private:
+    static const QByteArray& sessionKey();
+};
+
+#endif // KEEPASSXC_SESSIONCIPHER_H
@@ -19,6 +19,7 @@
 
 #include <QtConcurrent>
 
+#include "core/Trace.h"
 #include "crypto/argon2/argon2.h"
 #include "format/KeePass2.h"
 
@@ -156,6 +157,8 @@ QVariantMap Argon2Kdf::writeParameters()
 
 bool Argon2Kdf::transform(const QByteArray& raw, QByteArray& result) const
 {
+    TRACE_SCOPE("Argon2Kdf::transform");
+
     result.clear();
     result.resize(32);
     return transformKeyRaw(raw, seed(), version(), rounds(), memory(), parallelism(), result);
@@ -71,7 +71,7 @@ namespace
 } // namespace
 
 // bcrypt_pbkdf.cpp
-int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key, quint32 rounds);
+int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key, quint32 rounds, bool parallel = true);
 
 OpenSSHKey OpenSSHKey::generate(bool secure)
 {
@@ -15,6 +15,7 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <QtConcurrent>
 #include <QtCore>
 
 extern "C" {
@@ -57,7 +58,8 @@ extern "C" {
 static void
 bcrypt_hash(const quint8* sha2pass, const quint8* sha2salt, quint8* out)
 {
-    blf_ctx state;
+    /* keep the 4 KiB of S-boxes cache line aligned, they are hit on every round */
+    alignas(64) blf_ctx state;
     quint8 ciphertext[BCRYPT_HASHSIZE] = // "OxychromaticBlowfishSwatDynamite"
         { 0x4f, 0x78, 0x79, 0x63, 0x68, 0x72, 0x6f, 0x6d,
           0x61, 0x74, 0x69, 0x63, 0x42, 0x6c, 0x6f, 0x77,
@@ -98,75 +100,103 @@ bcrypt_hash(const quint8* sha2pass, const quint8* sha2salt, quint8* out)
     explicit_bzero(&state, sizeof(state));
 }
 
-int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key, quint32 rounds)
+/*
+ * Compute the count-th block of key material. Blocks do not depend on each
+ * other, so they can be computed concurrently.
+ */
+static void
+bcrypt_pbkdf_block(const QByteArray& sha2pass, const QByteArray& salt, quint32 count, quint32 rounds, quint8* out)
 {
     QCryptographicHash ctx(QCryptographicHash::Sha512);
-    QByteArray sha2pass;
     QByteArray sha2salt;
-    quint8 out[BCRYPT_HASHSIZE];
     quint8 tmpout[BCRYPT_HASHSIZE];
     quint8 countsalt[4];
 
+    countsalt[0] = (count >> 24) & 0xff;
+    countsalt[1] = (count >> 16) & 0xff;
+    countsalt[2] = (count >> 8) & 0xff;
+    countsalt[3] = count & 0xff;
+
+    /* first round, salt is salt */
+    ctx.addData(salt);
+    ctx.addData(reinterpret_cast<char *>(countsalt), sizeof(countsalt));
+    sha2salt = ctx.result();
+
+    bcrypt_hash(reinterpret_cast<const quint8 *>(sha2pass.constData()), reinterpret_cast<const quint8 *>(sha2salt.constData()), tmpout);
+    memcpy(out, tmpout, sizeof(tmpout));
+
+    for (quint32 i = 1; i < rounds; i++) {
+        /* subsequent rounds, salt is previous output */
+        ctx.reset();
+        ctx.addData(reinterpret_cast<char *>(tmpout), sizeof(tmpout));
+        sha2salt = ctx.result();
+        bcrypt_hash(reinterpret_cast<const quint8 *>(sha2pass.constData()), reinterpret_cast<const quint8 *>(sha2salt.constData()), tmpout);
+        for (quint32 j = 0; j < sizeof(tmpout); j++)
+            out[j] ^= tmpout[j];
+    }
+
+    /* zap */
+    explicit_bzero(tmpout, sizeof(tmpout));
+}
+
+int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key, quint32 rounds, bool parallel)
+{
+    QCryptographicHash ctx(QCryptographicHash::Sha512);
+    QByteArray sha2pass;
+
     /* nothing crazy */
     if (rounds < 1) {
         return -1;
     }
 
     if (pass.isEmpty() || salt.isEmpty() || key.isEmpty() ||
-        static_cast<quint32>(key.length()) > sizeof(out) * sizeof(out)) {
+        static_cast<quint32>(key.length()) > BCRYPT_HASHSIZE * BCRYPT_HASHSIZE) {
         return -1;
     }
 
-    quint32 stride = (key.length() + sizeof(out) - 1) / sizeof(out);
+    quint32 stride = (key.length() + BCRYPT_HASHSIZE - 1) / BCRYPT_HASHSIZE;
     quint32 amt = (key.length() + stride - 1) / stride;
 
     /* collapse password */
-    ctx.reset();
     ctx.addData(pass);
     sha2pass = ctx.result();
 
-    /* generate key, sizeof(out) at a time */
-    for (quint32 count = 1, keylen = key.length(); keylen > 0; count++) {
-        countsalt[0] = (count >> 24) & 0xff;
-        countsalt[1] = (count >> 16) & 0xff;
-        countsalt[2] = (count >> 8) & 0xff;
-        countsalt[3] = count & 0xff;
-
-        /* first round, salt is salt */
-        ctx.reset();
-        ctx.addData(salt);
-        ctx.addData(reinterpret_cast<char *>(countsalt), sizeof(countsalt));
-        sha2salt = ctx.result();
-
-        bcrypt_hash(reinterpret_cast<quint8 *>(sha2pass.data()), reinterpret_cast<quint8 *>(sha2salt.data()), tmpout);
-        memcpy(out, tmpout, sizeof(out));
-
-        for (quint32 i = 1; i < rounds; i++) {
-            /* subsequent rounds, salt is previous output */
-            ctx.reset();
-            ctx.addData(reinterpret_cast<char *>(tmpout), sizeof(tmpout));
-            sha2salt = ctx.result();
-            bcrypt_hash(reinterpret_cast<quint8 *>(sha2pass.data()), reinterpret_cast<quint8 *>(sha2salt.data()), tmpout);
-            for (quint32 j = 0; j < sizeof(out); j++)
-                out[j] ^= tmpout[j];
+    /* generate all blocks, the first one on this thread and the others on the thread pool */
+    QByteArray blocks(stride * BCRYPT_HASHSIZE, '\0');
+    quint8* out = reinterpret_cast<quint8 *>(blocks.data());
+    QList<QFuture<void>> futures;
+    for (quint32 count = 2; count <= stride; count++) {
+        quint8* block = out + (count - 1) * BCRYPT_HASHSIZE;
+        if (parallel) {
+            futures << QtConcurrent::run(bcrypt_pbkdf_block, sha2pass, salt, count, rounds, block);
+        } else {
+            bcrypt_pbkdf_block(sha2pass, salt, count, rounds, block);
         }
+    }
+    bcrypt_pbkdf_block(sha2pass, salt, 1, rounds, out);
+    for (auto& future : futures) {
+        future.waitForFinished();
+    }
 
-        /*
-         * pbkdf2 deviation: output the key material non-linearly.
-         */
+    /*
+     * pbkdf2 deviation: output the key material non-linearly.
+     */
+    for (quint32 count = 1, keylen = key.length(); keylen > 0; count++) {
+        const quint8* block = out + (count - 1) * BCRYPT_HASHSIZE;
         amt = MINIMUM(amt, keylen);
         quint32 i;
         for (i = 0; i < amt; i++) {
             int dest = i * stride + (count - 1);
             if (dest >= key.length())
                 break;
-            key.data()[dest] = out[i];
+            key.data()[dest] = block[i];
         }
         keylen -= i;
     }
 
     /* zap */
-    explicit_bzero(out, sizeof(out));
+    explicit_bzero(blocks.data(), blocks.size());
+    explicit_bzero(sha2pass.data(), sha2pass.size());
 
     return 0;
 }
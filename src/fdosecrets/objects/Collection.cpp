@@ -26,6 +26,7 @@
 #include "core/Config.h"
 #include "core/Database.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 #include "gui/DatabaseTabWidget.h"
 #include "gui/DatabaseWidget.h"
 
@@ -466,6 +467,8 @@ namespace FdoSecrets
 
     void Collection::populateContents()
     {
+        TRACE_SCOPE("Collection::populateContents");
+
         if (!m_registered) {
             return;
         }
@@ -529,7 +532,7 @@ namespace FdoSecrets
         });
 
         // Add items for existing entry
-        const auto entries = m_exposedGroup->entriesRecursive(false);
+        const auto entries = m_exposedGroup->entriesRecursive();
         for (const auto& entry : entries) {
             onEntryAdded(entry, false);
         }
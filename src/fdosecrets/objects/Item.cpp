@@ -335,20 +335,13 @@ namespace FdoSecrets
 
     QString Item::path() const
     {
-        QStringList pathComponents{m_backend->title()};
+        // strip the path of the exposed root group, which is represented by a single slash
+        const QString rootPath = collection()->exposedRootGroup()->fullPath();
+        const QString groupPath = m_backend->group()->fullPath();
+        // we should always be below the exposed root group
+        Q_ASSERT(groupPath.startsWith(rootPath));
 
-        Group* group = m_backend->group();
-        while (group && group != collection()->exposedRootGroup()) {
-            pathComponents.prepend(group->name());
-            group = group->parentGroup();
-        }
-        // we should always reach the exposed root group
-        Q_ASSERT(group);
-
-        // root group is represented by a single slash, thus adding an empty component.
-        pathComponents.prepend(QLatin1Literal(""));
-
-        return pathComponents.join('/');
+        return groupPath.mid(rootPath.size()) + QLatin1Char('/') + m_backend->title();
     }
 
     bool Item::isDeletePermanent() const
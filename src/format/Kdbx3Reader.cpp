@@ -29,6 +29,7 @@
 #include "streams/SymmetricCipherStream.h"
 
 #include <QBuffer>
+#include <QThread>
 
 bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
                                    const QByteArray& headerData,
@@ -115,6 +116,8 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
     Q_ASSERT(xmlDevice);
 
     KdbxXmlReader xmlReader(KeePass2::FILE_VERSION_3_1);
+    xmlReader.setParallelParsing(m_parallelParsing && QThread::idealThreadCount() > 1);
+    xmlReader.setLazyEntryLoading(m_lazyEntryLoading);
     xmlReader.readDatabase(xmlDevice, db, &randomStream);
 
     if (xmlReader.hasError()) {
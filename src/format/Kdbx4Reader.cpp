@@ -18,10 +18,12 @@
 #include "Kdbx4Reader.h"
 
 #include <QBuffer>
+#include <QThread>
 
 #include "core/AsyncTask.h"
 #include "core/Endian.h"
 #include "core/Group.h"
+#include "core/Trace.h"
 #include "crypto/CryptoHash.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KeePass2RandomStream.h"
@@ -35,6 +37,7 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
                                    Database* db)
 {
     Q_ASSERT(m_kdbxVersion == KeePass2::FILE_VERSION_4);
+    TRACE_SCOPE("Kdbx4Reader::readDatabase");
 
     m_binaryPool.clear();
 
@@ -48,7 +51,10 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
         return false;
     }
 
-    bool ok = AsyncTask::runAndWaitForFuture([&] { return db->setKey(key, false, false); });
+    bool ok = AsyncTask::runAndWaitForFuture([&]() -> bool {
+        TRACE_SCOPE("Kdbx4Reader::transformKey");
+        return db->setKey(key, false, false);
+    });
     if (!ok) {
         raiseError(tr("Unable to calculate database key: %1").arg(db->keyError()));
         return false;
@@ -114,7 +120,10 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
         xmlDevice = ioCompressor.data();
     }
 
-    while (readInnerHeaderField(xmlDevice) && !hasError()) {
+    {
+        TRACE_SCOPE("Kdbx4Reader::readInnerHeader");
+        while (readInnerHeaderField(xmlDevice) && !hasError()) {
+        }
     }
 
     if (hasError()) {
@@ -130,6 +139,8 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
     Q_ASSERT(xmlDevice);
 
     KdbxXmlReader xmlReader(KeePass2::FILE_VERSION_4, binaryPool());
+    xmlReader.setParallelParsing(m_parallelParsing && QThread::idealThreadCount() > 1);
+    xmlReader.setLazyEntryLoading(m_lazyEntryLoading);
     xmlReader.readDatabase(xmlDevice, db, &randomStream);
 
     if (xmlReader.hasError()) {
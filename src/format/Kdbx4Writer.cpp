@@ -23,6 +23,7 @@
 #include "core/CustomData.h"
 #include "core/Database.h"
 #include "core/Metadata.h"
+#include "core/Trace.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/Random.h"
 #include "format/KdbxXmlWriter.h"
@@ -33,6 +34,8 @@
 
 bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
 {
+    TRACE_SCOPE("Kdbx4Writer::writeDatabase");
+
     m_error = false;
     m_errorStr.clear();
 
@@ -52,7 +55,7 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     QByteArray protectedStreamKey = randomGen()->randomArray(64);
     QByteArray endOfHeader = "\r\n\r\n";
 
-    if (!db->setKey(db->key(), false, true)) {
+    if (!db->renewTransformSeed()) {
         raiseError(tr("Unable to calculate database key: %1").arg(db->keyError()));
         return false;
     }
@@ -172,7 +175,10 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     }
 
     KdbxXmlWriter xmlWriter(formatVersion());
-    xmlWriter.writeDatabase(outputDevice, db, &randomStream, headerHash);
+    {
+        TRACE_SCOPE("KdbxXmlWriter::writeDatabase");
+        xmlWriter.writeDatabase(outputDevice, db, &randomStream, headerHash);
+    }
 
     // Explicitly close/reset streams so they are flushed and we can detect
     // errors. QIODevice::close() resets errorString() etc.
@@ -218,22 +224,12 @@ bool Kdbx4Writer::writeInnerHeaderField(QIODevice* device, KeePass2::InnerHeader
 
 void Kdbx4Writer::writeAttachments(QIODevice* device, Database* db)
 {
-    const QList<Entry*> allEntries = db->rootGroup()->entriesRecursive(true);
-    QSet<QByteArray> writtenAttachments;
-
-    for (Entry* entry : allEntries) {
-        const QList<QString> attachmentKeys = entry->attachments()->keys();
-        for (const QString& key : attachmentKeys) {
-            QByteArray data("\x01");
-            data.append(entry->attachments()->value(key));
-
-            if (writtenAttachments.contains(data)) {
-                continue;
-            }
-
-            writeInnerHeaderField(device, KeePass2::InnerHeaderFieldID::Binary, data);
-            writtenAttachments.insert(data);
-        }
+    // Same order as KdbxXmlWriter assigns the binary IDs
+    const auto blobs = KdbxXmlWriter::attachmentBlobs(db);
+    for (const auto& blob : blobs) {
+        QByteArray data("\x01");
+        data.append(blob->data());
+        writeInnerHeaderField(device, KeePass2::InnerHeaderFieldID::Binary, data);
     }
 }
 
@@ -113,6 +113,34 @@ KeePass2::ProtectedStreamAlgo KdbxReader::protectedStreamAlgo() const
     return m_irsAlgo;
 }
 
+bool KdbxReader::lazyEntryLoading() const
+{
+    return m_lazyEntryLoading;
+}
+
+/**
+ * Create the entries of each group when it is first accessed instead of
+ * while reading the file, see KdbxXmlReader::setLazyEntryLoading().
+ */
+void KdbxReader::setLazyEntryLoading(bool lazyEntryLoading)
+{
+    m_lazyEntryLoading = lazyEntryLoading;
+}
+
+bool KdbxReader::parallelParsing() const
+{
+    return m_parallelParsing;
+}
+
+/**
+ * Build the entries on the thread pool while reading the file,
+ * see KdbxXmlReader::setParallelParsing().
+ */
+void KdbxReader::setParallelParsing(bool parallelParsing)
+{
+    m_parallelParsing = parallelParsing;
+}
+
 /**
  * @param data stream cipher UUID as bytes
  */
@@ -47,6 +47,11 @@ public:
 
     KeePass2::ProtectedStreamAlgo protectedStreamAlgo() const;
 
+    bool lazyEntryLoading() const;
+    void setLazyEntryLoading(bool lazyEntryLoading);
+    bool parallelParsing() const;
+    void setParallelParsing(bool parallelParsing);
+
 protected:
     /**
      * Concrete reader implementation for reading database from device.
@@ -90,6 +95,8 @@ protected:
     QByteArray m_streamStartBytes;
     QByteArray m_protectedStreamKey;
     KeePass2::ProtectedStreamAlgo m_irsAlgo = KeePass2::ProtectedStreamAlgo::InvalidProtectedStreamAlgo;
+    bool m_lazyEntryLoading = false;
+    bool m_parallelParsing = false;
 
 private:
     QPair<quint32, quint32> m_kdbxSignature;
@@ -24,10 +24,16 @@
 #include "core/Global.h"
 #include "core/Group.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
+#include "crypto/SessionCipher.h"
 #include "streams/QtIOCompressor"
 
 #include <QBuffer>
 #include <QFile>
+#include <QThread>
+#include <QtConcurrent>
+#include <QXmlStreamWriter>
+#include <functional>
 #include <utility>
 
 #define UUID_LENGTH 16
@@ -85,6 +91,8 @@ QSharedPointer<Database> KdbxXmlReader::readDatabase(QIODevice* device)
  */
 void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2RandomStream* randomStream)
 {
+    TRACE_SCOPE("KdbxXmlReader::readDatabase");
+
     m_error = false;
     m_errorStr.clear();
 
@@ -99,6 +107,9 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
     m_headerHash.clear();
 
     m_tmpParent.reset(new Group());
+    m_pendingEntries.clear();
+    m_lastTopVisibleEntries.clear();
+    m_entriesDeferred = false;
 
     bool rootGroupParsed = false;
 
@@ -133,14 +144,23 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
         qWarning("Unmapped keys left.");
     }
 
-    for (const QString& key : unusedKeys) {
-        qWarning("KdbxXmlReader::readDatabase: found unused key \"%s\"", qPrintable(key));
+    // Binaries of deferred entries are only looked up once they are loaded
+    if (!m_entriesDeferred) {
+        for (const QString& key : unusedKeys) {
+            qWarning("KdbxXmlReader::readDatabase: found unused key \"%s\"", qPrintable(key));
+        }
     }
 
+    // Hash every pooled binary once and share it between all referencing entries
+    QHash<QString, QSharedPointer<const EntryAttachments::Blob>> blobs;
     QHash<QString, QPair<Entry*, QString>>::const_iterator i;
     for (i = m_binaryMap.constBegin(); i != m_binaryMap.constEnd(); ++i) {
+        auto& blob = blobs[i.key()];
+        if (!blob) {
+            blob.reset(new EntryAttachments::Blob(m_binaryPool.value(i.key())));
+        }
         const QPair<Entry*, QString>& target = i.value();
-        target.first->attachments()->set(target.second, m_binaryPool[i.key()]);
+        target.first->attachments()->set(target.second, blob);
     }
 
     m_meta->setUpdateDatetime(true);
@@ -153,11 +173,8 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
     QHash<QUuid, Entry*>::const_iterator iEntry;
     for (iEntry = m_entries.constBegin(); iEntry != m_entries.constEnd(); ++iEntry) {
         iEntry.value()->setUpdateTimeinfo(true);
-
-        const QList<Entry*> historyItems = iEntry.value()->historyItems();
-        for (Entry* histEntry : historyItems) {
-            histEntry->setUpdateTimeinfo(true);
-        }
+        // The binaries of the history items are resolved now
+        iEntry.value()->compactHistory();
     }
 }
 
@@ -171,6 +188,37 @@ void KdbxXmlReader::setStrictMode(bool strictMode)
     m_strictMode = strictMode;
 }
 
+bool KdbxXmlReader::parallelParsing() const
+{
+    return m_parallelParsing;
+}
+
+/**
+ * Build entries on the thread pool. The XML is still read in order on the
+ * calling thread, protected values included, while creating the entries from
+ * it is done in parallel once all groups have been read.
+ */
+void KdbxXmlReader::setParallelParsing(bool parallelParsing)
+{
+    m_parallelParsing = parallelParsing;
+}
+
+bool KdbxXmlReader::lazyEntryLoading() const
+{
+    return m_lazyEntryLoading;
+}
+
+/**
+ * Keep the entries of each group as captured XML and create them when the
+ * group is first accessed, see Group::setEntryLoader(). Protected values are
+ * still decrypted while reading, the inner random stream is sequential.
+ * Ignored in strict mode, errors in entries have to be reported while reading.
+ */
+void KdbxXmlReader::setLazyEntryLoading(bool lazyEntryLoading)
+{
+    m_lazyEntryLoading = lazyEntryLoading;
+}
+
 bool KdbxXmlReader::hasError() const
 {
     return m_error || m_xml.hasError();
@@ -458,6 +506,11 @@ bool KdbxXmlReader::parseRoot()
             }
 
             Group* rootGroup = parseGroup();
+            if (m_lazyEntryLoading && !m_strictMode && !hasError()) {
+                deferPendingEntries();
+            } else {
+                buildPendingEntries();
+            }
             if (rootGroup) {
                 Group* oldRoot = m_db->rootGroup();
                 m_db->setRootGroup(rootGroup);
@@ -484,6 +537,8 @@ Group* KdbxXmlReader::parseGroup()
     group->setUpdateTimeinfo(false);
     QList<Group*> children;
     QList<Entry*> entries;
+    QList<int> pendingEntries;
+    QUuid lastTopVisibleEntry;
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
         if (m_xml.name() == "UUID") {
             QUuid uuid = readUuid();
@@ -569,7 +624,11 @@ Group* KdbxXmlReader::parseGroup()
             continue;
         }
         if (m_xml.name() == "LastTopVisibleEntry") {
-            group->setLastTopVisibleEntry(getEntry(readUuid()));
+            if (m_lazyEntryLoading) {
+                lastTopVisibleEntry = readUuid();
+            } else {
+                group->setLastTopVisibleEntry(getEntry(readUuid()));
+            }
             continue;
         }
         if (m_xml.name() == "Group") {
@@ -580,9 +639,16 @@ Group* KdbxXmlReader::parseGroup()
             continue;
         }
         if (m_xml.name() == "Entry") {
-            Entry* newEntry = parseEntry(false);
-            if (newEntry) {
-                entries.append(newEntry);
+            if (m_parallelParsing || m_lazyEntryLoading) {
+                PendingEntry pending;
+                pending.xml = captureElement();
+                pendingEntries.append(m_pendingEntries.size());
+                m_pendingEntries.append(pending);
+            } else {
+                Entry* newEntry = parseEntry();
+                if (newEntry) {
+                    entries.append(newEntry);
+                }
             }
             continue;
         }
@@ -599,11 +665,16 @@ Group* KdbxXmlReader::parseGroup()
     }
 
     if (!group->uuid().isNull()) {
-        Group* tmpGroup = group;
-        group = getGroup(tmpGroup->uuid());
-        group->copyDataFrom(tmpGroup);
-        group->setUpdateTimeinfo(false);
-        delete tmpGroup;
+        if (!m_groups.contains(group->uuid())) {
+            // Not referenced before, keep the parsed group instead of copying it into a placeholder
+            m_groups.insert(group->uuid(), group);
+        } else {
+            Group* tmpGroup = group;
+            group = getGroup(tmpGroup->uuid());
+            group->copyDataFrom(tmpGroup);
+            group->setUpdateTimeinfo(false);
+            delete tmpGroup;
+        }
     } else if (!hasError()) {
         raiseError(tr("No group uuid found"));
     }
@@ -616,6 +687,14 @@ Group* KdbxXmlReader::parseGroup()
         entry->setGroup(group);
     }
 
+    for (int index : asConst(pendingEntries)) {
+        m_pendingEntries[index].group = group;
+    }
+
+    if (!lastTopVisibleEntry.isNull()) {
+        m_lastTopVisibleEntries.insert(group, lastTopVisibleEntry);
+    }
+
     return group;
 }
 
@@ -668,14 +747,23 @@ void KdbxXmlReader::parseDeletedObject()
     }
 }
 
-Entry* KdbxXmlReader::parseEntry(bool history)
+Entry* KdbxXmlReader::parseEntry()
+{
+    return addParsedEntry(parseEntryData(false));
+}
+
+/**
+ * Read an entry and its history without touching the state shared between
+ * entries, see addParsedEntry().
+ */
+KdbxXmlReader::ParsedEntry KdbxXmlReader::parseEntryData(bool history)
 {
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "Entry");
 
+    ParsedEntry parsed;
     auto entry = new Entry();
     entry->setUpdateTimeinfo(false);
-    QList<Entry*> historyItems;
-    QList<StringPair> binaryRefs;
+    parsed.entry = entry;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
         if (m_xml.name() == "UUID") {
@@ -736,7 +824,7 @@ Entry* KdbxXmlReader::parseEntry(bool history)
         if (m_xml.name() == "Binary") {
             QPair<QString, QString> ref = parseEntryBinary(entry);
             if (!ref.first.isEmpty() && !ref.second.isEmpty()) {
-                binaryRefs.append(ref);
+                parsed.binaryRefs.append(ref);
             }
             continue;
         }
@@ -748,7 +836,7 @@ Entry* KdbxXmlReader::parseEntry(bool history)
             if (history) {
                 raiseError(tr("History element in history entry"));
             } else {
-                historyItems = parseEntryHistory();
+                parsed.historyItems = parseEntryHistory(parsed.historyBinaryRefs);
             }
             continue;
         }
@@ -763,9 +851,26 @@ Entry* KdbxXmlReader::parseEntry(bool history)
         entry->setUuid(QUuid::createUuid());
     }
 
+    if (history && entry->uuid().isNull() && !hasError()) {
+        raiseError(tr("No entry uuid found"));
+    }
+
+    return parsed;
+}
+
+/**
+ * Register a parsed entry with the reader and attach its history, this has to be
+ * done in document order.
+ */
+Entry* KdbxXmlReader::addParsedEntry(const ParsedEntry& parsed)
+{
+    Entry* entry = parsed.entry;
+
     if (!entry->uuid().isNull()) {
-        if (history) {
-            entry->setUpdateTimeinfo(false);
+        if (!m_entries.contains(entry->uuid())) {
+            // Not referenced before, keep the parsed entry instead of copying it into a placeholder.
+            // It is attached to its group by parseGroup without a detour through m_tmpParent.
+            m_entries.insert(entry->uuid(), entry);
         } else {
             Entry* tmpEntry = entry;
 
@@ -779,7 +884,7 @@ Entry* KdbxXmlReader::parseEntry(bool history)
         raiseError(tr("No entry uuid found"));
     }
 
-    for (Entry* historyItem : asConst(historyItems)) {
+    for (Entry* historyItem : asConst(parsed.historyItems)) {
         if (historyItem->uuid() != entry->uuid()) {
             if (m_strictMode) {
                 raiseError(tr("History element with different uuid"));
@@ -790,7 +895,11 @@ Entry* KdbxXmlReader::parseEntry(bool history)
         entry->addHistoryItem(historyItem);
     }
 
-    for (const StringPair& ref : asConst(binaryRefs)) {
+    for (const auto& ref : asConst(parsed.historyBinaryRefs)) {
+        m_binaryMap.insertMulti(ref.second.first, qMakePair(ref.first, ref.second.second));
+    }
+
+    for (const StringPair& ref : asConst(parsed.binaryRefs)) {
         m_binaryMap.insertMulti(ref.first, qMakePair(entry, ref.second));
     }
 
@@ -935,7 +1044,7 @@ void KdbxXmlReader::parseAutoTypeAssoc(Entry* entry)
     raiseError(tr("Auto-type association window or sequence missing"));
 }
 
-QList<Entry*> KdbxXmlReader::parseEntryHistory()
+QList<Entry*> KdbxXmlReader::parseEntryHistory(QList<QPair<Entry*, StringPair>>& binaryRefs)
 {
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "History");
 
@@ -943,7 +1052,11 @@ QList<Entry*> KdbxXmlReader::parseEntryHistory()
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
         if (m_xml.name() == "Entry") {
-            historyItems.append(parseEntry(true));
+            const ParsedEntry historyItem = parseEntryData(true);
+            historyItems.append(historyItem.entry);
+            for (const StringPair& ref : historyItem.binaryRefs) {
+                binaryRefs.append(qMakePair(historyItem.entry, ref));
+            }
         } else {
             skipCurrentElement();
         }
@@ -996,16 +1109,13 @@ QString KdbxXmlReader::readString(bool& isProtected, bool& protectInMemory)
     QString value = m_xml.readElementText();
 
     if (isProtected && !value.isEmpty()) {
-        QByteArray ciphertext = QByteArray::fromBase64(value.toLatin1());
-        bool ok;
-        QByteArray plaintext = m_randomStream->process(ciphertext, &ok);
-        if (!ok) {
+        QByteArray data = QByteArray::fromBase64(value.toLatin1());
+        if (!decryptValue(data)) {
             value.clear();
-            raiseError(m_randomStream->errorString());
             return value;
         }
 
-        value = QString::fromUtf8(plaintext);
+        value = QString::fromUtf8(data);
     }
 
     return value;
@@ -1111,16 +1221,8 @@ QByteArray KdbxXmlReader::readBinary()
     QString value = m_xml.readElementText();
     QByteArray data = QByteArray::fromBase64(value.toLatin1());
 
-    if (isProtected && !data.isEmpty()) {
-        bool ok;
-        QByteArray plaintext = m_randomStream->process(data, &ok);
-        if (!ok) {
-            data.clear();
-            raiseError(m_randomStream->errorString());
-            return data;
-        }
-
-        data = plaintext;
+    if (isProtected && !data.isEmpty() && !decryptValue(data)) {
+        data.clear();
     }
 
     return data;
@@ -1145,6 +1247,340 @@ QByteArray KdbxXmlReader::readCompressedBinary()
     return result;
 }
 
+/**
+ * Decrypt a protected value with the inner random stream.
+ */
+bool KdbxXmlReader::decryptValue(QByteArray& data)
+{
+    if (m_valuesSealed) {
+        QByteArray plaintext;
+        if (!SessionCipher::unsealData(data, plaintext)) {
+            raiseError(tr("Unable to decrypt entry string"));
+            return false;
+        }
+        data = plaintext;
+        return true;
+    }
+
+    bool ok;
+    QByteArray plaintext = m_randomStream->process(data, &ok);
+    if (!ok) {
+        raiseError(m_randomStream->errorString());
+        return false;
+    }
+
+    data = plaintext;
+    return true;
+}
+
+/**
+ * Copy the current element and its children into a standalone XML document.
+ *
+ * The inner random stream has to process protected values in document order,
+ * so they are decrypted here and sealed with the session cipher right away,
+ * to be read with m_valuesSealed set. No plaintext is kept in the capture.
+ */
+QByteArray KdbxXmlReader::captureElement()
+{
+    Q_ASSERT(m_xml.isStartElement());
+
+    // elements holding other elements, never a protected value
+    static const QStringList containers = {"Entry", "String", "Binary", "AutoType", "Association",
+                                           "History", "Times", "CustomData", "Item"};
+
+    QByteArray xml;
+    QXmlStreamWriter writer(&xml);
+    writer.writeStartElement(m_xml.name().toString());
+    writer.writeAttributes(m_xml.attributes());
+
+    int depth = 1;
+    while (depth > 0 && !m_xml.hasError()) {
+        switch (m_xml.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            const QString name = m_xml.name().toString();
+            const QXmlStreamAttributes attributes = m_xml.attributes();
+            writer.writeStartElement(name);
+            writer.writeAttributes(attributes);
+
+            if (!isTrueValue(attributes.value("Protected")) || containers.contains(name)) {
+                ++depth;
+                break;
+            }
+
+            QByteArray data = QByteArray::fromBase64(m_xml.readElementText().toLatin1());
+            QByteArray sealed;
+            if (!data.isEmpty() && decryptValue(data) && !SessionCipher::sealData(data, sealed)) {
+                raiseError(tr("Unable to decrypt entry string"));
+            }
+            data.fill('\0');
+            writer.writeCharacters(QString::fromLatin1(sealed.toBase64()));
+            writer.writeEndElement();
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            writer.writeEndElement();
+            --depth;
+            break;
+        case QXmlStreamReader::Characters: {
+            // Written as references, a literal carriage return would be read back as a line feed
+            const QStringList lines = m_xml.text().toString().split('\r');
+            for (int i = 0; i < lines.size(); ++i) {
+                if (i > 0) {
+                    writer.writeEntityReference("#13");
+                }
+                writer.writeCharacters(lines.at(i));
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return xml;
+}
+
+/**
+ * Build the entries captured by parseGroup() on the thread pool, then attach
+ * them to their groups in document order.
+ */
+void KdbxXmlReader::buildPendingEntries()
+{
+    // Resolved before the entries are added, like when they are read in order
+    QHash<Group*, QUuid>::const_iterator i;
+    for (i = m_lastTopVisibleEntries.constBegin(); i != m_lastTopVisibleEntries.constEnd(); ++i) {
+        i.key()->setLastTopVisibleEntry(getEntry(i.value()));
+    }
+    m_lastTopVisibleEntries.clear();
+
+    if (m_pendingEntries.isEmpty()) {
+        return;
+    }
+
+    TRACE_SCOPE("KdbxXmlReader::buildPendingEntries");
+
+    QThread* thread = QThread::currentThread();
+    const quint32 version = m_kdbxVersion;
+    const bool strictMode = m_strictMode;
+    std::function<void(PendingEntry&)> build = [thread, version, strictMode](PendingEntry& pending) {
+        KdbxXmlReader reader(version);
+        reader.setStrictMode(strictMode);
+        reader.m_valuesSealed = true;
+        reader.m_xml.addData(pending.xml);
+        if (reader.m_xml.readNextStartElement()) {
+            pending.parsed = reader.parseEntryData(false);
+        }
+        if (reader.hasError()) {
+            pending.error = reader.errorString();
+        }
+        pending.xml.fill('\0');
+        pending.xml.clear();
+
+        // Objects may only be moved away from the thread they live in
+        if (pending.parsed.entry) {
+            pending.parsed.entry->moveToThread(thread);
+        }
+        for (Entry* historyItem : asConst(pending.parsed.historyItems)) {
+            historyItem->moveToThread(thread);
+        }
+    };
+    QtConcurrent::blockingMap(m_pendingEntries, build);
+
+    for (const PendingEntry& pending : asConst(m_pendingEntries)) {
+        if (!pending.error.isEmpty()) {
+            raiseError(pending.error);
+        }
+        if (pending.parsed.entry) {
+            Entry* entry = addParsedEntry(pending.parsed);
+            entry->setGroup(pending.group);
+        }
+    }
+    m_pendingEntries.clear();
+}
+
+/**
+ * Hand the entries captured by parseGroup() to their groups to be created on
+ * first access. They are built right away instead if an entry uuid occurs
+ * twice, the duplicates have to be resolved in document order.
+ */
+void KdbxXmlReader::deferPendingEntries()
+{
+    TRACE_SCOPE("KdbxXmlReader::deferPendingEntries");
+
+    // Deleted objects and the username index of a group that is not loaded use these
+    struct DeferredGroup
+    {
+        QSharedPointer<DeferredEntries> entries;
+        QList<QUuid> uuids;
+        QStringList usernames;
+    };
+
+    auto binaries = QSharedPointer<DeferredBinaries>::create();
+    binaries->pool = m_binaryPool;
+
+    QSet<QUuid> uuids;
+    QHash<Group*, DeferredGroup> groups;
+    for (const PendingEntry& pending : asConst(m_pendingEntries)) {
+        QString username;
+        const QUuid uuid = readCapturedEntry(pending.xml, username);
+        // A missing uuid is generated when the entry is created, it has to be the same every time
+        if (uuid.isNull() || m_entries.contains(uuid) || uuids.contains(uuid)) {
+            qWarning("KdbxXmlReader::deferPendingEntries: missing or duplicate entry uuid, reading all entries now");
+            buildPendingEntries();
+            return;
+        }
+        uuids.insert(uuid);
+
+        DeferredGroup& deferred = groups[pending.group];
+        if (!deferred.entries) {
+            deferred.entries = QSharedPointer<DeferredEntries>::create();
+            deferred.entries->version = m_kdbxVersion;
+            deferred.entries->binaries = binaries;
+        }
+        deferred.entries->xml.append(pending.xml);
+        deferred.uuids.append(uuid);
+        if (!username.isEmpty()) {
+            deferred.usernames.append(username);
+        }
+    }
+    m_pendingEntries.clear();
+
+    QHash<Group*, QUuid>::const_iterator i;
+    for (i = m_lastTopVisibleEntries.constBegin(); i != m_lastTopVisibleEntries.constEnd(); ++i) {
+        if (uuids.contains(i.value())) {
+            i.key()->setPendingLastTopVisibleEntry(i.value());
+        } else {
+            i.key()->setLastTopVisibleEntry(getEntry(i.value()));
+        }
+    }
+    m_lastTopVisibleEntries.clear();
+
+    QHash<Group*, DeferredGroup>::const_iterator iGroup;
+    for (iGroup = groups.constBegin(); iGroup != groups.constEnd(); ++iGroup) {
+        const QSharedPointer<DeferredEntries> deferred = iGroup.value().entries;
+        iGroup.key()->setEntryLoader(
+            [deferred]() { return buildDeferredEntries(*deferred); }, iGroup.value().uuids, iGroup.value().usernames);
+    }
+    m_entriesDeferred = !groups.isEmpty();
+}
+
+/**
+ * Read what a group needs to know about an entry captured by captureElement()
+ * before it is loaded, see Group::setEntryLoader().
+ *
+ * @param xml captured entry
+ * @param username set to the username, empty if it is a reference
+ * @return uuid of the entry
+ */
+QUuid KdbxXmlReader::readCapturedEntry(const QByteArray& xml, QString& username)
+{
+    username.clear();
+
+    KdbxXmlReader reader(m_kdbxVersion);
+    reader.m_valuesSealed = true;
+    reader.m_xml.addData(xml);
+    if (!reader.m_xml.readNextStartElement()) {
+        return {};
+    }
+
+    QUuid uuid;
+    while (!reader.hasError() && reader.m_xml.readNextStartElement()) {
+        if (reader.m_xml.name() == "UUID") {
+            uuid = reader.readUuid();
+        } else if (reader.m_xml.name() == "String") {
+            QString key;
+            while (!reader.hasError() && reader.m_xml.readNextStartElement()) {
+                if (reader.m_xml.name() == "Key") {
+                    key = reader.readString();
+                } else if (reader.m_xml.name() == "Value" && key == EntryAttributes::UserNameKey) {
+                    bool isProtected;
+                    bool protectInMemory;
+                    username = reader.readString(isProtected, protectInMemory);
+                } else {
+                    reader.m_xml.skipCurrentElement();
+                }
+            }
+        } else {
+            reader.m_xml.skipCurrentElement();
+        }
+    }
+
+    if (EntryAttributes::matchReference(username).hasMatch()) {
+        username.clear();
+    }
+    return uuid;
+}
+
+/**
+ * Create the entries of a lazily read group with their history and
+ * attachments, like readDatabase() does for the other entries. The captured
+ * XML is kept, the entries are built again for every call.
+ */
+QList<Entry*> KdbxXmlReader::buildDeferredEntries(const DeferredEntries& deferred)
+{
+    TRACE_SCOPE("KdbxXmlReader::buildDeferredEntries");
+
+    QList<Entry*> entries;
+    for (const QByteArray& xml : deferred.xml) {
+        KdbxXmlReader reader(deferred.version);
+        reader.m_valuesSealed = true;
+        reader.m_xml.addData(xml);
+        ParsedEntry parsed;
+        if (reader.m_xml.readNextStartElement()) {
+            parsed = reader.parseEntryData(false);
+        }
+
+        // The file was read successfully already, keep what could be parsed
+        if (reader.hasError()) {
+            qWarning("KdbxXmlReader::buildDeferredEntries: %s", qPrintable(reader.errorString()));
+        }
+
+        Entry* entry = parsed.entry;
+        if (!entry) {
+            continue;
+        }
+
+        for (Entry* historyItem : asConst(parsed.historyItems)) {
+            if (historyItem->uuid() != entry->uuid()) {
+                historyItem->setUuid(entry->uuid());
+            }
+            entry->addHistoryItem(historyItem);
+        }
+
+        for (const StringPair& ref : asConst(parsed.binaryRefs)) {
+            entry->attachments()->set(ref.second, deferred.binaries->blob(ref.first));
+        }
+        for (const auto& ref : asConst(parsed.historyBinaryRefs)) {
+            ref.first->attachments()->set(ref.second.second, deferred.binaries->blob(ref.second.first));
+        }
+        entry->compactHistory();
+
+        entries.append(entry);
+    }
+
+    return entries;
+}
+
+/**
+ * Hash each pooled binary once and share it between all referencing entries.
+ */
+QSharedPointer<const EntryAttachments::Blob> KdbxXmlReader::DeferredBinaries::blob(const QString& key)
+{
+    QMutexLocker locker(&mutex);
+    QSharedPointer<const EntryAttachments::Blob>& blob = blobs[key];
+    if (!blob) {
+        blob.reset(new EntryAttachments::Blob(pool.value(key)));
+    }
+    return blob;
+}
+
+KdbxXmlReader::DeferredEntries::~DeferredEntries()
+{
+    for (QByteArray& data : xml) {
+        data.fill('\0');
+    }
+}
+
 Group* KdbxXmlReader::getGroup(const QUuid& uuid)
 {
     if (uuid.isNull()) {
@@ -19,12 +19,15 @@
 #define KEEPASSXC_KDBXXMLREADER_H
 
 #include "core/Database.h"
+#include "core/EntryAttachments.h"
 #include "core/Metadata.h"
 #include "core/TimeInfo.h"
 
 #include <QCoreApplication>
+#include <QMutex>
 #include <QPair>
 #include <QString>
+#include <QVector>
 #include <QXmlStreamReader>
 
 class QIODevice;
@@ -55,10 +58,52 @@ public:
 
     bool strictMode() const;
     void setStrictMode(bool strictMode);
+    bool parallelParsing() const;
+    void setParallelParsing(bool parallelParsing);
+    bool lazyEntryLoading() const;
+    void setLazyEntryLoading(bool lazyEntryLoading);
 
 protected:
     typedef QPair<QString, QString> StringPair;
 
+    struct ParsedEntry
+    {
+        Entry* entry = nullptr;
+        QList<Entry*> historyItems;
+        // references into the binary pool: pool id and attachment name
+        QList<StringPair> binaryRefs;
+        QList<QPair<Entry*, StringPair>> historyBinaryRefs;
+    };
+
+    struct PendingEntry
+    {
+        QByteArray xml;
+        Group* group = nullptr;
+        ParsedEntry parsed;
+        QString error;
+    };
+
+    // binary pool shared by all lazily read groups of a database
+    struct DeferredBinaries
+    {
+        QHash<QString, QByteArray> pool;
+        QHash<QString, QSharedPointer<const EntryAttachments::Blob>> blobs;
+        // entries are built on the thread that loads or saves them
+        QMutex mutex;
+
+        QSharedPointer<const EntryAttachments::Blob> blob(const QString& key);
+    };
+
+    // captured entries of one group, created by buildDeferredEntries() on first access and on save
+    struct DeferredEntries
+    {
+        ~DeferredEntries();
+
+        quint32 version = 0;
+        QSharedPointer<DeferredBinaries> binaries;
+        QVector<QByteArray> xml;
+    };
+
     virtual bool parseKeePassFile();
     virtual void parseMeta();
     virtual void parseMemoryProtection();
@@ -71,12 +116,14 @@ protected:
     virtual Group* parseGroup();
     virtual void parseDeletedObjects();
     virtual void parseDeletedObject();
-    virtual Entry* parseEntry(bool history);
+    virtual Entry* parseEntry();
+    virtual ParsedEntry parseEntryData(bool history);
+    virtual Entry* addParsedEntry(const ParsedEntry& parsed);
     virtual void parseEntryString(Entry* entry);
     virtual QPair<QString, QString> parseEntryBinary(Entry* entry);
     virtual void parseAutoType(Entry* entry);
     virtual void parseAutoTypeAssoc(Entry* entry);
-    virtual QList<Entry*> parseEntryHistory();
+    virtual QList<Entry*> parseEntryHistory(QList<QPair<Entry*, StringPair>>& binaryRefs);
     virtual TimeInfo parseTimes();
 
     virtual QString readString();
@@ -88,6 +135,13 @@ protected:
     virtual QUuid readUuid();
     virtual QByteArray readBinary();
     virtual QByteArray readCompressedBinary();
+    virtual bool decryptValue(QByteArray& data);
+
+    virtual QByteArray captureElement();
+    virtual void buildPendingEntries();
+    virtual void deferPendingEntries();
+    virtual QUuid readCapturedEntry(const QByteArray& xml, QString& username);
+    static QList<Entry*> buildDeferredEntries(const DeferredEntries& deferred);
 
     virtual void skipCurrentElement();
 
@@ -100,6 +154,12 @@ protected:
     const quint32 m_kdbxVersion;
 
     bool m_strictMode = false;
+    bool m_parallelParsing = false;
+    bool m_lazyEntryLoading = false;
+    // entries were handed to their groups with Group::setEntryLoader()
+    bool m_entriesDeferred = false;
+    // protected values were sealed by captureElement() already
+    bool m_valuesSealed = false;
 
     QPointer<Database> m_db;
     QPointer<Metadata> m_meta;
@@ -109,6 +169,9 @@ protected:
     QScopedPointer<Group> m_tmpParent;
     QHash<QUuid, Group*> m_groups;
     QHash<QUuid, Entry*> m_entries;
+    QVector<PendingEntry> m_pendingEntries;
+    // LastTopVisibleEntry of each group, resolved after all entries were captured in lazy mode
+    QHash<Group*, QUuid> m_lastTopVisibleEntries;
 
     QHash<QString, QByteArray> m_binaryPool;
     QHash<QString, QPair<Entry*, QString>> m_binaryMap;
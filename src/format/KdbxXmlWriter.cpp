@@ -81,19 +81,51 @@ QString KdbxXmlWriter::errorString()
     return m_errorStr;
 }
 
-void KdbxXmlWriter::generateIdMap()
+/**
+ * Collect the distinct attachment blobs of all entries and their history
+ * items in the order of their binary IDs. History items are not built and
+ * deferred entries are not loaded, see Group::streamEntries().
+ *
+ * @param db source database
+ * @return blobs deduplicated by digest
+ */
+QList<QSharedPointer<const EntryAttachments::Blob>> KdbxXmlWriter::attachmentBlobs(const Database* db)
 {
-    const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive(true);
-    int nextId = 0;
+    QList<QSharedPointer<const EntryAttachments::Blob>> blobs;
+    QSet<QByteArray> digests;
 
-    for (Entry* entry : allEntries) {
-        const QList<QString> attachmentKeys = entry->attachments()->keys();
+    auto addAttachments = [&blobs, &digests](const EntryAttachments* attachments) -> bool {
+        const QList<QString> attachmentKeys = attachments->keys();
         for (const QString& key : attachmentKeys) {
-            QByteArray data = entry->attachments()->value(key);
-            if (!m_idMap.contains(data)) {
-                m_idMap.insert(data, nextId++);
+            const auto blob = attachments->blob(key);
+            if (!digests.contains(blob->digest())) {
+                digests.insert(blob->digest());
+                blobs.append(blob);
             }
         }
+        return false;
+    };
+
+    db->rootGroup()->walkGroups([&addAttachments](const Group* group) -> bool {
+        group->streamEntries([&addAttachments](const Entry* entry) -> bool {
+            addAttachments(entry->attachments());
+            entry->walkHistoryAttachments(addAttachments);
+            return false;
+        });
+        return false;
+    });
+
+    return blobs;
+}
+
+void KdbxXmlWriter::generateIdMap()
+{
+    int nextId = 0;
+
+    const auto blobs = attachmentBlobs(m_db);
+    for (const auto& blob : blobs) {
+        m_idMap.insert(blob->digest(), nextId++);
+        m_binaries.append(blob->data());
     }
 }
 
@@ -183,11 +215,11 @@ void KdbxXmlWriter::writeBinaries()
 {
     m_xml.writeStartElement("Binaries");
 
-    QHash<QByteArray, int>::const_iterator i;
-    for (i = m_idMap.constBegin(); i != m_idMap.constEnd(); ++i) {
+    for (int id = 0; id < m_binaries.size(); ++id) {
+        const QByteArray& binary = m_binaries.at(id);
         m_xml.writeStartElement("Binary");
 
-        m_xml.writeAttribute("ID", QString::number(i.value()));
+        m_xml.writeAttribute("ID", QString::number(id));
 
         QByteArray data;
         if (m_db->compressionAlgorithm() == Database::CompressionGZip) {
@@ -200,15 +232,15 @@ void KdbxXmlWriter::writeBinaries()
             compressor.setStreamFormat(QtIOCompressor::GzipFormat);
             compressor.open(QIODevice::WriteOnly);
 
-            qint64 bytesWritten = compressor.write(i.key());
-            Q_ASSERT(bytesWritten == i.key().size());
+            qint64 bytesWritten = compressor.write(binary);
+            Q_ASSERT(bytesWritten == binary.size());
             Q_UNUSED(bytesWritten);
             compressor.close();
 
             buffer.seek(0);
             data = buffer.readAll();
         } else {
-            data = i.key();
+            data = binary;
         }
 
         if (!data.isEmpty()) {
@@ -279,16 +311,17 @@ void KdbxXmlWriter::writeGroup(const Group* group)
 
     writeTriState("EnableSearching", group->searchingEnabled());
 
-    writeUuid("LastTopVisibleEntry", group->lastTopVisibleEntry());
+    writeUuid("LastTopVisibleEntry", group->lastTopVisibleEntryUuid());
 
     if (m_kdbxVersion >= KeePass2::FILE_VERSION_4) {
         writeCustomData(group->customData());
     }
 
-    const QList<Entry*>& entryList = group->entries();
-    for (const Entry* entry : entryList) {
+    // Entries that were not accessed yet are written without loading them
+    group->streamEntries([this](const Entry* entry) -> bool {
         writeEntry(entry);
-    }
+        return false;
+    });
 
     const QList<Group*>& children = group->children();
     for (const Group* child : children) {
@@ -402,7 +435,7 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
         writeString("Key", key);
 
         m_xml.writeStartElement("Value");
-        m_xml.writeAttribute("Ref", QString::number(m_idMap[entry->attachments()->value(key)]));
+        m_xml.writeAttribute("Ref", QString::number(m_idMap.value(entry->attachments()->digest(key))));
         m_xml.writeEndElement();
 
         m_xml.writeEndElement();
@@ -452,10 +485,10 @@ void KdbxXmlWriter::writeEntryHistory(const Entry* entry)
 {
     m_xml.writeStartElement("History");
 
-    const QList<Entry*>& historyItems = entry->historyItems();
-    for (const Entry* item : historyItems) {
+    entry->walkHistoryItems([this](const Entry* item) -> bool {
         writeEntry(item);
-    }
+        return false;
+    });
 
     m_xml.writeEndElement();
 }
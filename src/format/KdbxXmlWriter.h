@@ -45,6 +45,8 @@ public:
     bool hasError();
     QString errorString();
 
+    static QList<QSharedPointer<const EntryAttachments::Blob>> attachmentBlobs(const Database* db);
+
 private:
     void generateIdMap();
 
@@ -87,7 +89,9 @@ private:
     QPointer<const Database> m_db;
     QPointer<const Metadata> m_meta;
     KeePass2RandomStream* m_randomStream = nullptr;
+    // Attachment digest to binary pool ID
     QHash<QByteArray, int> m_idMap;
+    QList<QByteArray> m_binaries;
     QByteArray m_headerHash;
 
     bool m_error = false;
@@ -95,6 +95,8 @@ bool KeePass2Reader::readDatabase(QIODevice* device, QSharedPointer<const Compos
     } else {
         m_reader.reset(new Kdbx4Reader());
     }
+    m_reader->setLazyEntryLoading(m_lazyEntryLoading);
+    m_reader->setParallelParsing(m_parallelParsing);
 
     return m_reader->readDatabase(device, std::move(key), db);
 }
@@ -117,6 +119,34 @@ quint32 KeePass2Reader::version() const
     return m_version;
 }
 
+bool KeePass2Reader::lazyEntryLoading() const
+{
+    return m_lazyEntryLoading;
+}
+
+/**
+ * Create the entries of each group when it is first accessed instead of
+ * while reading the file. Off by default.
+ */
+void KeePass2Reader::setLazyEntryLoading(bool lazyEntryLoading)
+{
+    m_lazyEntryLoading = lazyEntryLoading;
+}
+
+bool KeePass2Reader::parallelParsing() const
+{
+    return m_parallelParsing;
+}
+
+/**
+ * Build the entries on the thread pool while reading the file.
+ * Off by default, only used when more than one core is available.
+ */
+void KeePass2Reader::setParallelParsing(bool parallelParsing)
+{
+    m_parallelParsing = parallelParsing;
+}
+
 /**
  * @return KDBX reader used for reading the input file
  */
@@ -44,6 +44,11 @@ public:
     QSharedPointer<KdbxReader> reader() const;
     quint32 version() const;
 
+    bool lazyEntryLoading() const;
+    void setLazyEntryLoading(bool lazyEntryLoading);
+    bool parallelParsing() const;
+    void setParallelParsing(bool parallelParsing);
+
 private:
     void raiseError(const QString& errorMessage);
 
@@ -52,6 +57,8 @@ private:
 
     QSharedPointer<KdbxReader> m_reader;
     quint32 m_version = 0;
+    bool m_lazyEntryLoading = false;
+    bool m_parallelParsing = false;
 };
 
 #endif // KEEPASSX_KEEPASS2READER_H
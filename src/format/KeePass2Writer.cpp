@@ -56,25 +56,22 @@ bool KeePass2Writer::implicitUpgradeNeeded(Database const* db) const
         return true;
     }
 
-    for (const auto& group : db->rootGroup()->groupsRecursive(true)) {
+    return db->rootGroup()->walkGroups([](const Group* group) -> bool {
         if (group->customData() && !group->customData()->isEmpty()) {
             return true;
         }
 
-        for (const auto& entry : group->entries()) {
+        // Entries that were not accessed yet are checked without loading them
+        return group->streamEntries([](const Entry* entry) -> bool {
             if (entry->customData() && !entry->customData()->isEmpty()) {
                 return true;
             }
 
-            for (const auto& historyItem : entry->historyItems()) {
-                if (historyItem->customData() && !historyItem->customData()->isEmpty()) {
-                    return true;
-                }
-            }
-        }
-    }
-
-    return false;
+            return entry->walkHistoryCustomData([](const CustomData* customData) -> bool {
+                return customData && !customData->isEmpty();
+            });
+        });
+    });
 }
 
 /**
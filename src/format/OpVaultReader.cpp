@@ -18,6 +18,7 @@
 #include "OpVaultReader.h"
 #include "OpData01.h"
 
+#include "core/AsyncTask.h"
 #include "core/Group.h"
 #include "core/Tools.h"
 #include "crypto/CryptoHash.h"
@@ -28,6 +29,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QUuid>
+#include <functional>
 #include <gcrypt.h>
 
 OpVaultReader::OpVaultReader(QObject* parent)
@@ -109,13 +111,26 @@ Database* OpVaultReader::readDatabase(QDir& opdataDir, const QString& password)
 
     const QString bandChars("0123456789ABCDEF");
     QString bandPattern("band_%1.js");
+    QStringList bandPaths;
     for (QChar ch : bandChars) {
-        QFile bandFile(defaultDir.filePath(bandPattern.arg(ch)));
-        if (!bandFile.exists()) {
-            continue;
+        const QString bandPath = defaultDir.filePath(bandPattern.arg(ch));
+        if (QFile::exists(bandPath)) {
+            bandPaths << bandPath;
         }
+    }
+
+    // Bands and the items in them are independent, parse and decrypt them on the thread pool
+    // and only build the entries on this thread
+    std::function<QJsonObject(const QString&)> readBand = [this](const QString& bandPath) {
         // https://support.1password.com/opvault-design/#band-files
-        QJsonObject bandJs = readAndAssertJsonFile(bandFile, "ld(", ");");
+        QFile bandFile(bandPath);
+        return readAndAssertJsonFile(bandFile, "ld(", ");");
+    };
+    const QList<QJsonObject> bands = AsyncTask::runAndWaitForFuture(
+        [&bandPaths, &readBand] { return QtConcurrent::blockingMapped<QList<QJsonObject>>(bandPaths, readBand); });
+
+    QList<QJsonObject> bandEntries;
+    for (const QJsonObject& bandJs : bands) {
         const QStringList keys = bandJs.keys();
         for (const QString& entryKey : keys) {
             const QJsonObject bandEnt = bandJs[entryKey].toObject();
@@ -137,11 +152,22 @@ Database* OpVaultReader::readDatabase(QDir& opdataDir, const QString& password)
             if (!ok) {
                 continue;
             }
-            // https://support.1password.com/opvault-design/#items
-            auto entry = processBandEntry(bandEnt, defaultDir, rootGroup);
-            if (!entry) {
-                qWarning() << "Unable to process Band Entry " << uuid;
-            }
+            bandEntries << bandEnt;
+        }
+    }
+
+    std::function<BandItem(const QJsonObject&)> decryptItem = [this](const QJsonObject& bandEntry) {
+        return decryptBandItem(bandEntry);
+    };
+    const QList<BandItem> items = AsyncTask::runAndWaitForFuture([&bandEntries, &decryptItem] {
+        return QtConcurrent::blockingMapped<QList<BandItem>>(bandEntries, decryptItem);
+    });
+
+    for (const BandItem& item : items) {
+        // https://support.1password.com/opvault-design/#items
+        auto entry = processBandEntry(item, defaultDir, rootGroup);
+        if (!entry) {
+            qWarning() << "Unable to process Band Entry " << item.bandEntry.value("uuid").toString();
         }
     }
 
@@ -295,7 +321,8 @@ bool OpVaultReader::processFolderJson(QJsonObject& foldersJson, Group* rootGroup
  * @param stripTrailing the trailing characters that might be present in file which should be removed
  * @return
  */
-QJsonObject OpVaultReader::readAndAssertJsonFile(QFile& file, const QString& stripLeading, const QString& stripTrailing)
+QJsonObject
+OpVaultReader::readAndAssertJsonFile(QFile& file, const QString& stripLeading, const QString& stripTrailing) const
 {
     QByteArray filePayload;
     const QFileInfo& fileInfo = QFileInfo(file);
@@ -19,6 +19,7 @@
 #define OPVAULT_READER_H_
 
 #include <QDir>
+#include <QJsonObject>
 
 #include "core/Database.h"
 #include "core/Metadata.h"
@@ -52,7 +53,18 @@ private:
         QString errorStr;
     };
 
-    QJsonObject readAndAssertJsonFile(QFile& file, const QString& stripLeading, const QString& stripTrailing);
+    /*! Decrypted contents of a band item, see decryptBandItem(). */
+    struct BandItem
+    {
+        QJsonObject bandEntry;
+        QJsonObject overview;
+        QJsonObject data;
+        QByteArray key;
+        QByteArray hmacKey;
+        bool valid;
+    };
+
+    QJsonObject readAndAssertJsonFile(QFile& file, const QString& stripLeading, const QString& stripTrailing) const;
 
     DerivedKeyHMAC* deriveKeysFromPassPhrase(QByteArray& salt, const QString& password, unsigned long iterations);
     DerivedKeyHMAC* decodeB64CompositeKeys(const QString& b64, const QByteArray& encKey, const QByteArray& hmacKey);
@@ -78,8 +90,15 @@ private:
      * which are used to decrypt the attachments, also.
      * @returns \c nullptr if unable to do the decryption, otherwise the interior object and its keys
      */
-    bool decryptBandEntry(const QJsonObject& bandEntry, QJsonObject& data, QByteArray& key, QByteArray& hmacKey);
-    Entry* processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir, Group* rootGroup);
+    bool decryptBandEntry(const QJsonObject& bandEntry, QJsonObject& data, QByteArray& key, QByteArray& hmacKey) const;
+    bool decryptOverview(const QJsonObject& bandEntry, QJsonObject& overview) const;
+
+    /*!
+     * Decrypts the overview and the details of a band item. Only reads the vault keys,
+     * so it is safe to call for several items concurrently.
+     */
+    BandItem decryptBandItem(const QJsonObject& bandEntry) const;
+    Entry* processBandEntry(const BandItem& item, const QDir& attachmentDir, Group* rootGroup);
 
     bool readAttachment(const QString& filePath,
                         const QByteArray& itemKey,
@@ -95,7 +114,7 @@ private:
                          const QByteArray& entryKey,
                          const QByteArray& entryHmacKey);
 
-    bool fillAttributes(Entry* entry, const QJsonObject& bandEntry);
+    void fillAttributes(Entry* entry, const QJsonObject& overviewJson);
 
     void fillFromSection(Entry* entry, const QJsonObject& section);
     void fillFromSectionField(Entry* entry, const QString& sectionName, QJsonObject& field);
@@ -33,7 +33,7 @@
 bool OpVaultReader::decryptBandEntry(const QJsonObject& bandEntry,
                                      QJsonObject& data,
                                      QByteArray& key,
-                                     QByteArray& hmacKey)
+                                     QByteArray& hmacKey) const
 {
     if (!bandEntry.contains("d")) {
         qWarning() << "Band entries must contain a \"d\" key: " << bandEntry.keys();
@@ -105,8 +105,33 @@ bool OpVaultReader::decryptBandEntry(const QJsonObject& bandEntry,
     return true;
 }
 
-Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir, Group* rootGroup)
+bool OpVaultReader::decryptOverview(const QJsonObject& bandEntry, QJsonObject& overview) const
 {
+    const QString overviewStr = bandEntry.value("o").toString();
+    OpData01 entOver01;
+    if (!entOver01.decodeBase64(overviewStr, m_overviewKey, m_overviewHmacKey)) {
+        qCritical() << "Unable to decipher 'o' in UUID \"" << bandEntry.value("uuid").toString() << "\"\n"
+                    << ": " << entOver01.errorString();
+        return false;
+    }
+
+    auto overviewJsonBytes = entOver01.getClearText();
+    overview = QJsonDocument::fromJson(overviewJsonBytes).object();
+    return true;
+}
+
+OpVaultReader::BandItem OpVaultReader::decryptBandItem(const QJsonObject& bandEntry) const
+{
+    BandItem item;
+    item.bandEntry = bandEntry;
+    item.valid = decryptOverview(bandEntry, item.overview)
+                 && decryptBandEntry(bandEntry, item.data, item.key, item.hmacKey);
+    return item;
+}
+
+Entry* OpVaultReader::processBandEntry(const BandItem& item, const QDir& attachmentDir, Group* rootGroup)
+{
+    const QJsonObject& bandEntry = item.bandEntry;
     const QString uuid = bandEntry.value("uuid").toString();
     if (!(uuid.size() == 32 || uuid.size() == 36)) {
         qWarning() << QString("Skipping suspicious band UUID <<%1>> with length %2").arg(uuid).arg(uuid.size());
@@ -166,17 +191,13 @@ Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir&
     }
     entry->setUuid(Tools::hexToUuid(uuid));
 
-    if (!fillAttributes(entry.data(), bandEntry)) {
+    if (!item.valid) {
         return nullptr;
     }
 
-    QJsonObject data;
-    QByteArray entryKey;
-    QByteArray entryHmacKey;
+    fillAttributes(entry.data(), item.overview);
 
-    if (!decryptBandEntry(bandEntry, data, entryKey, entryHmacKey)) {
-        return nullptr;
-    }
+    const QJsonObject& data = item.data;
 
     if (data.contains("notesPlain")) {
         entry->setNotes(data.value("notesPlain").toString());
@@ -214,24 +235,12 @@ Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir&
         fillFromSection(entry.data(), section);
     }
 
-    fillAttachments(entry.data(), attachmentDir, entryKey, entryHmacKey);
+    fillAttachments(entry.data(), attachmentDir, item.key, item.hmacKey);
     return entry.take();
 }
 
-bool OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& bandEntry)
+void OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& overviewJson)
 {
-    const QString overviewStr = bandEntry.value("o").toString();
-    OpData01 entOver01;
-    if (!entOver01.decodeBase64(overviewStr, m_overviewKey, m_overviewHmacKey)) {
-        qCritical() << "Unable to decipher 'o' in UUID \"" << entry->uuid() << "\"\n"
-                    << ": " << entOver01.errorString();
-        return false;
-    }
-
-    auto overviewJsonBytes = entOver01.getClearText();
-    auto overviewDoc = QJsonDocument::fromJson(overviewJsonBytes);
-    auto overviewJson = overviewDoc.object();
-
     QString title = overviewJson.value("title").toString();
     entry->setTitle(title);
 
@@ -258,6 +267,4 @@ bool OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& bandEntry)
         }
     }
     entry->setTags(tagsList.join(','));
-
-    return true;
 }
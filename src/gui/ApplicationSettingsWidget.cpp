@@ -27,6 +27,7 @@
 #include "core/Global.h"
 #include "core/Resources.h"
 #include "core/Translator.h"
+#include "crypto/SessionCipher.h"
 #include "gui/MainWindow.h"
 #include "gui/osutils/OSUtils.h"
 
@@ -280,6 +281,8 @@ void ApplicationSettingsWidget::loadSettings()
     m_secUi->passwordsRepeatVisibleCheckBox->setChecked(
         config()->get(Config::Security_PasswordsRepeatVisible).toBool());
     m_secUi->hideNotesCheckBox->setChecked(config()->get(Config::Security_HideNotes).toBool());
+    m_secUi->encryptProtectedValuesCheckBox->setChecked(
+        config()->get(Config::Security_EncryptProtectedValues).toBool());
 
     m_secUi->touchIDResetCheckBox->setChecked(config()->get(Config::Security_ResetTouchId).toBool());
     m_secUi->touchIDResetSpinBox->setValue(config()->get(Config::Security_ResetTouchIdTimeout).toInt());
@@ -379,6 +382,8 @@ void ApplicationSettingsWidget::saveSettings()
     config()->set(Config::Security_HidePasswordPreviewPanel, m_secUi->passwordPreviewCleartextCheckBox->isChecked());
     config()->set(Config::Security_PasswordsRepeatVisible, m_secUi->passwordsRepeatVisibleCheckBox->isChecked());
     config()->set(Config::Security_HideNotes, m_secUi->hideNotesCheckBox->isChecked());
+    config()->set(Config::Security_EncryptProtectedValues, m_secUi->encryptProtectedValuesCheckBox->isChecked());
+    SessionCipher::setEnabled(config()->get(Config::Security_EncryptProtectedValues).toBool());
 
     config()->set(Config::Security_ResetTouchId, m_secUi->touchIDResetCheckBox->isChecked());
     config()->set(Config::Security_ResetTouchIdTimeout, m_secUi->touchIDResetSpinBox->value());
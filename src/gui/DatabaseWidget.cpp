@@ -560,13 +560,16 @@ void DatabaseWidget::deleteEntries(QList<Entry*> selectedEntries)
         it++;
     }
 
-    if (permanent) {
-        for (auto* entry : asConst(selectedEntries)) {
-            delete entry;
-        }
-    } else {
-        for (auto* entry : asConst(selectedEntries)) {
-            m_db->recycleEntry(entry);
+    {
+        Database::BulkUpdate bulkUpdate(m_db.data());
+        if (permanent) {
+            for (auto* entry : asConst(selectedEntries)) {
+                delete entry;
+            }
+        } else {
+            for (auto* entry : asConst(selectedEntries)) {
+                m_db->recycleEntry(entry);
+            }
         }
     }
 
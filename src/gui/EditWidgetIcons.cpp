@@ -317,18 +317,18 @@ void EditWidgetIcons::removeCustomIcon()
         if (index.isValid()) {
             QUuid iconUuid = m_customIconModel->uuidFromIndex(index);
 
-            const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive(true);
+            const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive();
             QList<Entry*> entriesWithSameIcon;
-            QList<Entry*> historyEntriesWithSameIcon;
+            QList<Entry*> entriesWithSameHistoryIcon;
 
             for (Entry* entry : allEntries) {
-                if (iconUuid == entry->iconUuid()) {
-                    // Check if this is a history entry (no assigned group)
-                    if (!entry->group()) {
-                        historyEntriesWithSameIcon << entry;
-                    } else if (m_currentUuid != entry->uuid()) {
-                        entriesWithSameIcon << entry;
-                    }
+                if (iconUuid == entry->iconUuid() && m_currentUuid != entry->uuid()) {
+                    entriesWithSameIcon << entry;
+                }
+                const bool historyHasIcon = entry->walkHistoryItems(
+                    [&iconUuid](const Entry* historyItem) -> bool { return historyItem->iconUuid() == iconUuid; });
+                if (historyHasIcon) {
+                    entriesWithSameHistoryIcon << entry;
                 }
             }
 
@@ -370,10 +370,14 @@ void EditWidgetIcons::removeCustomIcon()
             }
 
             // Remove the icon from history entries
-            for (Entry* entry : asConst(historyEntriesWithSameIcon)) {
-                entry->setUpdateTimeinfo(false);
-                entry->setIcon(0);
-                entry->setUpdateTimeinfo(true);
+            for (Entry* entry : asConst(entriesWithSameHistoryIcon)) {
+                entry->updateHistoryItems([&iconUuid](Entry* historyItem) {
+                    if (historyItem->iconUuid() == iconUuid) {
+                        historyItem->setUpdateTimeinfo(false);
+                        historyItem->setIcon(0);
+                        historyItem->setUpdateTimeinfo(true);
+                    }
+                });
             }
 
             // Remove the icon from the database
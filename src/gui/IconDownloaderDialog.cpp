@@ -23,7 +23,7 @@
 #include "core/Entry.h"
 #include "core/Global.h"
 #include "core/Group.h"
-#include "core/IconDownloader.h"
+#include "core/IconDownloadQueue.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "gui/IconModels.h"
@@ -37,6 +37,7 @@ IconDownloaderDialog::IconDownloaderDialog(QWidget* parent)
     : QDialog(parent)
     , m_ui(new Ui::IconDownloaderDialog())
     , m_dataModel(new QStandardItemModel(this))
+    , m_downloadQueue(new IconDownloadQueue(this))
 {
     setWindowFlags(Qt::Window);
     setAttribute(Qt::WA_DeleteOnClose);
@@ -52,6 +53,9 @@ IconDownloaderDialog::IconDownloaderDialog(QWidget* parent)
 
     connect(m_ui->cancelButton, SIGNAL(clicked()), SLOT(abortDownloads()));
     connect(m_ui->closeButton, SIGNAL(clicked()), SLOT(close()));
+    connect(m_downloadQueue,
+            SIGNAL(finished(const QStringList&, const QImage&)),
+            SLOT(downloadFinished(const QStringList&, const QImage&)));
 }
 
 IconDownloaderDialog::~IconDownloaderDialog()
@@ -87,7 +91,7 @@ void IconDownloaderDialog::downloadFavicons(const QSharedPointer<Database>& data
         for (const auto& url : m_urlToEntries.uniqueKeys()) {
             m_dataModel->appendRow(QList<QStandardItem*>()
                                    << new QStandardItem(url) << new QStandardItem(tr("Downloading...")));
-            m_activeDownloaders.append(createDownloader(url));
+            m_downloadQueue->add(url);
         }
 
         // Setup the dialog
@@ -95,64 +99,42 @@ void IconDownloaderDialog::downloadFavicons(const QSharedPointer<Database>& data
         updateCancelButton();
         QApplication::processEvents();
 
-        // Start the downloads
-        for (auto downloader : m_activeDownloaders) {
-            downloader->download();
-        }
+        // Start the downloads, URLs of the same site share one download
+        m_downloadQueue->download();
     }
 }
 
-IconDownloader* IconDownloaderDialog::createDownloader(const QString& url)
-{
-    auto downloader = new IconDownloader();
-    connect(downloader,
-            SIGNAL(finished(const QString&, const QImage&)),
-            this,
-            SLOT(downloadFinished(const QString&, const QImage&)));
-
-    downloader->setUrl(url);
-    return downloader;
-}
-
-void IconDownloaderDialog::downloadFinished(const QString& url, const QImage& icon)
+void IconDownloaderDialog::downloadFinished(const QStringList& urls, const QImage& icon)
 {
     // Prevent re-entrance from multiple calls finishing at the same time
     QMutexLocker locker(&m_mutex);
 
-    // Cleanup the icon downloader that sent this signal
-    auto downloader = qobject_cast<IconDownloader*>(sender());
-    if (downloader) {
-        downloader->deleteLater();
-        m_activeDownloaders.removeAll(downloader);
-    }
-
     updateProgressBar();
     updateCancelButton();
 
     if (m_db && !icon.isNull()) {
-        // Don't add an icon larger than 128x128, but retain original size if smaller
-        auto scaledicon = icon;
-        if (icon.width() > 128 || icon.height() > 128) {
-            scaledicon = icon.scaled(128, 128);
-        }
-
-        QUuid uuid = m_db->metadata()->findCustomIcon(scaledicon);
+        // The downloader already scaled the icon down to at most 128x128
+        QString message = tr("Ok");
+        QUuid uuid = m_db->metadata()->findCustomIcon(icon);
         if (uuid.isNull()) {
             uuid = QUuid::createUuid();
-            m_db->metadata()->addCustomIcon(uuid, scaledicon);
-            updateTable(url, tr("Ok"));
+            m_db->metadata()->addCustomIcon(uuid, icon);
         } else {
-            updateTable(url, tr("Already Exists"));
+            message = tr("Already Exists");
         }
 
-        // Set the icon on all the entries associated with this url
-        for (const auto entry : m_urlToEntries.values(url)) {
-            entry->setIcon(uuid);
+        // Set the icon on all the entries associated with these urls
+        for (const auto& url : urls) {
+            updateTable(url, message);
+            for (const auto entry : m_urlToEntries.values(url)) {
+                entry->setIcon(uuid);
+            }
         }
     } else {
         showFallbackMessage(true);
-        updateTable(url, tr("Download Failed"));
-        return;
+        for (const auto& url : urls) {
+            updateTable(url, tr("Download Failed"));
+        }
     }
 }
 
@@ -166,7 +148,7 @@ void IconDownloaderDialog::showFallbackMessage(bool state)
 void IconDownloaderDialog::updateProgressBar()
 {
     int total = m_urlToEntries.uniqueKeys().count();
-    int value = total - m_activeDownloaders.count();
+    int value = total - m_downloadQueue->urlsRemaining();
     m_ui->progressBar->setValue(value);
     m_ui->progressBar->setMaximum(total);
     m_ui->progressLabel->setText(
@@ -175,7 +157,7 @@ void IconDownloaderDialog::updateProgressBar()
 
 void IconDownloaderDialog::updateCancelButton()
 {
-    m_ui->cancelButton->setEnabled(!m_activeDownloaders.isEmpty());
+    m_ui->cancelButton->setEnabled(m_downloadQueue->urlsRemaining() > 0);
 }
 
 void IconDownloaderDialog::updateTable(const QString& url, const QString& message)
@@ -189,10 +171,7 @@ void IconDownloaderDialog::updateTable(const QString& url, const QString& messag
 
 void IconDownloaderDialog::abortDownloads()
 {
-    for (auto* downloader : m_activeDownloaders) {
-        delete downloader;
-    }
-    m_activeDownloaders.clear();
+    m_downloadQueue->abort();
     updateProgressBar();
     updateCancelButton();
 }
@@ -27,7 +27,7 @@
 class Database;
 class Entry;
 class CustomIconModel;
-class IconDownloader;
+class IconDownloadQueue;
 
 namespace Ui
 {
@@ -45,12 +45,10 @@ public:
     void downloadFavicons(const QSharedPointer<Database>& database, const QList<Entry*>& entries, bool force = false);
 
 private slots:
-    void downloadFinished(const QString& url, const QImage& icon);
+    void downloadFinished(const QStringList& urls, const QImage& icon);
     void abortDownloads();
 
 private:
-    IconDownloader* createDownloader(const QString& url);
-
     void showFallbackMessage(bool state);
     void updateTable(const QString& url, const QString& message);
     void updateProgressBar();
@@ -60,7 +58,7 @@ private:
     QStandardItemModel* m_dataModel;
     QSharedPointer<Database> m_db;
     QMultiMap<QString, Entry*> m_urlToEntries;
-    QList<IconDownloader*> m_activeDownloaders;
+    IconDownloadQueue* m_downloadQueue;
     QMutex m_mutex;
 
     Q_DISABLE_COPY(IconDownloaderDialog)
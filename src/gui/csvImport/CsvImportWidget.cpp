@@ -19,11 +19,13 @@
 #include "CsvImportWidget.h"
 #include "ui_CsvImportWidget.h"
 
+#include <QBuffer>
 #include <QFile>
 #include <QFileInfo>
 #include <QSpacerItem>
 
 #include "core/Clock.h"
+#include "core/Database.h"
 #include "format/KeePass2Writer.h"
 #include "gui/MessageBox.h"
 #include "gui/MessageWidget.h"
@@ -194,6 +196,7 @@ QString CsvImportWidget::formatStatusText() const
 void CsvImportWidget::writeDatabase()
 {
     setRootGroup();
+    Database::BulkUpdate bulkUpdate(m_db);
     for (int r = 0; r < m_parserModel->rowCount(); ++r) {
         // use validity of second column as a GO/NOGO for all others fields
         if (not m_parserModel->data(m_parserModel->index(r, 1)).isValid()) {
@@ -65,10 +65,8 @@ bool CsvParserModel::parse()
 
 void CsvParserModel::addEmptyColumn()
 {
-    for (int i = 0; i < m_table.size(); ++i) {
-        CsvRow r = m_table.at(i);
-        r.prepend(QString(""));
-        m_table.replace(i, r);
+    for (CsvRow& row : m_table) {
+        row.prepend(QString(""));
     }
 }
 
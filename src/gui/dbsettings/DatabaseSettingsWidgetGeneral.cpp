@@ -135,7 +135,7 @@ bool DatabaseSettingsWidgetGeneral::save()
     }
 
     if (truncate) {
-        const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive(false);
+        const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive();
         for (Entry* entry : allEntries) {
             entry->truncateHistory();
         }
@@ -815,7 +815,7 @@ void EditEntryWidget::loadEntry(Entry* entry,
     setReadOnly(m_history);
 
     setCurrentPage(0);
-    setPageHidden(m_historyWidget, m_history || m_entry->historyItems().count() < 1);
+    setPageHidden(m_historyWidget, m_history || m_entry->historyCount() < 1);
 #ifdef WITH_XC_SSHAGENT
     setPageHidden(m_sshAgentWidget, !sshAgent()->isEnabled());
 #endif
@@ -1146,8 +1146,13 @@ void EditEntryWidget::cancel()
 
 void EditEntryWidget::clear()
 {
+    m_historyModel->clear();
     if (m_entry) {
         m_entry->disconnect(this);
+        // The history was expanded for the history page only
+        if (!m_history) {
+            m_entry->compactHistory();
+        }
     }
 
     m_entry = nullptr;
@@ -1161,7 +1166,6 @@ void EditEntryWidget::clear()
     m_entryAttributes->clear();
     m_advancedUi->attachmentsWidget->clearAttachments();
     m_autoTypeAssoc->clear();
-    m_historyModel->clear();
     m_iconsWidget->reset();
     hideMessage();
 }
@@ -24,6 +24,7 @@
 #include <QPalette>
 
 #include "core/Config.h"
+#include "core/Database.h"
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
 #include "core/Global.h"
@@ -37,6 +38,7 @@
 EntryModel::EntryModel(QObject* parent)
     : QAbstractTableModel(parent)
     , m_group(nullptr)
+    , m_bulkUpdates(0)
     , m_hideUsernames(false)
     , m_hidePasswords(true)
     , HiddenContentDisplay(QString("\u25cf").repeated(6))
@@ -63,6 +65,7 @@ void EntryModel::setGroup(Group* group)
         return;
     }
 
+    finishBulkUpdate();
     beginResetModel();
 
     severConnections();
@@ -73,12 +76,14 @@ void EntryModel::setGroup(Group* group)
     m_orgEntries.clear();
 
     makeConnections(group);
+    makeConnections(group->database());
 
     endResetModel();
 }
 
 void EntryModel::setEntries(const QList<Entry*>& entries)
 {
+    finishBulkUpdate();
     beginResetModel();
 
     severConnections();
@@ -110,6 +115,14 @@ void EntryModel::setEntries(const QList<Entry*>& entries)
         makeConnections(group);
     }
 
+    for (Database* db : asConst(databases)) {
+        makeConnections(db);
+    }
+
+    for (const Entry* entry : asConst(m_orgEntries)) {
+        connect(entry, SIGNAL(destroyed(QObject*)), SLOT(entryDestroyed(QObject*)));
+    }
+
     endResetModel();
 }
 
@@ -465,6 +478,13 @@ void EntryModel::entryAboutToAdd(Entry* entry)
         return;
     }
 
+    if (m_bulkUpdates > 0) {
+        if (!m_group) {
+            m_entries.append(entry);
+        }
+        return;
+    }
+
     beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size());
     if (!m_group) {
         m_entries.append(entry);
@@ -473,7 +493,7 @@ void EntryModel::entryAboutToAdd(Entry* entry)
 
 void EntryModel::entryAdded(Entry* entry)
 {
-    if (!m_group && !m_orgEntries.contains(entry)) {
+    if ((!m_group && !m_orgEntries.contains(entry)) || m_bulkUpdates > 0) {
         return;
     }
 
@@ -485,6 +505,13 @@ void EntryModel::entryAdded(Entry* entry)
 
 void EntryModel::entryAboutToRemove(Entry* entry)
 {
+    if (m_bulkUpdates > 0) {
+        // Removed entries may be deleted before the bulk update finishes,
+        // the search results only forget them in entryDestroyed()
+        m_entries.removeAll(entry);
+        return;
+    }
+
     beginRemoveRows(QModelIndex(), m_entries.indexOf(entry), m_entries.indexOf(entry));
     if (!m_group) {
         m_entries.removeAll(entry);
@@ -493,6 +520,10 @@ void EntryModel::entryAboutToRemove(Entry* entry)
 
 void EntryModel::entryRemoved()
 {
+    if (m_bulkUpdates > 0) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
     }
@@ -501,6 +532,10 @@ void EntryModel::entryRemoved()
 
 void EntryModel::entryAboutToMoveUp(int row)
 {
+    if (m_bulkUpdates > 0) {
+        return;
+    }
+
     beginMoveRows(QModelIndex(), row, row, QModelIndex(), row - 1);
     if (m_group) {
         m_entries.move(row, row - 1);
@@ -509,6 +544,10 @@ void EntryModel::entryAboutToMoveUp(int row)
 
 void EntryModel::entryMovedUp()
 {
+    if (m_bulkUpdates > 0) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
     }
@@ -517,6 +556,10 @@ void EntryModel::entryMovedUp()
 
 void EntryModel::entryAboutToMoveDown(int row)
 {
+    if (m_bulkUpdates > 0) {
+        return;
+    }
+
     beginMoveRows(QModelIndex(), row, row, QModelIndex(), row + 2);
     if (m_group) {
         m_entries.move(row, row + 1);
@@ -525,18 +568,66 @@ void EntryModel::entryAboutToMoveDown(int row)
 
 void EntryModel::entryMovedDown()
 {
+    if (m_bulkUpdates > 0) {
+        return;
+    }
+
     if (m_group) {
         m_entries = m_group->entries();
     }
     endMoveRows();
 }
 
+/**
+ * Drop a deleted entry from the search results, it can no longer be moved back into view.
+ */
+void EntryModel::entryDestroyed(QObject* object)
+{
+    m_orgEntries.removeAll(static_cast<Entry*>(object));
+}
+
 void EntryModel::entryDataChanged(Entry* entry)
 {
+    if (m_bulkUpdates > 0) {
+        return;
+    }
+
     int row = m_entries.indexOf(entry);
     emit dataChanged(index(row, 0), index(row, columnCount() - 1));
 }
 
+void EntryModel::bulkUpdateStarted()
+{
+    // Entry changes are only tracked silently until the bulk update is done
+    if (m_bulkUpdates++ == 0) {
+        beginResetModel();
+    }
+}
+
+void EntryModel::bulkUpdateFinished()
+{
+    if (m_bulkUpdates == 0 || --m_bulkUpdates > 0) {
+        return;
+    }
+
+    if (m_group) {
+        m_entries = m_group->entries();
+    }
+    endResetModel();
+}
+
+/**
+ * End the model reset of a running bulk update early, the displayed entries
+ * are about to be replaced and the bulk update signals disconnected.
+ */
+void EntryModel::finishBulkUpdate()
+{
+    if (m_bulkUpdates > 0) {
+        m_bulkUpdates = 0;
+        endResetModel();
+    }
+}
+
 void EntryModel::severConnections()
 {
     if (m_group) {
@@ -546,6 +637,17 @@ void EntryModel::severConnections()
     for (const Group* group : asConst(m_allGroups)) {
         disconnect(group, nullptr, this, nullptr);
     }
+
+    for (const Entry* entry : asConst(m_orgEntries)) {
+        disconnect(entry, nullptr, this, nullptr);
+    }
+
+    for (const QPointer<Database>& db : asConst(m_databases)) {
+        if (db) {
+            disconnect(db, nullptr, this, nullptr);
+        }
+    }
+    m_databases.clear();
 }
 
 void EntryModel::makeConnections(const Group* group)
@@ -561,6 +663,17 @@ void EntryModel::makeConnections(const Group* group)
     connect(group, SIGNAL(entryDataChanged(Entry*)), SLOT(entryDataChanged(Entry*)));
 }
 
+void EntryModel::makeConnections(Database* db)
+{
+    if (!db) {
+        return;
+    }
+
+    connect(db, SIGNAL(bulkUpdateStarted()), SLOT(bulkUpdateStarted()));
+    connect(db, SIGNAL(bulkUpdateFinished()), SLOT(bulkUpdateFinished()));
+    m_databases.append(db);
+}
+
 /**
  * Get current state of 'Hide Usernames' setting
  */
@@ -20,7 +20,9 @@
 
 #include <QAbstractTableModel>
 #include <QPixmap>
+#include <QPointer>
 
+class Database;
 class Entry;
 class Group;
 
@@ -83,15 +85,22 @@ private slots:
     void entryAboutToMoveDown(int row);
     void entryMovedDown();
     void entryDataChanged(Entry* entry);
+    void entryDestroyed(QObject* object);
+    void bulkUpdateStarted();
+    void bulkUpdateFinished();
 
 private:
+    void finishBulkUpdate();
     void severConnections();
     void makeConnections(const Group* group);
+    void makeConnections(Database* db);
 
-    Group* m_group;
+    QPointer<Group> m_group;
     QList<Entry*> m_entries;
     QList<Entry*> m_orgEntries;
     QList<const Group*> m_allGroups;
+    QList<QPointer<Database>> m_databases;
+    int m_bulkUpdates;
 
     bool m_hideUsernames;
     bool m_hidePasswords;
@@ -22,6 +22,7 @@
 
 #include "core/Database.h"
 #include "core/DatabaseIcons.h"
+#include "core/Global.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
@@ -39,6 +40,8 @@ void GroupModel::changeDatabase(Database* newDb)
     beginResetModel();
 
     m_db = newDb;
+    m_fetchedGroups.clear();
+    m_pendingRowChanges.clear();
 
     // clang-format off
     connect(m_db, SIGNAL(groupDataChanged(Group*)), SLOT(groupDataChanged(Group*)));
@@ -48,6 +51,8 @@ void GroupModel::changeDatabase(Database* newDb)
     connect(m_db, SIGNAL(groupRemoved()), SLOT(groupRemoved()));
     connect(m_db, SIGNAL(groupAboutToMove(Group*,Group*,int)), SLOT(groupAboutToMove(Group*,Group*,int)));
     connect(m_db, SIGNAL(groupMoved()), SLOT(groupMoved()));
+    connect(m_db, SIGNAL(bulkUpdateStarted()), SLOT(bulkUpdateStarted()));
+    connect(m_db, SIGNAL(bulkUpdateFinished()), SLOT(bulkUpdateFinished()));
     // clang-format on
 
     endResetModel();
@@ -60,7 +65,7 @@ int GroupModel::rowCount(const QModelIndex& parent) const
         return 1;
     } else {
         const Group* group = groupFromIndex(parent);
-        return group->children().size();
+        return m_fetchedGroups.contains(group) ? group->children().size() : 0;
     }
 }
 
@@ -105,14 +110,39 @@ QModelIndex GroupModel::parent(Group* group) const
         // index is already the root group
         return QModelIndex();
     } else {
-        const Group* grandParentGroup = parentGroup->parentGroup();
-        if (!grandParentGroup) {
-            // parent is the root group
-            return createIndex(0, 0, parentGroup);
-        } else {
-            return createIndex(grandParentGroup->children().indexOf(parentGroup), 0, parentGroup);
-        }
+        return createGroupIndex(parentGroup);
+    }
+}
+
+bool GroupModel::hasChildren(const QModelIndex& parent) const
+{
+    if (!parent.isValid()) {
+        return true;
     }
+
+    return groupFromIndex(parent)->hasChildren();
+}
+
+bool GroupModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!parent.isValid()) {
+        return false;
+    }
+
+    const Group* group = groupFromIndex(parent);
+    return !m_fetchedGroups.contains(group) && group->hasChildren();
+}
+
+void GroupModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    const Group* group = groupFromIndex(parent);
+    beginInsertRows(parent, 0, group->children().size() - 1);
+    m_fetchedGroups.insert(group);
+    endInsertRows();
 }
 
 QVariant GroupModel::data(const QModelIndex& index, int role) const
@@ -158,19 +188,46 @@ QVariant GroupModel::headerData(int section, Qt::Orientation orientation, int ro
     return QVariant();
 }
 
-QModelIndex GroupModel::index(Group* group) const
+/**
+ * Index of the group, its parents are fetched first if they were not yet.
+ */
+QModelIndex GroupModel::index(Group* group)
 {
-    int row;
-
-    if (!group->parentGroup()) {
-        row = 0;
-    } else {
-        row = group->parentGroup()->children().indexOf(group);
+    QList<Group*> parentGroups;
+    for (Group* parentGroup = group->parentGroup(); parentGroup; parentGroup = parentGroup->parentGroup()) {
+        parentGroups.prepend(parentGroup);
+    }
+    for (Group* parentGroup : asConst(parentGroups)) {
+        fetchMore(createGroupIndex(parentGroup));
     }
 
+    return createGroupIndex(group);
+}
+
+QModelIndex GroupModel::createGroupIndex(Group* group) const
+{
+    int row = group->parentGroup() ? group->indexInParent() : 0;
     return createIndex(row, 0, group);
 }
 
+/**
+ * Whether the group has a row in the model, i.e. all of its parents have been fetched.
+ */
+bool GroupModel::isExposed(const Group* group) const
+{
+    for (const Group* parentGroup = group->parentGroup(); parentGroup; parentGroup = parentGroup->parentGroup()) {
+        if (!m_fetchedGroups.contains(parentGroup)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GroupModel::exposesChildren(const Group* group) const
+{
+    return m_fetchedGroups.contains(group) && isExposed(group);
+}
+
 Group* GroupModel::groupFromIndex(const QModelIndex& index) const
 {
     Q_ASSERT(index.internalPointer());
@@ -248,7 +305,7 @@ bool GroupModel::dropMimeData(const QMimeData* data,
             return false;
         }
 
-        if (parentGroup == dragGroup->parent() && row > parentGroup->children().indexOf(dragGroup)) {
+        if (parentGroup == dragGroup->parent() && row > dragGroup->indexInParent()) {
             row--;
         }
 
@@ -355,87 +412,184 @@ QMimeData* GroupModel::mimeData(const QModelIndexList& indexes) const
 
 void GroupModel::groupDataChanged(Group* group)
 {
-    QModelIndex ix = index(group);
+    if (m_db->isBulkUpdating() || !isExposed(group)) {
+        return;
+    }
+
+    QModelIndex ix = createGroupIndex(group);
     emit dataChanged(ix, ix);
 }
 
 void GroupModel::groupAboutToRemove(Group* group)
 {
+    if (m_db->isBulkUpdating()) {
+        return;
+    }
+
     Q_ASSERT(group->parentGroup());
 
-    QModelIndex parentIndex = parent(group);
-    Q_ASSERT(parentIndex.isValid());
-    int pos = group->parentGroup()->children().indexOf(group);
-    Q_ASSERT(pos != -1);
+    if (!exposesChildren(group->parentGroup())) {
+        m_pendingRowChanges.append(RowChange::None);
+    } else {
+        QModelIndex parentIndex = parent(group);
+        Q_ASSERT(parentIndex.isValid());
+        int pos = group->indexInParent();
+        Q_ASSERT(pos != -1);
+
+        beginRemoveRows(parentIndex, pos, pos);
+        m_pendingRowChanges.append(RowChange::Remove);
+    }
 
-    beginRemoveRows(parentIndex, pos, pos);
+    // The group leaves the database, forget it and its children
+    group->walkGroups([this](const Group* removedGroup) -> bool {
+        m_fetchedGroups.remove(removedGroup);
+        return false;
+    });
 }
 
 void GroupModel::groupRemoved()
 {
-    endRemoveRows();
+    if (m_db->isBulkUpdating()) {
+        return;
+    }
+
+    endRowChange();
 }
 
 void GroupModel::groupAboutToAdd(Group* group, int index)
 {
-    Q_ASSERT(group->parentGroup());
+    if (m_db->isBulkUpdating()) {
+        return;
+    }
+
+    Group* parentGroup = group->parentGroup();
+    Q_ASSERT(parentGroup);
+
+    if (!m_fetchedGroups.contains(parentGroup) && !parentGroup->hasChildren()) {
+        // nothing to fetch in an empty group, show the new child right away
+        m_fetchedGroups.insert(parentGroup);
+    }
+
+    if (!exposesChildren(parentGroup)) {
+        // the row is created when the parent is fetched
+        m_pendingRowChanges.append(RowChange::None);
+        return;
+    }
 
     QModelIndex parentIndex = parent(group);
 
     beginInsertRows(parentIndex, index, index);
+    m_pendingRowChanges.append(RowChange::Insert);
 }
 
 void GroupModel::groupAdded()
 {
-    endInsertRows();
+    if (m_db->isBulkUpdating()) {
+        return;
+    }
+
+    endRowChange();
 }
 
 void GroupModel::groupAboutToMove(Group* group, Group* toGroup, int pos)
 {
+    if (m_db->isBulkUpdating()) {
+        return;
+    }
+
     Q_ASSERT(group->parentGroup());
 
-    QModelIndex oldParentIndex = parent(group);
-    QModelIndex newParentIndex = index(toGroup);
-    int oldPos = group->parentGroup()->children().indexOf(group);
-    if (group->parentGroup() == toGroup && pos > oldPos) {
-        // beginMoveRows() has a bit different semantics than Group::setParent() and
-        // QList::move() when the new position is greater than the old
-        pos++;
+    if (!m_fetchedGroups.contains(toGroup) && !toGroup->hasChildren()) {
+        m_fetchedGroups.insert(toGroup);
     }
 
-    bool moveResult = beginMoveRows(oldParentIndex, oldPos, oldPos, newParentIndex, pos);
-    Q_UNUSED(moveResult);
-    Q_ASSERT(moveResult);
+    const bool fromExposed = exposesChildren(group->parentGroup());
+    const bool toExposed = exposesChildren(toGroup);
+    int oldPos = group->indexInParent();
+
+    // Moves between a fetched and a not yet fetched parent are a plain insert or remove
+    if (fromExposed && toExposed) {
+        QModelIndex oldParentIndex = parent(group);
+        QModelIndex newParentIndex = createGroupIndex(toGroup);
+        if (group->parentGroup() == toGroup && pos > oldPos) {
+            // beginMoveRows() has a bit different semantics than Group::setParent() and
+            // QList::move() when the new position is greater than the old
+            pos++;
+        }
+
+        bool moveResult = beginMoveRows(oldParentIndex, oldPos, oldPos, newParentIndex, pos);
+        Q_UNUSED(moveResult);
+        Q_ASSERT(moveResult);
+        m_pendingRowChanges.append(RowChange::Move);
+    } else if (fromExposed) {
+        beginRemoveRows(parent(group), oldPos, oldPos);
+        m_pendingRowChanges.append(RowChange::Remove);
+    } else if (toExposed) {
+        beginInsertRows(createGroupIndex(toGroup), pos, pos);
+        m_pendingRowChanges.append(RowChange::Insert);
+    } else {
+        m_pendingRowChanges.append(RowChange::None);
+    }
 }
 
 void GroupModel::groupMoved()
 {
-    endMoveRows();
+    if (m_db->isBulkUpdating()) {
+        return;
+    }
+
+    endRowChange();
+}
+
+void GroupModel::endRowChange()
+{
+    Q_ASSERT(!m_pendingRowChanges.isEmpty());
+    if (m_pendingRowChanges.isEmpty()) {
+        return;
+    }
+
+    switch (m_pendingRowChanges.takeLast()) {
+    case RowChange::Insert:
+        endInsertRows();
+        break;
+    case RowChange::Remove:
+        endRemoveRows();
+        break;
+    case RowChange::Move:
+        endMoveRows();
+        break;
+    case RowChange::None:
+        break;
+    }
+}
+
+void GroupModel::bulkUpdateStarted()
+{
+    // Individual group changes are skipped until the bulk update is done
+    beginResetModel();
+}
+
+void GroupModel::bulkUpdateFinished()
+{
+    // Groups may have been deleted in the meantime, views fetch their expanded groups again
+    m_fetchedGroups.clear();
+    m_pendingRowChanges.clear();
+    endResetModel();
 }
 
 void GroupModel::sortChildren(Group* rootGroup, bool reverse)
 {
     emit layoutAboutToBeChanged();
 
-    QList<QModelIndex> oldIndexes;
-    collectIndexesRecursively(oldIndexes, rootGroup->children());
+    // Only persistent indexes like the selection and the expanded state of views need
+    // to be updated, the rows of the groups are looked up directly afterwards
+    const QModelIndexList oldIndexes = persistentIndexList();
 
     rootGroup->sortChildrenRecursively(reverse);
 
-    QList<QModelIndex> newIndexes;
-    collectIndexesRecursively(newIndexes, rootGroup->children());
-
-    for (int i = 0; i < oldIndexes.count(); i++) {
-        changePersistentIndex(oldIndexes[i], newIndexes[i]);
+    for (const QModelIndex& oldIndex : oldIndexes) {
+        changePersistentIndex(oldIndex, createGroupIndex(groupFromIndex(oldIndex)));
     }
 
     emit layoutChanged();
 }
-
-void GroupModel::collectIndexesRecursively(QList<QModelIndex>& indexes, QList<Group*> groups)
-{
-    for (auto group : groups) {
-        indexes.append(index(group));
-        collectIndexesRecursively(indexes, group->children());
-    }
-}
@@ -19,10 +19,19 @@
 #define KEEPASSX_GROUPMODEL_H
 
 #include <QAbstractItemModel>
+#include <QSet>
+#include <QVector>
 
 class Database;
 class Group;
 
+/**
+ * Tree model of the groups of a database.
+ *
+ * The children of a group are only exposed once the group has been fetched
+ * with fetchMore(), which views do when the group is expanded, so opening a
+ * database with a large tree only creates rows for the expanded groups.
+ */
 class GroupModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -30,13 +39,16 @@ class GroupModel : public QAbstractItemModel
 public:
     explicit GroupModel(Database* db, QObject* parent = nullptr);
     void changeDatabase(Database* newDb);
-    QModelIndex index(Group* group) const;
+    QModelIndex index(Group* group);
     Group* groupFromIndex(const QModelIndex& index) const;
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
     QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
     QModelIndex parent(const QModelIndex& index) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     Qt::DropActions supportedDropActions() const override;
@@ -48,8 +60,19 @@ public:
     void sortChildren(Group* rootGroup, bool reverse = false);
 
 private:
+    enum class RowChange
+    {
+        None,
+        Insert,
+        Remove,
+        Move
+    };
+
+    QModelIndex createGroupIndex(Group* group) const;
     QModelIndex parent(Group* group) const;
-    void collectIndexesRecursively(QList<QModelIndex>& indexes, QList<Group*> groups);
+    bool isExposed(const Group* group) const;
+    bool exposesChildren(const Group* group) const;
+    void endRowChange();
 
 private slots:
     void groupDataChanged(Group* group);
@@ -59,9 +82,15 @@ private slots:
     void groupAdded();
     void groupAboutToMove(Group* group, Group* toGroup, int pos);
     void groupMoved();
+    void bulkUpdateStarted();
+    void bulkUpdateFinished();
 
 private:
     Database* m_db;
+    // groups whose children rows have been fetched
+    QSet<const Group*> m_fetchedGroups;
+    // row changes begun in the about to signals of the database, ended in the matching done signals
+    QVector<RowChange> m_pendingRowChanges;
 };
 
 #endif // KEEPASSX_GROUPMODEL_H
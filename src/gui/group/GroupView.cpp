@@ -40,6 +40,7 @@ GroupView::GroupView(Database* db, QWidget* parent)
     connect(this, SIGNAL(collapsed(QModelIndex)), SLOT(expandedChanged(QModelIndex)));
     connect(this, SIGNAL(clicked(QModelIndex)), SIGNAL(groupSelectionChanged()));
     connect(m_model, SIGNAL(rowsInserted(QModelIndex,int,int)), SLOT(syncExpandedState(QModelIndex,int,int)));
+    connect(m_model, SIGNAL(modelAboutToBeReset()), SLOT(modelAboutToBeReset()));
     connect(m_model, SIGNAL(modelReset()), SLOT(modelReset()));
     connect(selectionModel(), SIGNAL(currentChanged(QModelIndex,QModelIndex)), SIGNAL(groupSelectionChanged()));
     // clang-format on
@@ -115,6 +116,16 @@ void GroupView::recInitExpanded(Group* group)
     expandGroup(group, group->isExpanded());
     m_updatingExpanded = false;
 
+    // Collapsed groups are fetched once they are expanded, the rows of an
+    // expanded group are initialized by syncExpandedState() when fetched here
+    QModelIndex index = m_model->index(group);
+    if (m_model->canFetchMore(index)) {
+        if (group->isExpanded()) {
+            m_model->fetchMore(index);
+        }
+        return;
+    }
+
     const QList<Group*> children = group->children();
     for (Group* child : children) {
         recInitExpanded(child);
@@ -158,8 +169,22 @@ void GroupView::setCurrentGroup(Group* group)
     }
 }
 
+void GroupView::modelAboutToBeReset()
+{
+    m_resetGroup = currentGroup();
+}
+
 void GroupView::modelReset()
 {
-    recInitExpanded(m_model->groupFromIndex(m_model->index(0, 0)));
-    setCurrentIndex(m_model->index(0, 0));
+    Group* rootGroup = m_model->groupFromIndex(m_model->index(0, 0));
+    recInitExpanded(rootGroup);
+
+    // Keep the selection if the group survived the reset, e.g. after a bulk update
+    Group* group = m_resetGroup;
+    m_resetGroup.clear();
+    if (group && group->database() && group->database() == rootGroup->database()) {
+        setCurrentIndex(m_model->index(group));
+    } else {
+        setCurrentIndex(m_model->index(0, 0));
+    }
 }
@@ -182,7 +182,7 @@ void ReportsWidgetHealthcheck::addHealthRow(QSharedPointer<PasswordHealth> healt
     auto row = QList<QStandardItem*>();
     row << new QStandardItem(descr);
     row << new QStandardItem(entry->iconPixmap(), title);
-    row << new QStandardItem(group->iconPixmap(), group->hierarchy().join("/"));
+    row << new QStandardItem(group->iconPixmap(), group->fullPath());
     row << new QStandardItem(QString::number(health->score()));
     row << new QStandardItem(health->scoreReason());
 
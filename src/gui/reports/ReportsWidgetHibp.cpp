@@ -117,7 +117,9 @@ void ReportsWidgetHibp::makeHibpTable()
 
     // Search database for passwords that we've found so far
     QList<QPair<const Entry*, int>> items;
-    for (const auto* entry : m_db->rootGroup()->entriesRecursive()) {
+    m_db->rootGroup()->loadEntriesRecursive();
+    const auto entries = m_db->entries();
+    for (const auto* entry : entries) {
         if (!entry->isRecycled()) {
             const auto found = m_pwndPasswords.find(entry->password());
             if (found != m_pwndPasswords.end()) {
@@ -159,7 +161,7 @@ void ReportsWidgetHibp::makeHibpTable()
 
         auto row = QList<QStandardItem*>();
         row << new QStandardItem(entry->iconPixmap(), title)
-            << new QStandardItem(group->iconPixmap(), group->hierarchy().join("/"))
+            << new QStandardItem(group->iconPixmap(), group->fullPath())
             << new QStandardItem(countToText(count));
 
         if (knownBad) {
@@ -246,7 +248,9 @@ void ReportsWidgetHibp::startValidation()
     // Collect all passwords in the database (unless recycled, and
     // unless empty, and unless marked as "known bad") and submit them
     // to the downloader.
-    for (const auto* entry : m_db->rootGroup()->entriesRecursive()) {
+    m_db->rootGroup()->loadEntriesRecursive();
+    const auto entries = m_db->entries();
+    for (const auto* entry : entries) {
         if (!entry->isRecycled() && !entry->password().isEmpty()) {
             m_downloader.add(entry->password());
         }
@@ -109,6 +109,12 @@ KeeShareSettings::Reference KeeShare::referenceOf(const Group* group)
     return reference;
 }
 
+QString KeeShare::encodedReferenceOf(const Group* group)
+{
+    // Raw custom data value, cheap to compare without deserializing the reference
+    return group->customData()->value(KeeShare_Reference);
+}
+
 void KeeShare::setReferenceTo(Group* group, const KeeShareSettings::Reference& reference)
 {
     CustomData* customData = group->customData();
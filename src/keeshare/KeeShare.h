@@ -55,6 +55,7 @@ public:
     static void setOwn(const KeeShareSettings::Own& own);
 
     static KeeShareSettings::Reference referenceOf(const Group* group);
+    static QString encodedReferenceOf(const Group* group);
     static void setReferenceTo(Group* group, const KeeShareSettings::Reference& reference);
     static QString referenceTypeLabel(const KeeShareSettings::Reference& reference);
 
@@ -69,7 +69,7 @@ namespace
         targetRoot->setUpdateTimeinfo(false);
         KeeShare::setReferenceTo(targetRoot, KeeShareSettings::Reference());
         targetRoot->setUpdateTimeinfo(updateTimeinfo);
-        const auto sourceEntries = sourceRoot->entriesRecursive(false);
+        const auto sourceEntries = sourceRoot->entriesRecursive();
         for (const Entry* sourceEntry : sourceEntries) {
             auto* targetEntry = sourceEntry->clone(Entry::CloneIncludeHistory);
             const bool updateTimeinfoEntry = targetEntry->canUpdateTimeinfo();
@@ -96,7 +96,7 @@ namespace
         for (const auto& object : sourceDb->deletedObjects()) {
             targetDb->addDeletedObject(object);
         }
-        for (auto* targetEntry : targetRoot->entriesRecursive(false)) {
+        for (auto* targetEntry : targetRoot->entriesRecursive()) {
             if (targetEntry->hasReferences()) {
                 resolveReferenceAttributes(targetEntry, sourceDb);
             }
@@ -21,6 +21,7 @@
 #include "core/FileWatcher.h"
 #include "core/Global.h"
 #include "core/Group.h"
+#include "core/Trace.h"
 #include "keeshare/KeeShare.h"
 #include "keeshare/ShareExport.h"
 #include "keeshare/ShareImport.h"
@@ -35,12 +36,18 @@ namespace
 
     constexpr int FileWatchPeriod = 30;
     constexpr int FileWatchSize = 5;
+    // Coalesces bursts of change notifications (bulk edits, merges) into a single rescan
+    constexpr int ReinitializeDelay = 200;
 } // End Namespace
 
 ShareObserver::ShareObserver(QSharedPointer<Database> db, QObject* parent)
     : QObject(parent)
     , m_db(std::move(db))
 {
+    m_reinitializeTimer.setSingleShot(true);
+    m_reinitializeTimer.setInterval(ReinitializeDelay);
+    connect(&m_reinitializeTimer, SIGNAL(timeout()), SLOT(reinitialize()));
+
     connect(KeeShare::instance(), SIGNAL(activeChanged()), SLOT(handleDatabaseChanged()));
 
     connect(m_db.data(), SIGNAL(groupDataChanged(Group*)), SLOT(handleDatabaseChanged()));
@@ -51,6 +58,7 @@ ShareObserver::ShareObserver(QSharedPointer<Database> db, QObject* parent)
     connect(m_db.data(), SIGNAL(databaseSaved()), SLOT(handleDatabaseSaved()));
 
     handleDatabaseChanged();
+    flushPendingChanges();
 }
 
 ShareObserver::~ShareObserver()
@@ -59,28 +67,79 @@ ShareObserver::~ShareObserver()
 
 void ShareObserver::deinitialize()
 {
-    m_groupToReference.clear();
+    m_reinitializeTimer.stop();
+    m_groupToShare.clear();
     m_shareToGroup.clear();
     m_fileWatchers.clear();
 }
 
+void ShareObserver::flushPendingChanges()
+{
+    if (m_reinitializeTimer.isActive()) {
+        m_reinitializeTimer.stop();
+        reinitialize();
+    }
+}
+
+void ShareObserver::removeShare(const Group* group)
+{
+    const auto it = m_groupToShare.find(group);
+    if (it == m_groupToShare.end()) {
+        return;
+    }
+    if (!it->reference.path.isEmpty()) {
+        const auto resolvedPath = resolvePath(it->reference.path, m_db);
+        if (m_shareToGroup.value(resolvedPath) == it->group) {
+            m_shareToGroup.remove(resolvedPath);
+            m_fileWatchers.remove(resolvedPath);
+        }
+    }
+    m_groupToShare.erase(it);
+}
+
 void ShareObserver::reinitialize()
 {
+    TRACE_SCOPE("ShareObserver::reinitialize");
+
+    if (!m_db) {
+        return;
+    }
+
+    // Drop shares of groups which were deleted or moved out of the database
+    QList<const Group*> staleGroups;
+    for (auto it = m_groupToShare.cbegin(); it != m_groupToShare.cend(); ++it) {
+        if (!it->group || it->group->database() != m_db.data()) {
+            staleGroups << it.key();
+        }
+    }
+    for (const Group* group : asConst(staleGroups)) {
+        removeShare(group);
+    }
+
     QList<QPair<Group*, KeeShareSettings::Reference>> shares;
     for (Group* group : m_db->rootGroup()->groupsRecursive(true)) {
-        auto oldReference = m_groupToReference.value(group);
-        auto newReference = KeeShare::referenceOf(group);
-        if (oldReference == newReference) {
+        // Comparing the raw custom data is cheap - only deserialize references that actually changed
+        const auto encoded = KeeShare::encodedReferenceOf(group);
+        const auto oldShare = m_groupToShare.value(group);
+        if (oldShare.encoded == encoded) {
             continue;
         }
 
-        const auto oldResolvedPath = resolvePath(oldReference.path, m_db);
-        m_groupToReference.remove(group);
-        m_shareToGroup.remove(oldResolvedPath);
-        m_fileWatchers.remove(oldResolvedPath);
+        const auto newReference = KeeShare::referenceOf(group);
+        if (oldShare.reference == newReference) {
+            if (encoded.isEmpty()) {
+                m_groupToShare.remove(group);
+            } else {
+                m_groupToShare.insert(group, {group, encoded, newReference});
+            }
+            continue;
+        }
 
+        removeShare(group);
+        if (!encoded.isEmpty()) {
+            m_groupToShare.insert(group, {group, encoded, newReference});
+        }
         if (newReference.isValid()) {
-            m_groupToReference[group] = newReference;
             const auto newResolvedPath = resolvePath(newReference.path, m_db);
             m_shareToGroup[newResolvedPath] = group;
         }
@@ -168,6 +227,8 @@ void ShareObserver::notifyAbout(const QStringList& success, const QStringList& w
 
 void ShareObserver::handleDatabaseChanged()
 {
+    TRACE_SCOPE("ShareObserver::handleDatabaseChanged");
+
     if (!m_db) {
         Q_ASSERT(m_db);
         return;
@@ -175,8 +236,8 @@ void ShareObserver::handleDatabaseChanged()
     const auto active = KeeShare::active();
     if (!active.out && !active.in) {
         deinitialize();
-    } else {
-        reinitialize();
+    } else if (!m_reinitializeTimer.isActive()) {
+        m_reinitializeTimer.start();
     }
 }
 
@@ -235,6 +296,8 @@ QSharedPointer<Database> ShareObserver::database()
 
 QList<ShareObserver::Result> ShareObserver::exportShares()
 {
+    flushPendingChanges();
+
     QList<Result> results;
     struct Reference
     {
@@ -18,10 +18,12 @@
 #ifndef KEEPASSXC_SHAREOBSERVER_H
 #define KEEPASSXC_SHAREOBSERVER_H
 
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QSharedPointer>
 #include <QStringList>
+#include <QTimer>
 
 #include "gui/MessageWidget.h"
 #include "keeshare/KeeShareSettings.h"
@@ -68,6 +70,7 @@ signals:
 private slots:
     void handleDatabaseChanged();
     void handleDatabaseSaved();
+    void reinitialize();
     void handleFileUpdated(const QString& path);
 
 private:
@@ -75,12 +78,21 @@ private:
     QList<Result> exportShares();
 
     void deinitialize();
-    void reinitialize();
+    void flushPendingChanges();
+    void removeShare(const Group* group);
     void notifyAbout(const QStringList& success, const QStringList& warning, const QStringList& error);
 
 private:
+    struct Share
+    {
+        QPointer<Group> group;
+        QString encoded;
+        KeeShareSettings::Reference reference;
+    };
+
     QSharedPointer<Database> m_db;
-    QMap<QPointer<Group>, KeeShareSettings::Reference> m_groupToReference;
+    QTimer m_reinitializeTimer;
+    QHash<const Group*, Share> m_groupToShare;
     QMap<QString, QPointer<Group>> m_shareToGroup;
     QMap<QString, QSharedPointer<FileWatcher>> m_fileWatchers;
 };
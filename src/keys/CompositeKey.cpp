@@ -17,6 +17,7 @@
  */
 
 #include "CompositeKey.h"
+#include <QDataStream>
 #include <QFile>
 #include <QtConcurrent>
 #include <format/KeePass2.h>
@@ -25,6 +26,10 @@
 #include "crypto/CryptoHash.h"
 #include "crypto/kdf/AesKdf.h"
 
+#include <cstring>
+#include <gcrypt.h>
+#include <sodium.h>
+
 QUuid CompositeKey::UUID("76a7ae25-a542-4add-9849-7c06be945b94");
 
 CompositeKey::CompositeKey()
@@ -41,6 +46,7 @@ void CompositeKey::clear()
 {
     m_keys.clear();
     m_challengeResponseKeys.clear();
+    clearTransformCache();
 }
 
 bool CompositeKey::isEmpty() const
@@ -106,6 +112,10 @@ QByteArray CompositeKey::rawKey(const QByteArray* transformSeed, bool* ok, QStri
  * challenge response key components after key transformation.
  * KDBX4+ KDFs transform the whole key including challenge-response components.
  *
+ * Results are cached for the lifetime of this key, so reloading a database saved
+ * with the same KDF parameters and seed does not run the KDF again. Transformations
+ * that include challenge-response components are never cached.
+ *
  * @param kdf key derivation function
  * @param result transformed key hash
  * @return true on success
@@ -114,13 +124,102 @@ bool CompositeKey::transform(const Kdf& kdf, QByteArray& result, QString* error)
 {
     if (kdf.uuid() == KeePass2::KDF_AES_KDBX3) {
         // legacy KDBX3 AES-KDF, challenge response is added later to the hash
-        return kdf.transform(rawKey(), result);
+        const QByteArray cacheKey = transformCacheKey(kdf);
+        if (findCachedTransform(cacheKey, result)) {
+            return true;
+        }
+        if (!kdf.transform(rawKey(), result)) {
+            return false;
+        }
+        cacheTransform(cacheKey, result);
+        return true;
+    }
+
+    QByteArray cacheKey;
+    if (m_challengeResponseKeys.isEmpty()) {
+        cacheKey = transformCacheKey(kdf);
+        if (findCachedTransform(cacheKey, result)) {
+            return true;
+        }
     }
 
     QByteArray seed = kdf.seed();
     Q_ASSERT(!seed.isEmpty());
     bool ok = false;
-    return kdf.transform(rawKey(&seed, &ok, error), result) && ok;
+    if (!kdf.transform(rawKey(&seed, &ok, error), result) || !ok) {
+        return false;
+    }
+
+    if (!cacheKey.isEmpty()) {
+        cacheTransform(cacheKey, result);
+    }
+    return true;
+}
+
+/**
+ * Identify a transformation by the static key components and all KDF parameters
+ * including the seed.
+ */
+QByteArray CompositeKey::transformCacheKey(const Kdf& kdf) const
+{
+    QByteArray parameters;
+    QDataStream stream(&parameters, QIODevice::WriteOnly);
+    stream << kdf.uuid() << KeePass2::kdfToParameters(kdf.clone());
+
+    CryptoHash cryptoHash(CryptoHash::Sha256);
+    cryptoHash.addData(rawKey());
+    cryptoHash.addData(parameters);
+    return cryptoHash.result();
+}
+
+bool CompositeKey::findCachedTransform(const QByteArray& cacheKey, QByteArray& result) const
+{
+    QMutexLocker locker(&m_transformCacheMutex);
+    for (int i = 0; i < m_transformCache.size(); ++i) {
+        if (m_transformCache[i].cacheKey == cacheKey) {
+            m_transformCache.move(i, 0);
+            const CachedTransform& cached = m_transformCache.first();
+            result = QByteArray(cached.key, cached.size);
+            return true;
+        }
+    }
+    return false;
+}
+
+void CompositeKey::cacheTransform(const QByteArray& cacheKey, const QByteArray& result) const
+{
+    CachedTransform cached;
+    cached.cacheKey = cacheKey;
+    cached.size = result.size();
+    cached.key = static_cast<char*>(gcry_malloc_secure(static_cast<std::size_t>(cached.size)));
+    if (!cached.key) {
+        return;
+    }
+    std::memcpy(cached.key, result.constData(), static_cast<std::size_t>(cached.size));
+
+    QMutexLocker locker(&m_transformCacheMutex);
+    m_transformCache.prepend(cached);
+    while (m_transformCache.size() > TransformCacheSize) {
+        wipeTransform(m_transformCache.last());
+        m_transformCache.removeLast();
+    }
+}
+
+void CompositeKey::clearTransformCache()
+{
+    QMutexLocker locker(&m_transformCacheMutex);
+    for (auto& cached : m_transformCache) {
+        wipeTransform(cached);
+    }
+    m_transformCache.clear();
+}
+
+void CompositeKey::wipeTransform(CachedTransform& cached)
+{
+    sodium_memzero(cached.key, static_cast<std::size_t>(cached.size));
+    gcry_free(cached.key);
+    cached.key = nullptr;
+    cached.size = 0;
 }
 
 bool CompositeKey::challenge(const QByteArray& seed, QByteArray& result, QString* error) const
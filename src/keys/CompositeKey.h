@@ -20,6 +20,7 @@
 #define KEEPASSX_COMPOSITEKEY_H
 
 #include <QList>
+#include <QMutex>
 #include <QSharedPointer>
 #include <QString>
 
@@ -50,9 +51,27 @@ public:
 
 private:
     QByteArray rawKey(const QByteArray* transformSeed, bool* ok = nullptr, QString* error = nullptr) const;
+    QByteArray transformCacheKey(const Kdf& kdf) const;
+    bool findCachedTransform(const QByteArray& cacheKey, QByteArray& result) const;
+    void cacheTransform(const QByteArray& cacheKey, const QByteArray& result) const;
+    void clearTransformCache();
 
     QList<QSharedPointer<Key>> m_keys;
     QList<QSharedPointer<ChallengeResponseKey>> m_challengeResponseKeys;
+
+    // Transformed key held in its own secure buffer, never shared with callers
+    struct CachedTransform
+    {
+        QByteArray cacheKey;
+        char* key;
+        int size;
+    };
+    static void wipeTransform(CachedTransform& cached);
+
+    // Most recently used transformed keys, keyed by key and KDF parameters
+    mutable QMutex m_transformCacheMutex;
+    mutable QList<CachedTransform> m_transformCache;
+    static const int TransformCacheSize = 4;
 };
 
 #endif // KEEPASSX_COMPOSITEKEY_H
@@ -25,6 +25,7 @@
 #include "core/Bootstrap.h"
 #include "core/Config.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 #include "crypto/Crypto.h"
 #include "gui/Application.h"
 #include "gui/MainWindow.h"
@@ -86,11 +87,15 @@ int main(int argc, char** argv)
     QCommandLineOption helpOption = parser.addHelpOption();
     QCommandLineOption versionOption = parser.addVersionOption();
     QCommandLineOption debugInfoOption(QStringList() << "debug-info", QObject::tr("Displays debugging information."));
+    QCommandLineOption traceOption("trace", QObject::tr("write a performance trace to file"), "file");
     parser.addOption(configOption);
     parser.addOption(keyfileOption);
     parser.addOption(pwstdinOption);
     parser.addOption(parentWindowOption);
     parser.addOption(debugInfoOption);
+#ifdef WITH_XC_TRACING
+    parser.addOption(traceOption);
+#endif
 
     parser.process(app);
 
@@ -128,6 +133,10 @@ int main(int argc, char** argv)
         return EXIT_SUCCESS;
     }
 
+#ifdef WITH_XC_TRACING
+    Trace::start(parser.value(traceOption));
+#endif
+
     if (parser.isSet(configOption)) {
         Config::createConfigFromFile(parser.value(configOption));
     }
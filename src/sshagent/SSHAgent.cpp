@@ -18,7 +18,11 @@
 
 #include "SSHAgent.h"
 
+#include "core/AsyncTask.h"
 #include "core/Config.h"
+#include "core/Global.h"
+#include "core/Group.h"
+#include "core/Trace.h"
 #include "crypto/ssh/BinaryStream.h"
 #include "crypto/ssh/OpenSSHKey.h"
 #include "sshagent/KeeAgentSettings.h"
@@ -31,6 +35,31 @@
 
 Q_GLOBAL_STATIC(SSHAgent, s_sshAgent);
 
+namespace
+{
+    /**
+     * Snapshot of everything needed to decode an entry's key,
+     * so the decoding can run without touching the entry itself.
+     */
+    struct KeySource
+    {
+        KeeAgentSettings settings;
+        QString username;
+        QString password;
+        QSharedPointer<EntryAttachments> attachments;
+    };
+
+    SSHAgent::Identity decodeIdentity(const KeySource& source)
+    {
+        SSHAgent::Identity identity{OpenSSHKey(), source.settings, false, {}};
+        if (!identity.settings.toOpenSSHKey(
+                source.username, source.password, source.attachments.data(), identity.key, true)) {
+            identity.error = identity.settings.errorString();
+        }
+        return identity;
+    }
+} // namespace
+
 SSHAgent::~SSHAgent()
 {
     removeAllIdentities();
@@ -120,10 +149,38 @@ bool SSHAgent::isAgentRunning() const
 }
 
 bool SSHAgent::sendMessage(const QByteArray& in, QByteArray& out)
+{
+    QList<QByteArray> responses;
+    if (!sendMessages({in}, responses)) {
+        return false;
+    }
+
+    out = responses.first();
+    return true;
+}
+
+/**
+ * Send several requests over a single agent connection.
+ *
+ * All requests are written before the first response is read, the agent
+ * answers them in order.
+ *
+ * @param in requests to send
+ * @param out responses, one per request
+ * @return true on success
+ */
+bool SSHAgent::sendMessages(const QList<QByteArray>& in, QList<QByteArray>& out)
 {
 #ifdef Q_OS_WIN
     if (!useOpenSSH()) {
-        return sendMessagePageant(in, out);
+        for (const QByteArray& request : in) {
+            QByteArray response;
+            if (!sendMessagePageant(request, response)) {
+                return false;
+            }
+            out.append(response);
+        }
+        return true;
     }
 #endif
 
@@ -136,12 +193,18 @@ bool SSHAgent::sendMessage(const QByteArray& in, QByteArray& out)
         return false;
     }
 
-    stream.writeString(in);
+    for (const QByteArray& request : in) {
+        stream.writeString(request);
+    }
     stream.flush();
 
-    if (!stream.readString(out)) {
-        m_error = tr("Agent protocol error.");
-        return false;
+    for (int i = 0; i < in.size(); ++i) {
+        QByteArray response;
+        if (!stream.readString(response)) {
+            m_error = tr("Agent protocol error.");
+            return false;
+        }
+        out.append(response);
     }
 
     socket.close();
@@ -223,17 +286,81 @@ bool SSHAgent::sendMessagePageant(const QByteArray& in, QByteArray& out)
  * @return true on success
  */
 bool SSHAgent::addIdentity(OpenSSHKey& key, const KeeAgentSettings& settings, const QUuid& databaseUuid)
+{
+    QList<Identity> identities;
+    identities.append(Identity{key, settings, false, {}});
+    return addIdentities(identities, databaseUuid);
+}
+
+/**
+ * Add several identities to the SSH agent using a single connection.
+ *
+ * Each identity is marked as added or gets its error set. The error string
+ * of the agent holds the last error encountered.
+ *
+ * @param identities identities to add
+ * @param databaseUuid database that owns the keys for remove-on-lock
+ * @return true if all identities were added
+ */
+bool SSHAgent::addIdentities(QList<Identity>& identities, const QUuid& databaseUuid)
 {
     if (!isAgentRunning()) {
         m_error = tr("No agent running, cannot add identity.");
+        for (Identity& identity : identities) {
+            identity.error = m_error;
+        }
         return false;
     }
 
-    if (m_addedKeys.contains(key) && m_addedKeys[key].first != databaseUuid) {
-        m_error = tr("Key identity ownership conflict. Refusing to add.");
+    QList<QByteArray> requests;
+    QList<int> requestIndexes;
+    for (int i = 0; i < identities.size(); ++i) {
+        Identity& identity = identities[i];
+        if (m_addedKeys.contains(identity.key) && m_addedKeys[identity.key].first != databaseUuid) {
+            identity.error = tr("Key identity ownership conflict. Refusing to add.");
+            continue;
+        }
+
+        requests.append(addIdentityRequest(identity.key, identity.settings));
+        requestIndexes.append(i);
+    }
+
+    QList<QByteArray> responses;
+    if (!requests.isEmpty() && !sendMessages(requests, responses)) {
+        for (int i : asConst(requestIndexes)) {
+            identities[i].error = m_error;
+        }
         return false;
     }
 
+    for (int i = 0; i < requestIndexes.size(); ++i) {
+        Identity& identity = identities[requestIndexes[i]];
+        const QByteArray& responseData = responses[i];
+
+        if (responseData.length() < 1 || static_cast<quint8>(responseData[0]) != SSH_AGENT_SUCCESS) {
+            identity.error = addIdentityError(identity.settings);
+            continue;
+        }
+
+        OpenSSHKey keyCopy = identity.key;
+        keyCopy.clearPrivate();
+        m_addedKeys[keyCopy] = qMakePair(databaseUuid, identity.settings.removeAtDatabaseClose());
+        identity.added = true;
+    }
+
+    bool success = true;
+    for (const Identity& identity : asConst(identities)) {
+        if (!identity.added) {
+            m_error = identity.error;
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+QByteArray SSHAgent::addIdentityRequest(OpenSSHKey& key, const KeeAgentSettings& settings) const
+{
     QByteArray requestData;
     BinaryStream request(&requestData);
 
@@ -251,30 +378,23 @@ bool SSHAgent::addIdentity(OpenSSHKey& key, const KeeAgentSettings& settings, co
         request.write(SSH_AGENT_CONSTRAIN_CONFIRM);
     }
 
-    QByteArray responseData;
-    if (!sendMessage(requestData, responseData)) {
-        return false;
-    }
-
-    if (responseData.length() < 1 || static_cast<quint8>(responseData[0]) != SSH_AGENT_SUCCESS) {
-        m_error =
-            tr("Agent refused this identity. Possible reasons include:") + "\n" + tr("The key has already been added.");
+    return requestData;
+}
 
-        if (settings.useLifetimeConstraintWhenAdding()) {
-            m_error += "\n" + tr("Restricted lifetime is not supported by the agent (check options).");
-        }
+QString SSHAgent::addIdentityError(const KeeAgentSettings& settings) const
+{
+    QString error =
+        tr("Agent refused this identity. Possible reasons include:") + "\n" + tr("The key has already been added.");
 
-        if (settings.useConfirmConstraintWhenAdding()) {
-            m_error += "\n" + tr("A confirmation request is not supported by the agent (check options).");
-        }
+    if (settings.useLifetimeConstraintWhenAdding()) {
+        error += "\n" + tr("Restricted lifetime is not supported by the agent (check options).");
+    }
 
-        return false;
+    if (settings.useConfirmConstraintWhenAdding()) {
+        error += "\n" + tr("A confirmation request is not supported by the agent (check options).");
     }
 
-    OpenSSHKey keyCopy = key;
-    keyCopy.clearPrivate();
-    m_addedKeys[keyCopy] = qMakePair(databaseUuid, settings.removeAtDatabaseClose());
-    return true;
+    return error;
 }
 
 /**
@@ -454,37 +574,78 @@ void SSHAgent::databaseLocked()
 
 void SSHAgent::databaseUnlocked()
 {
-    auto* widget = qobject_cast<DatabaseWidget*>(sender());
+    TRACE_SCOPE("SSHAgent::databaseUnlocked");
+
+    QPointer<DatabaseWidget> widget = qobject_cast<DatabaseWidget*>(sender());
     if (!widget) {
         return;
     }
 
-    for (Entry* e : widget->database()->rootGroup()->entriesRecursive()) {
-        if (widget->database()->metadata()->recycleBinEnabled()
-            && e->group() == widget->database()->metadata()->recycleBin()) {
-            continue;
+    auto db = widget->database();
+
+    // Entries are only read on the GUI thread, the decoding works on a snapshot.
+    // Groups that were not accessed yet are streamed instead of loaded.
+    QList<KeySource> sources;
+    const Group* recycleBin = db->metadata()->recycleBinEnabled() ? db->metadata()->recycleBin() : nullptr;
+    db->rootGroup()->walkGroups([recycleBin, &sources](const Group* group) -> bool {
+        if (recycleBin && group == recycleBin) {
+            return false;
         }
 
-        KeeAgentSettings settings;
+        group->streamEntries([&sources](const Entry* e) -> bool {
+            KeySource source;
 
-        if (!settings.fromEntry(e)) {
-            continue;
-        }
+            if (!source.settings.fromEntry(e)) {
+                return false;
+            }
 
-        if (!settings.allowUseOfSshKey() || !settings.addAtDatabaseOpen()) {
-            continue;
-        }
+            if (!source.settings.allowUseOfSshKey() || !source.settings.addAtDatabaseOpen()) {
+                return false;
+            }
+
+            source.username = e->username();
+            source.password = e->password();
+            source.attachments = QSharedPointer<EntryAttachments>::create();
+            source.attachments->copyDataFrom(e->attachments());
+            sources.append(source);
+            return false;
+        });
+        return false;
+    });
 
-        OpenSSHKey key;
+    if (sources.isEmpty()) {
+        return;
+    }
+
+    // Key decryption (including bcrypt_pbkdf) is expensive, spread it over the thread pool
+    QList<Identity> decoded = AsyncTask::runAndWaitForFuture(
+        [&sources] { return QtConcurrent::blockingMapped<QList<Identity>>(sources, decodeIdentity); });
+
+    if (!widget || widget->isLocked()) {
+        return;
+    }
 
-        if (!settings.toOpenSSHKey(e, key, true)) {
+    QList<Identity> identities;
+    QSet<int> knownKeys;
+    for (const Identity& identity : asConst(decoded)) {
+        if (!identity.error.isEmpty()) {
             continue;
         }
+        // Ignore errors if we have previously added the key
+        if (m_addedKeys.contains(identity.key)) {
+            knownKeys.insert(identities.size());
+        }
+        identities.append(identity);
+    }
+
+    if (identities.isEmpty()) {
+        return;
+    }
 
-        // Add key to agent; ignore errors if we have previously added the key
-        bool known_key = m_addedKeys.contains(key);
-        if (!addIdentity(key, settings, widget->database()->uuid()) && !known_key) {
-            emit error(m_error);
+    addIdentities(identities, db->uuid());
+    for (int i = 0; i < identities.size(); ++i) {
+        if (!identities[i].added && !knownKeys.contains(i)) {
+            emit error(identities[i].error);
         }
     }
 }
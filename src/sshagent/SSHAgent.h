@@ -45,9 +45,18 @@ public:
     void setUseOpenSSH(bool useOpenSSH);
 #endif
 
+    struct Identity
+    {
+        OpenSSHKey key;
+        KeeAgentSettings settings;
+        bool added;
+        QString error;
+    };
+
     const QString errorString() const;
     bool isAgentRunning() const;
     bool addIdentity(OpenSSHKey& key, const KeeAgentSettings& settings, const QUuid& databaseUuid);
+    bool addIdentities(QList<Identity>& identities, const QUuid& databaseUuid);
     bool listIdentities(QList<QSharedPointer<OpenSSHKey>>& list);
     bool checkIdentity(const OpenSSHKey& key, bool& loaded);
     bool removeIdentity(OpenSSHKey& key);
@@ -74,7 +83,10 @@ private:
     const quint8 SSH_AGENT_CONSTRAIN_LIFETIME = 1;
     const quint8 SSH_AGENT_CONSTRAIN_CONFIRM = 2;
 
+    QByteArray addIdentityRequest(OpenSSHKey& key, const KeeAgentSettings& settings) const;
+    QString addIdentityError(const KeeAgentSettings& settings) const;
     bool sendMessage(const QByteArray& in, QByteArray& out);
+    bool sendMessages(const QList<QByteArray>& in, QList<QByteArray>& out);
 #ifdef Q_OS_WIN
     bool sendMessagePageant(const QByteArray& in, QByteArray& out);
 
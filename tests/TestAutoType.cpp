@@ -277,6 +277,60 @@ void TestAutoType::testGlobalAutoTypeRegExp()
     m_test->clearActions();
 }
 
+void TestAutoType::testGlobalAutoTypeIndexUpdate()
+{
+    m_test->setActiveWindowTitle("custom window");
+    m_test->triggerGlobalAutoType();
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("%1association%2").arg(m_entry1->username()).arg(m_entry1->password()));
+    m_test->clearActions();
+
+    // changed associations are picked up right away, without waiting for databaseModified()
+    AutoTypeAssociations::Association association;
+    association.window = "Other * Window";
+    association.sequence = "wildcard";
+    m_entry1->autoTypeAssociations()->update(0, association);
+
+    m_test->setActiveWindowTitle("other test window");
+    m_test->triggerGlobalAutoType();
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("wildcard"));
+    m_test->clearActions();
+
+    // the replaced association no longer matches
+    m_test->setActiveWindowTitle("custom window");
+    m_test->triggerGlobalAutoType();
+    MessageBox::setNextAnswer(MessageBox::Ok);
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString());
+    m_test->clearActions();
+
+    // renamed and added entries are matched by their new titles
+    config()->set(Config::AutoTypeEntryTitleMatch, true);
+    m_entry2->setTitle("renamed title");
+    m_test->setActiveWindowTitle("A Renamed Title!");
+    m_test->triggerGlobalAutoType();
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("%1%2").arg(m_entry2->password(), m_test->keyToString(Qt::Key_Enter)));
+    m_test->clearActions();
+
+    m_test->setActiveWindowTitle("An Entry Title!");
+    m_test->triggerGlobalAutoType();
+    MessageBox::setNextAnswer(MessageBox::Ok);
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString());
+    m_test->clearActions();
+
+    auto entry = new Entry();
+    entry->setPassword("added");
+    entry->setTitle("added title");
+    entry->setGroup(m_group);
+    m_test->setActiveWindowTitle("Some Added Title");
+    m_test->triggerGlobalAutoType();
+    m_autoType->performGlobalAutoType(m_dbList);
+    QCOMPARE(m_test->actionChars(), QString("added%1").arg(m_test->keyToString(Qt::Key_Enter)));
+}
+
 void TestAutoType::testAutoTypeSyntaxChecks()
 {
     // Huge sequence
@@ -47,6 +47,7 @@ private slots:
     void testGlobalAutoTypeUrlSubdomainMatch();
     void testGlobalAutoTypeTitleMatchDisabled();
     void testGlobalAutoTypeRegExp();
+    void testGlobalAutoTypeIndexUpdate();
     void testAutoTypeSyntaxChecks();
     void testAutoTypeEffectiveSequences();
 
@@ -1044,6 +1044,26 @@ void TestCli::testGenerate()
     QCOMPARE(m_stderr->readLine(), QByteArray("Invalid password length bleuh\n"));
 }
 
+void TestCli::testGenerateCount()
+{
+    Generate generateCmd;
+
+    execCmd(generateCmd, {"generate", "-L", "12", "-n", "--count", "25"});
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    const QStringList passwords = QString::fromUtf8(m_stdout->readAll()).split("\n", QString::SkipEmptyParts);
+    QCOMPARE(passwords.size(), 25);
+    QRegularExpression regex("^[0-9]{12}$");
+    for (const QString& password : passwords) {
+        QVERIFY2(regex.match(password).hasMatch(), qPrintable("Password " + password + " does not match"));
+    }
+
+    execCmd(generateCmd, {"generate", "-c", "0"});
+    QCOMPARE(m_stderr->readLine(), QByteArray("Invalid password count 0\n"));
+
+    execCmd(generateCmd, {"generate", "-c", "many"});
+    QCOMPARE(m_stderr->readLine(), QByteArray("Invalid password count many\n"));
+}
+
 void TestCli::testImport()
 {
     Import importCmd;
@@ -61,6 +61,7 @@ private slots:
     void testExport();
     void testGenerate_data();
     void testGenerate();
+    void testGenerateCount();
     void testImport();
     void testInfo();
     void testKeyFileOption();
@@ -18,6 +18,7 @@
 
 #include "TestCsvParser.h"
 
+#include <QElapsedTimer>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestCsvParser)
@@ -344,3 +345,55 @@ void TestCsvParser::testUnicode()
     QVERIFY(t.at(0).at(2) == "3śAż");
     QVERIFY(t.at(0).at(3) == "żac");
 }
+
+void TestCsvParser::testLargeFile()
+{
+    const int rows = 50000;
+    QTextStream out(file.data());
+    out.setCodec("UTF-8");
+    out << "Group,Title,Username,Password,URL,Notes\n";
+    for (int i = 0; i < rows; ++i) {
+        out << "Root/Imported," << "Entry " << i << ",user" << i << QString(",\"pa\"\"ss,w\u00f6rd ") << i
+            << "\",https://example.com/" << i << ",\"line one\nline two\"\n";
+    }
+    out.flush();
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(parser->parse(file.data()));
+    const qint64 elapsed = qMax<qint64>(timer.elapsed(), 1);
+    qInfo("Parsed %d kB in %lld ms", parser->getFileSize() / 1024, elapsed);
+
+    t = parser->getCsvTable();
+    QCOMPARE(t.size(), rows + 1);
+    QCOMPARE(parser->getCsvCols(), 6);
+    QCOMPARE(t.at(rows).at(1), QString("Entry %1").arg(rows - 1));
+    QCOMPARE(t.at(rows).at(3), QString("pa\"ss,w\u00f6rd %1").arg(rows - 1));
+    QCOMPARE(t.at(rows).at(5), QString("line one\nline two"));
+}
+
+void TestCsvParser::benchmarkParse()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    // Roughly 50 MB, the size of a large export from another password manager
+    QTextStream out(file.data());
+    out.setCodec("UTF-8");
+    out << "Group,Title,Username,Password,URL,Notes\n";
+    for (int i = 0; i < 400000; ++i) {
+        out << "Root/Imported," << "Entry " << i << ",user" << i << ",\"pa\"\"ssword " << i
+            << "\",https://example.com/" << i << ",\"" << QString(64, 'x') << "\"\n";
+    }
+    out.flush();
+
+    QVERIFY(parser->parse(file.data()));
+    QBENCHMARK
+    {
+        QVERIFY(parser->reparse());
+    }
+    QCOMPARE(parser->getCsvRows(), 400001);
+}
@@ -23,6 +23,7 @@
 #include <QObject>
 #include <QScopedPointer>
 #include <QTemporaryFile>
+#include <QTextStream>
 
 #include "core/CsvParser.h"
 
@@ -59,6 +60,8 @@ private slots:
     void testQuoted();
     void testMultiline();
     void testColumns();
+    void testLargeFile();
+    void benchmarkParse();
 
 private:
     QScopedPointer<QTemporaryFile> file;
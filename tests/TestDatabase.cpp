@@ -19,22 +19,40 @@
 #include "TestDatabase.h"
 #include "TestGlobal.h"
 
+#include <QElapsedTimer>
+#include <QSaveFile>
 #include <QSignalSpy>
 
 #include "config-keepassx-tests.h"
+#include "core/Config.h"
+#include "core/Entry.h"
+#include "core/FileWatcher.h"
+#include "core/Group.h"
+#include "core/Merger.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
+#include "crypto/kdf/AesKdf.h"
 #include "format/KeePass2Writer.h"
 #include "keys/PasswordKey.h"
+#include "mock/MockClock.h"
 #include "util/TemporaryFile.h"
 
 QTEST_GUILESS_MAIN(TestDatabase)
 
 static QString dbFileName = QStringLiteral(KEEPASSX_TEST_DATA_DIR).append("/NewDatabase.kdbx");
 
+static bool flipFileByte(const QString& fileName, qint64 offset)
+{
+    QFile file(fileName);
+    char byte;
+    return file.open(QIODevice::ReadWrite) && file.seek(offset) && file.getChar(&byte) && file.seek(offset)
+           && file.putChar(static_cast<char>(byte ^ 1));
+}
+
 void TestDatabase::initTestCase()
 {
     QVERIFY(Crypto::init());
+    Config::createTempFileInstance();
 }
 
 void TestDatabase::testOpen()
@@ -95,6 +113,42 @@ void TestDatabase::testSave()
     QVERIFY(!QFile::exists(backupFilePath));
 }
 
+void TestDatabase::testSaveRenewsTransformSeed()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto db = QSharedPointer<Database>::create();
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QString error;
+    QVERIFY(db->open(tempFile.fileName(), key, &error));
+
+    // Uses the seed derived in the background after opening
+    QByteArray seed = db->kdf()->seed();
+    QByteArray transformedKey = db->transformedDatabaseKey();
+    db->metadata()->setName("test");
+    QVERIFY2(db->save(&error), error.toLatin1());
+    QVERIFY(db->kdf()->seed() != seed);
+    QVERIFY(db->transformedDatabaseKey() != transformedKey);
+
+    // Changed KDF parameters invalidate the prepared key
+    seed = db->kdf()->seed();
+    auto kdf = db->kdf()->clone();
+    kdf->setRounds(kdf->rounds() + 1);
+    db->setKdf(kdf);
+    db->metadata()->setName("test2");
+    QVERIFY2(db->save(&error), error.toLatin1());
+    QVERIFY(db->kdf()->seed() != seed);
+
+    auto db2 = QSharedPointer<Database>::create();
+    QVERIFY2(db2->open(tempFile.fileName(), key, &error), error.toLatin1());
+    QCOMPARE(db2->metadata()->name(), QString("test2"));
+    QCOMPARE(db2->kdf()->rounds(), kdf->rounds());
+    QCOMPARE(db2->transformedDatabaseKey(), db->transformedDatabaseKey());
+}
+
 void TestDatabase::testSignals()
 {
     TemporaryFile tempFile;
@@ -131,6 +185,299 @@ void TestDatabase::testSignals()
     QCOMPARE(spyDiscarded.count(), 1);
 }
 
+void TestDatabase::testFileReplaced()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto db = QSharedPointer<Database>::create();
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+    QString error;
+    QVERIFY2(db->open(tempFile.fileName(), key, &error), error.toLatin1());
+
+    QFile source(dbFileName);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+    const QByteArray content = source.readAll();
+
+    // Atomic saves by other applications replace the file, the watch has to survive that
+    QSignalSpy spyFileChanged(db.data(), SIGNAL(databaseFileChanged()));
+    for (int i = 1; i <= 2; ++i) {
+        QSaveFile saveFile(tempFile.fileName());
+        QVERIFY(saveFile.open(QIODevice::WriteOnly));
+        QByteArray changed = content;
+        changed[100] = static_cast<char>(changed[100] ^ i);
+        saveFile.write(changed);
+        QVERIFY(saveFile.commit());
+        QTRY_COMPARE(spyFileChanged.count(), i);
+    }
+}
+
+void TestDatabase::testFileUnchangedNotRehashed()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    // Move the clock past the racy window so the file metadata can be trusted
+    auto clock = new MockClock();
+    clock->advanceMinute(1);
+    MockClock::setup(clock);
+
+    FileWatcher watcher;
+    QSignalSpy spyFileChanged(&watcher, SIGNAL(fileChanged(QString)));
+    watcher.start(tempFile.fileName(), 1, 1);
+    QVERIFY(!watcher.m_fileStamp.isEmpty());
+
+    // A write in place changes the stamp, the file is hashed again
+    QVERIFY(flipFileByte(tempFile.fileName(), 100));
+    QTRY_COMPARE(spyFileChanged.count(), 1);
+    QVERIFY(!watcher.m_fileStamp.isEmpty());
+
+    // Only hashing the file again could notice the replaced checksum
+    watcher.m_fileChecksum = QByteArray("stale");
+    QVERIFY(watcher.hasSameFileChecksum());
+    QTest::qWait(1500);
+    QCOMPARE(spyFileChanged.count(), 1);
+    QCOMPARE(watcher.m_fileChecksum, QByteArray("stale"));
+
+    // Inside the racy window the file is always hashed
+    clock->advanceMinute(-1);
+    QVERIFY(!watcher.hasSameFileChecksum());
+
+    watcher.stop();
+    MockClock::teardown();
+}
+
+void TestDatabase::testFileChangedInPlace()
+{
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.copyFromFile(dbFileName));
+
+    auto db = QSharedPointer<Database>::create();
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+    QString error;
+    QVERIFY2(db->open(tempFile.fileName(), key, &error), error.toLatin1());
+
+    // Rewriting a byte keeps the inode and the size, possibly even the modification time
+    QSignalSpy spyFileChanged(db.data(), SIGNAL(databaseFileChanged()));
+    for (int i = 1; i <= 2; ++i) {
+        QVERIFY(flipFileByte(tempFile.fileName(), 100));
+        QTRY_COMPARE(spyFileChanged.count(), i);
+    }
+}
+
+void TestDatabase::testBulkUpdate()
+{
+    Database db;
+    QSignalSpy spyStarted(&db, SIGNAL(bulkUpdateStarted()));
+    QSignalSpy spyFinished(&db, SIGNAL(bulkUpdateFinished()));
+    QSignalSpy spyModified(&db, SIGNAL(databaseModified()));
+
+    {
+        Database::BulkUpdate bulkUpdate(&db);
+        QVERIFY(db.isBulkUpdating());
+        {
+            Database::BulkUpdate nestedUpdate(&db);
+            for (int i = 0; i < 100; ++i) {
+                auto entry = new Entry();
+                entry->setGroup(db.rootGroup());
+                entry->setTitle(QString("Entry %1").arg(i));
+            }
+        }
+        QVERIFY(db.isBulkUpdating());
+        QTest::qWait(200);
+        QCOMPARE(spyModified.count(), 0);
+    }
+
+    QVERIFY(!db.isBulkUpdating());
+    QCOMPARE(spyStarted.count(), 1);
+    QCOMPARE(spyFinished.count(), 1);
+    QVERIFY(db.isModified());
+    QTRY_COMPARE(spyModified.count(), 1);
+    QTest::qWait(200);
+    QCOMPARE(spyModified.count(), 1);
+}
+
+void TestDatabase::testCommonUsernames()
+{
+    Database db;
+    Group* group = new Group();
+    group->setParent(db.rootGroup());
+
+    auto addEntry = [](Group* parent, const QString& username) -> Entry* {
+        auto entry = new Entry();
+        entry->setUsername(username);
+        entry->setGroup(parent);
+        return entry;
+    };
+
+    addEntry(db.rootGroup(), "alice");
+    Entry* bob = addEntry(group, "bob");
+    addEntry(group, "bob");
+    addEntry(group, "carol");
+    addEntry(group, "");
+    QCOMPARE(db.commonUsernames(), QList<QString>({"bob", "alice", "carol"}));
+    QCOMPARE(db.commonUsernames(2), QList<QString>({"bob", "alice"}));
+
+    // Editing a username moves it in the ranking
+    bob->setUsername("carol");
+    QCOMPARE(db.commonUsernames(), QList<QString>({"carol", "alice", "bob"}));
+
+    // References are not offered
+    Entry* reference = addEntry(db.rootGroup(), QString("{REF:U@I:%1}").arg(bob->uuidToHex()));
+    QCOMPARE(db.commonUsernames(), QList<QString>({"carol", "alice", "bob"}));
+    reference->setUsername("dave");
+    QCOMPARE(db.commonUsernames(), QList<QString>({"carol", "alice", "bob", "dave"}));
+
+    // Removed entries are no longer counted
+    delete bob;
+    QCOMPARE(db.commonUsernames(), QList<QString>({"alice", "bob", "carol", "dave"}));
+
+    // Groups take the usernames of their entries along
+    Database otherDb;
+    group->setParent(otherDb.rootGroup());
+    QCOMPARE(db.commonUsernames(), QList<QString>({"alice", "dave"}));
+    QCOMPARE(otherDb.commonUsernames(), QList<QString>({"bob", "carol"}));
+
+    delete group;
+    QVERIFY(otherDb.commonUsernames().isEmpty());
+
+    // A new root group is indexed from scratch
+    auto root = new Group();
+    addEntry(root, "erin");
+    Group* oldRoot = db.rootGroup();
+    db.setRootGroup(root);
+    delete oldRoot;
+    QCOMPARE(db.commonUsernames(), QList<QString>({"erin"}));
+
+    // Merging an older remote entry over a newer local one replaces its username
+    Entry* local = addEntry(db.rootGroup(), "frank");
+    Database remoteDb;
+    Entry* remote = local->clone(Entry::CloneNoFlags);
+    remote->setUsername("grace");
+    TimeInfo remoteTimeInfo = remote->timeInfo();
+    remoteTimeInfo.setLastModificationTime(local->timeInfo().lastModificationTime().addSecs(-60));
+    remote->setTimeInfo(remoteTimeInfo);
+    remote->setGroup(remoteDb.rootGroup());
+    QCOMPARE(db.commonUsernames(), QList<QString>({"erin", "frank"}));
+
+    Merger merger(&remoteDb, &db);
+    merger.setForcedMergeMode(Group::KeepRemote);
+    merger.merge();
+    QCOMPARE(local->username(), QString("grace"));
+    QCOMPARE(db.commonUsernames(), QList<QString>({"erin", "grace"}));
+}
+
+void TestDatabase::testLazyEntryLoading()
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    auto kdf = QSharedPointer<AesKdf>::create();
+    kdf->setRounds(1);
+
+    auto db = QSharedPointer<Database>::create();
+    db->setKdf(kdf);
+    QVERIFY(db->setKey(key));
+    auto group = new Group();
+    group->setUuid(QUuid::createUuid());
+    group->setName("Lazy");
+    group->setParent(db->rootGroup());
+    for (int i = 0; i < 3; ++i) {
+        auto entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setUsername("frank");
+        entry->setPassword(QString("password %1").arg(i));
+        entry->attachments()->set("shared.txt", QByteArray("shared attachment"));
+        Entry* historyItem = entry->clone(Entry::CloneNoFlags);
+        historyItem->attachments()->set("old.txt", QByteArray("old attachment"));
+        entry->addHistoryItem(historyItem);
+        entry->setGroup(group);
+    }
+    group->setLastTopVisibleEntry(group->entries().at(1));
+
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    tempFile.close();
+    QString error;
+    QVERIFY2(db->saveAs(tempFile.fileName(), &error), error.toLatin1());
+
+    auto eagerDb = QSharedPointer<Database>::create();
+    QVERIFY2(eagerDb->open(tempFile.fileName(), key, &error), error.toLatin1());
+    const Group* eagerGroup = eagerDb->rootGroup()->children().first();
+    QVERIFY(!eagerGroup->hasPendingEntries());
+
+    config()->set(Config::LazyEntryLoading, true);
+    auto lazyDb = QSharedPointer<Database>::create();
+    QVERIFY2(lazyDb->open(tempFile.fileName(), key, &error), error.toLatin1());
+    config()->set(Config::LazyEntryLoading, false);
+
+    const Group* lazyGroup = lazyDb->rootGroup()->children().first();
+    QVERIFY(lazyGroup->hasPendingEntries());
+    QVERIFY(!lazyGroup->isEmpty());
+    QCOMPARE(lazyGroup->name(), QString("Lazy"));
+    const QDateTime lastModified = lazyGroup->timeInfo().lastModificationTime();
+
+    // Usernames are counted, the entry list skips the group and saving streams it without loading
+    QCOMPARE(lazyDb->commonUsernames(), eagerDb->commonUsernames());
+    QVERIFY(lazyDb->entries().isEmpty());
+    TemporaryFile streamedFile;
+    QVERIFY(streamedFile.open());
+    streamedFile.close();
+    QVERIFY2(lazyDb->saveAs(streamedFile.fileName(), &error), error.toLatin1());
+    QVERIFY(lazyGroup->hasPendingEntries());
+
+    auto streamedDb = QSharedPointer<Database>::create();
+    QVERIFY2(streamedDb->open(streamedFile.fileName(), key, &error), error.toLatin1());
+    const Group* streamedGroup = streamedDb->rootGroup()->children().first();
+    QCOMPARE(streamedGroup->entries().size(), 3);
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(streamedGroup->entries().at(i)->equals(eagerGroup->entries().at(i)));
+    }
+    QCOMPARE(streamedGroup->lastTopVisibleEntry(), streamedGroup->entries().at(1));
+
+    // The first access creates the entries without modifying the database
+    QSignalSpy spyModified(lazyDb.data(), SIGNAL(databaseModified()));
+    QCOMPARE(lazyGroup->entries().size(), 3);
+    QVERIFY(!lazyGroup->hasPendingEntries());
+    QVERIFY(!lazyDb->isModified());
+    QCOMPARE(spyModified.count(), 0);
+    QCOMPARE(lazyGroup->timeInfo().lastModificationTime(), lastModified);
+
+    for (int i = 0; i < 3; ++i) {
+        Entry* lazyEntry = lazyGroup->entries().at(i);
+        const Entry* eagerEntry = eagerGroup->entries().at(i);
+        QCOMPARE(lazyEntry->group(), lazyGroup);
+        QCOMPARE(lazyEntry->password(), QString("password %1").arg(i));
+        QCOMPARE(lazyEntry->attachments()->value("shared.txt"), QByteArray("shared attachment"));
+        QCOMPARE(lazyEntry->historyCount(), 1);
+        QCOMPARE(lazyEntry->historyItems().first()->attachments()->value("old.txt"), QByteArray("old attachment"));
+        QVERIFY(lazyEntry->equals(eagerEntry));
+    }
+    QCOMPARE(lazyGroup->lastTopVisibleEntry(), lazyGroup->entries().at(1));
+
+    // Loaded entries replace the recorded usernames
+    QCOMPARE(lazyDb->commonUsernames(), eagerDb->commonUsernames());
+    QCOMPARE(lazyDb->entries().size(), eagerDb->entries().size());
+
+    // Deleting a group that was not accessed records its entries as deleted
+    config()->set(Config::LazyEntryLoading, true);
+    auto deletedDb = QSharedPointer<Database>::create();
+    QVERIFY2(deletedDb->open(tempFile.fileName(), key, &error), error.toLatin1());
+    config()->set(Config::LazyEntryLoading, false);
+    Group* deletedGroup = deletedDb->rootGroup()->children().first();
+    QVERIFY(deletedGroup->hasPendingEntries());
+    QCOMPARE(deletedDb->commonUsernames(), QList<QString>() << "frank");
+    delete deletedGroup;
+    for (const Entry* eagerEntry : eagerGroup->entries()) {
+        QVERIFY(deletedDb->containsDeletedObject(eagerEntry->uuid()));
+    }
+    QVERIFY(deletedDb->containsDeletedObject(eagerGroup->uuid()));
+    QVERIFY(deletedDb->commonUsernames().isEmpty());
+}
+
 void TestDatabase::testEmptyRecycleBinOnDisabled()
 {
     QString filename = QString(KEEPASSX_TEST_DATA_DIR).append("/RecycleBinDisabled.kdbx");
@@ -206,3 +553,76 @@ void TestDatabase::testEmptyRecycleBinWithHierarchicalData()
     writer.writeDatabase(&afterCleanup, db.data());
     QVERIFY(afterCleanup.size() < initialSize);
 }
+
+void TestDatabase::benchmarkOpenLargeDatabase()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    // Cheap key derivation so the benchmark measures parsing and tree construction
+    auto kdf = QSharedPointer<AesKdf>::create();
+    kdf->setRounds(1);
+
+    auto db = QSharedPointer<Database>::create();
+    db->setKdf(kdf);
+    QVERIFY(db->setKey(key));
+    for (int i = 0; i < 20; ++i) {
+        auto group = new Group();
+        group->setUuid(QUuid::createUuid());
+        group->setName(QString("Group %1").arg(i));
+        group->setParent(db->rootGroup());
+        for (int j = 0; j < 2500; ++j) {
+            auto entry = new Entry();
+            entry->setUuid(QUuid::createUuid());
+            entry->setTitle(QString("Entry %1").arg(j));
+            entry->setUsername(QString("user%1").arg(j));
+            entry->setPassword(QString("password %1").arg(j));
+            entry->setUrl(QString("https://example%1.com").arg(j));
+            entry->setGroup(group);
+        }
+    }
+
+    TemporaryFile tempFile;
+    QVERIFY(tempFile.open());
+    tempFile.close();
+    QString error;
+    QVERIFY2(db->saveAs(tempFile.fileName(), &error), error.toLatin1());
+
+    // Time until the first entry of the opened database can be shown, reading all
+    // entries right away and creating them when their group is first accessed
+    const int runs = 5;
+    qint64 elapsed[2] = {0, 0};
+    qint64 allEntriesElapsed = 0;
+    QElapsedTimer timer;
+    for (int run = 0; run < runs; ++run) {
+        for (int lazy = 0; lazy < 2; ++lazy) {
+            config()->set(Config::LazyEntryLoading, lazy == 1);
+            auto db2 = QSharedPointer<Database>::create();
+            timer.start();
+            QVERIFY2(db2->open(tempFile.fileName(), key, &error), error.toLatin1());
+            QCOMPARE(db2->rootGroup()->children().first()->entries().first()->title(), QString("Entry 0"));
+            elapsed[lazy] += timer.elapsed();
+
+            if (lazy == 1) {
+                timer.start();
+                db2->rootGroup()->loadEntriesRecursive();
+                QCOMPARE(db2->entries().size(), 50000);
+                allEntriesElapsed += timer.elapsed();
+            }
+        }
+    }
+    config()->set(Config::LazyEntryLoading, false);
+
+    qInfo("Opened 50000 entries until the first one is shown in %lld ms when reading all entries "
+          "and in %lld ms when loading them lazily, loading the remaining ones took %lld ms",
+          elapsed[0] / runs,
+          elapsed[1] / runs,
+          allEntriesElapsed / runs);
+    QVERIFY(elapsed[1] < elapsed[0]);
+}
@@ -29,11 +29,19 @@ private slots:
     void initTestCase();
     void testOpen();
     void testSave();
+    void testSaveRenewsTransformSeed();
     void testSignals();
+    void testFileReplaced();
+    void testFileUnchangedNotRehashed();
+    void testFileChangedInPlace();
+    void testBulkUpdate();
+    void testCommonUsernames();
+    void testLazyEntryLoading();
     void testEmptyRecycleBinOnDisabled();
     void testEmptyRecycleBinOnNotCreated();
     void testEmptyRecycleBinOnEmpty();
     void testEmptyRecycleBinWithHierarchicalData();
+    void benchmarkOpenLargeDatabase();
 };
 
 #endif // KEEPASSX_TESTDATABASE_H
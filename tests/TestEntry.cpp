@@ -16,13 +16,37 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QFile>
 #include <QScopedPointer>
+#include <QSignalSpy>
 
 #include "TestEntry.h"
 #include "TestGlobal.h"
 #include "core/Clock.h"
+#include "core/Group.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
+#include "crypto/SessionCipher.h"
+#include "format/KdbxXmlWriter.h"
+#include "totp/totp.h"
+
+namespace
+{
+    // Resident set size of the test process in kB, -1 where it is not available
+    qint64 residentSize()
+    {
+        QFile status("/proc/self/status");
+        if (!status.open(QIODevice::ReadOnly)) {
+            return -1;
+        }
+        for (const QByteArray& line : status.readAll().split('\n')) {
+            if (line.startsWith("VmRSS:")) {
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+            }
+        }
+        return -1;
+    }
+} // namespace
 
 QTEST_GUILESS_MAIN(TestEntry)
 
@@ -46,6 +70,446 @@ void TestEntry::testHistoryItemDeletion()
     QVERIFY(historyEntry.isNull());
 }
 
+void TestEntry::testHistoryDataSharing()
+{
+    // Separately allocated copies, as read from a file
+    const QByteArray notes(4096, 'n');
+
+    QScopedPointer<Entry> entry(new Entry());
+    entry->setTitle("title");
+    entry->setNotes(QString::fromLatin1(notes));
+
+    auto historyItem1 = new Entry();
+    historyItem1->setTitle("old title");
+    historyItem1->setNotes(QString::fromLatin1(notes));
+    historyItem1->attributes()->set("attr", QString::fromLatin1("value"));
+
+    auto historyItem2 = new Entry();
+    historyItem2->setTitle("old title");
+    historyItem2->setNotes(QString::fromLatin1(notes));
+    historyItem2->attributes()->set("attr", QString::fromLatin1("other value"));
+
+    QVERIFY(historyItem1->notes().constData() != entry->notes().constData());
+
+    entry->addHistoryItem(historyItem1);
+    entry->addHistoryItem(historyItem2);
+
+    // Equal fields share the storage of the newer version, the content is unchanged
+    QCOMPARE(historyItem1->notes(), entry->notes());
+    QCOMPARE(historyItem1->notes().constData(), entry->notes().constData());
+    QCOMPARE(historyItem2->notes().constData(), entry->notes().constData());
+    QCOMPARE(historyItem1->title().constData(), historyItem2->title().constData());
+    QCOMPARE(historyItem1->title(), QString("old title"));
+    QCOMPARE(historyItem1->attributes()->value("attr"), QString("value"));
+    QCOMPARE(historyItem2->attributes()->value("attr"), QString("other value"));
+    QCOMPARE(entry->title(), QString("title"));
+}
+
+void TestEntry::testSealedAttributes()
+{
+    QScopedPointer<Entry> plainEntry(new Entry());
+    plainEntry->attributes()->set(EntryAttributes::PasswordKey, "secret", true);
+    plainEntry->attributes()->set("custom", "protected value", true);
+    plainEntry->attributes()->set("public", "public value");
+
+    SessionCipher::setEnabled(true);
+
+    QScopedPointer<Entry> entry(new Entry());
+    entry->attributes()->set(EntryAttributes::PasswordKey, "secret", true);
+    entry->attributes()->set("custom", "protected value", true);
+    entry->attributes()->set("public", "public value");
+
+    // Protected values are only held sealed, public ones stay plaintext
+    const QByteArray storedPassword = entry->attributes()->storedValue(EntryAttributes::PasswordKey);
+    const QByteArray storedCustom = entry->attributes()->storedValue("custom");
+    QVERIFY(!storedPassword.isEmpty());
+    QVERIFY(!storedPassword.contains("secret"));
+    QVERIFY(!storedCustom.isEmpty());
+    QVERIFY(!storedCustom.contains("protected value"));
+    QCOMPARE(entry->attributes()->storedValue("public"), QByteArray("public value"));
+
+    // Values set before sealing was enabled stay plaintext and readable
+    QCOMPARE(plainEntry->attributes()->storedValue(EntryAttributes::PasswordKey), QByteArray("secret"));
+    QCOMPARE(plainEntry->attributes()->storedValue("custom"), QByteArray("protected value"));
+    QCOMPARE(plainEntry->password(), QString("secret"));
+    QCOMPARE(plainEntry->attributes()->value("custom"), QString("protected value"));
+    QVERIFY(plainEntry->attributes()->containsValue("protected value"));
+
+    QCOMPARE(entry->password(), QString("secret"));
+    QCOMPARE(entry->attributes()->value("custom"), QString("protected value"));
+    QVERIFY(entry->attributes()->isProtected("custom"));
+    QVERIFY(entry->attributes()->containsValue("protected value"));
+    QVERIFY(entry->attributes()->containsValue("public value"));
+    QVERIFY(!entry->attributes()->containsValue("other value"));
+    QCOMPARE(entry->attributes()->attributesSize(), plainEntry->attributes()->attributesSize());
+
+    // Sealed and plain values compare by content
+    QVERIFY(*entry->attributes() == *plainEntry->attributes());
+    SessionCipher::clearCache();
+    QScopedPointer<Entry> clone(entry->clone(Entry::CloneNoFlags));
+    QVERIFY(*clone->attributes() == *entry->attributes());
+    QCOMPARE(clone->attributes()->value("custom"), QString("protected value"));
+
+    entry->attributes()->set("custom", "changed value", true);
+    QVERIFY(*entry->attributes() != *plainEntry->attributes());
+    QCOMPARE(entry->attributes()->value("custom"), QString("changed value"));
+
+    entry->attributes()->rename("custom", "renamed");
+    QCOMPARE(entry->attributes()->value("renamed"), QString("changed value"));
+    QVERIFY(entry->attributes()->isProtected("renamed"));
+
+    // Unprotecting a value keeps its content
+    entry->attributes()->set("renamed", "changed value", false);
+    QVERIFY(!entry->attributes()->isProtected("renamed"));
+    QCOMPARE(entry->attributes()->value("renamed"), QString("changed value"));
+    QCOMPARE(entry->attributes()->storedValue("renamed"), QByteArray("changed value"));
+
+    SessionCipher::setEnabled(false);
+    QCOMPARE(entry->password(), QString("secret"));
+}
+
+void TestEntry::testCompactHistory()
+{
+    Database db;
+    auto entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    entry->attachments()->set("attachment", QByteArray("data"));
+
+    for (int i = 0; i < 3; ++i) {
+        entry->beginUpdate();
+        entry->setTitle(QString("title %1").arg(i));
+        entry->setPassword(QString("password %1").arg(i));
+        entry->endUpdate();
+    }
+
+    // Items built from the compact form carry all fields again
+    QCOMPARE(entry->historyCount(), 3);
+    const QList<Entry*> history = entry->historyItems();
+    QCOMPARE(history.size(), 3);
+    QCOMPARE(history[0]->title(), QString(""));
+    QCOMPARE(history[1]->title(), QString("title 0"));
+    QCOMPARE(history[2]->password(), QString("password 1"));
+    for (const Entry* historyItem : history) {
+        QCOMPARE(historyItem->uuid(), entry->uuid());
+        QCOMPARE(historyItem->attachments()->value("attachment"), QByteArray("data"));
+    }
+
+    QScopedPointer<Entry> reference(entry->clone(Entry::CloneIncludeHistory));
+    entry->compactHistory();
+    QCOMPARE(entry->historyCount(), 3);
+    QVERIFY(entry->equals(reference.data()));
+
+    // Walking a compact history does not change it
+    QStringList titles;
+    entry->compactHistory();
+    entry->walkHistoryItems([&titles](const Entry* historyItem) -> bool {
+        titles.append(historyItem->title());
+        return false;
+    });
+    QCOMPARE(titles, QStringList() << "" << "title 0" << "title 1");
+    QCOMPARE(entry->historyCount(), 3);
+
+    // Truncating drops the oldest items of the compact form
+    db.metadata()->setHistoryMaxItems(2);
+    entry->truncateHistory();
+    QCOMPARE(entry->historyCount(), 2);
+    QCOMPARE(entry->historyItems().first()->title(), QString("title 0"));
+    QCOMPARE(entry->historyItems().first()->attachments()->value("attachment"), QByteArray("data"));
+
+    entry->compactHistory();
+    QScopedPointer<Entry> clone(entry->clone(Entry::CloneNewUuid | Entry::CloneIncludeHistory));
+    QCOMPARE(clone->historyCount(), 2);
+    QCOMPARE(clone->historyItems().last()->title(), QString("title 1"));
+    QCOMPARE(clone->historyItems().last()->uuid(), clone->uuid());
+}
+
+void TestEntry::testCompactHistoryUpdate()
+{
+    Database db;
+    auto entry = new Entry();
+    entry->setGroup(db.rootGroup());
+    entry->attachments()->set("attachment", QByteArray("data"));
+
+    for (int i = 0; i < 2; ++i) {
+        entry->beginUpdate();
+        entry->setPassword(QString("password %1").arg(i));
+        entry->endUpdate();
+    }
+    entry->compactHistory();
+    QVERIFY(!entry->m_historyMaterialized);
+    QCOMPARE(entry->m_historyDeltas.size(), 2);
+    const EntryAttributes* oldestAttributes = entry->m_historyDeltas.first().attributes.data();
+    QVERIFY(oldestAttributes);
+    QVERIFY(!entry->m_historyDeltas.first().attachments);
+
+    // An edit appends one delta and leaves the older ones alone
+    entry->beginUpdate();
+    entry->setPassword("password 2");
+    entry->endUpdate();
+    QVERIFY(!entry->m_historyMaterialized);
+    QCOMPARE(entry->m_historyDeltas.size(), 3);
+    QCOMPARE(entry->m_historyDeltas.first().attributes.data(), oldestAttributes);
+    QVERIFY(entry->m_historyDeltas.at(1).attributes);
+    QVERIFY(!entry->m_historyDeltas.at(1).attachments);
+    QVERIFY(entry->m_historyDeltas.last().attachments);
+
+    QStringList passwords;
+    entry->walkHistoryItems([&passwords](const Entry* historyItem) -> bool {
+        passwords.append(historyItem->password());
+        return false;
+    });
+    QCOMPARE(passwords, QStringList() << "" << "password 0" << "password 1");
+
+    // Readers do not expand the history
+    QScopedPointer<Entry> reference(entry->clone(Entry::CloneIncludeHistory));
+    QVERIFY(entry->equals(reference.data()));
+    const QList<Entry*> copies = entry->cloneHistoryItems();
+    QCOMPARE(copies.size(), 3);
+    QCOMPARE(copies.last()->password(), QString("password 1"));
+    qDeleteAll(copies);
+    QVERIFY(!db.rootGroup()->walkEntries([](const Entry*) -> bool { return false; }));
+    QCOMPARE(KdbxXmlWriter::attachmentBlobs(&db).size(), 1);
+    QVERIFY(!entry->m_historyMaterialized);
+    QCOMPARE(entry->m_historyDeltas.size(), 3);
+
+    // Editing expands it until it is compacted again
+    entry->historyItems().first()->setNotes("edited");
+    QVERIFY(entry->m_historyMaterialized);
+    entry->compactHistory();
+    QVERIFY(!entry->m_historyMaterialized);
+    QCOMPARE(entry->historyCount(), 3);
+}
+
+void TestEntry::benchmarkHistoryMemory()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    // Entries with ten history items each, every field allocated separately as when reading a file
+    auto createEntries = [](bool compact) -> QList<Entry*> {
+        QList<Entry*> entries;
+        for (int i = 0; i < 5000; ++i) {
+            auto entry = new Entry();
+            entry->setTitle(QString("Entry %1").arg(i));
+            entry->setUsername(QString("user%1").arg(i));
+            entry->setNotes(QString(1024, 'x'));
+            for (int j = 0; j < 10; ++j) {
+                auto historyItem = new Entry();
+                historyItem->setTitle(QString("Entry %1").arg(i));
+                historyItem->setUsername(QString("user%1").arg(i));
+                historyItem->setNotes(QString(1024, 'x'));
+                historyItem->setPassword(QString("password %1").arg(j));
+                entry->addHistoryItem(historyItem);
+            }
+            if (compact) {
+                entry->compactHistory();
+            }
+            entries.append(entry);
+        }
+        return entries;
+    };
+
+    // Entry attributes, attachments, Auto-Type associations and custom data stored for the history
+    auto storedComponents = [](const QList<Entry*>& entries) -> int {
+        int count = 0;
+        for (const Entry* entry : entries) {
+            count += entry->m_history.size() * 4;
+            for (const Entry::HistoryDelta& delta : entry->m_historyDeltas) {
+                count += (delta.attributes ? 1 : 0) + (delta.attachments ? 1 : 0)
+                         + (delta.autoTypeAssociations ? 1 : 0) + (delta.customData ? 1 : 0);
+            }
+        }
+        return count;
+    };
+
+    // The compact entries come first, memory freed while compacting would hide the growth otherwise
+    qint64 before = residentSize();
+    const QList<Entry*> compactEntries = createEntries(true);
+    const qint64 compactGrowth = residentSize() - before;
+
+    before = residentSize();
+    const QList<Entry*> fullEntries = createEntries(false);
+    const qint64 fullGrowth = residentSize() - before;
+
+    // The resident set size depends on the allocator, it is only reported
+    if (before >= 0) {
+        qInfo("Resident set size grew by %lld kB with full history items and by %lld kB with compact ones "
+              "for 5000 entries with 10 history items each",
+              fullGrowth,
+              compactGrowth);
+    }
+
+    // Only the attributes differ between the history items, the other components are stored once per entry
+    const int compactComponents = storedComponents(compactEntries);
+    const int fullComponents = storedComponents(fullEntries);
+    qDeleteAll(compactEntries);
+    qDeleteAll(fullEntries);
+
+    QCOMPARE(fullComponents, 5000 * 10 * 4);
+    QCOMPARE(compactComponents, 5000 * (10 + 3));
+}
+
+void TestEntry::testComponentNotifications()
+{
+    Database db;
+    auto entry = new Entry();
+    entry->setGroup(db.rootGroup());
+
+    // The entry does not connect to its components, they notify it directly
+    QVERIFY(!entry->attributes()->disconnect(entry));
+    QVERIFY(!entry->attachments()->disconnect(entry));
+    QVERIFY(!entry->autoTypeAssociations()->disconnect(entry));
+    QVERIFY(!entry->customData()->disconnect(entry));
+
+    QSignalSpy spyModified(entry, SIGNAL(entryModified()));
+    QSignalSpy spyDataChanged(entry, SIGNAL(entryDataChanged(Entry*)));
+
+    entry->setTitle("Title");
+    QCOMPARE(spyModified.count(), 1);
+    QCOMPARE(spyDataChanged.count(), 1);
+
+    entry->attributes()->set("Custom", "value");
+    QCOMPARE(spyModified.count(), 2);
+
+    entry->attachments()->set("file", "content");
+    QCOMPARE(spyModified.count(), 3);
+
+    AutoTypeAssociations::Association assoc;
+    assoc.window = "window";
+    assoc.sequence = "{USERNAME}";
+    entry->autoTypeAssociations()->add(assoc);
+    QCOMPARE(spyModified.count(), 4);
+
+    entry->customData()->set("key", "value");
+    QCOMPARE(spyModified.count(), 5);
+
+    QVERIFY(!entry->hasTotp());
+    entry->attributes()->set(Totp::ATTRIBUTE_OTP,
+                             "otpauth://totp/ACME%20Co:john@example.com?secret=HXDMVJECJJWSRB3HWIZR4IFUGFTMXBOZ");
+    QVERIFY(entry->hasTotp());
+    entry->attributes()->remove(Totp::ATTRIBUTE_OTP);
+    QVERIFY(!entry->hasTotp());
+
+    // A change to a component alone still creates a history item
+    const int historyCount = entry->historyCount();
+    entry->beginUpdate();
+    entry->attachments()->set("file", "other content");
+    QVERIFY(entry->endUpdate());
+    QCOMPARE(entry->historyCount(), historyCount + 1);
+
+    entry->beginUpdate();
+    entry->attachments()->set("file", "other content");
+    QVERIFY(!entry->endUpdate());
+    QCOMPARE(entry->historyCount(), historyCount + 1);
+}
+
+void TestEntry::benchmarkEntryMemory()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    const int count = 100000;
+    const qint64 before = residentSize();
+    QList<Entry*> entries;
+    for (int i = 0; i < count; ++i) {
+        auto entry = new Entry();
+        entry->setTitle(QString("Entry %1").arg(i));
+        entry->setUsername(QString("user%1").arg(i));
+        entry->setUrl(QString("https://example.com/%1").arg(i));
+        entry->attributes()->set("Custom", QString("value %1").arg(i));
+        entries.append(entry);
+    }
+    const qint64 growth = residentSize() - before;
+
+    // None of the entries holds connection data for its components
+    for (Entry* entry : asConst(entries)) {
+        QVERIFY(!entry->attributes()->disconnect(entry));
+        QVERIFY(!entry->attachments()->disconnect(entry));
+        QVERIFY(!entry->autoTypeAssociations()->disconnect(entry));
+        QVERIFY(!entry->customData()->disconnect(entry));
+    }
+    qDeleteAll(entries);
+
+    // The resident set size depends on the allocator, it is only reported
+    if (before >= 0) {
+        qInfo("Resident set size grew by %lld bytes per entry for %d entries", growth * 1024 / count, count);
+    }
+}
+
+void TestEntry::testAttributeOrder()
+{
+    EntryAttributes attributes;
+    attributes.set("b", "2");
+    attributes.set("A", "1");
+    attributes.set("Website", "3");
+    attributes.set("U", "4");
+
+    QCOMPARE(attributes.keys(),
+             QList<QString>() << "A"
+                              << "Notes"
+                              << "Password"
+                              << "Title"
+                              << "U"
+                              << "URL"
+                              << "UserName"
+                              << "Website"
+                              << "b");
+    QCOMPARE(attributes.customKeys(), QList<QString>() << "A"
+                                                       << "U"
+                                                       << "Website"
+                                                       << "b");
+
+    attributes.rename("A", "c");
+    QCOMPARE(attributes.customKeys(), QList<QString>() << "U"
+                                                       << "Website"
+                                                       << "b"
+                                                       << "c");
+    QCOMPARE(attributes.value("c"), QString("1"));
+
+    attributes.remove("Website");
+    QVERIFY(!attributes.contains("Website"));
+    QCOMPARE(attributes.value("b"), QString("2"));
+    QCOMPARE(attributes.value("U"), QString("4"));
+    QVERIFY(attributes.contains(EntryAttributes::URLKey));
+    QVERIFY(!attributes.contains("url"));
+}
+
+void TestEntry::benchmarkAttributeLookup()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    Entry entry;
+    entry.setTitle("Title");
+    entry.setUsername("user");
+    entry.setUrl("https://example.com");
+    for (int i = 0; i < 10; ++i) {
+        entry.attributes()->set(QString("Custom %1").arg(i), QString("value %1").arg(i));
+    }
+
+    const QString customKey("Custom 5");
+    int size = 0;
+    QBENCHMARK
+    {
+        for (int i = 0; i < 1000; ++i) {
+            size += entry.title().size();
+            size += entry.username().size();
+            size += entry.url().size();
+            size += entry.attributes()->value(customKey).size();
+        }
+    }
+    QVERIFY(size > 0);
+}
+
 void TestEntry::testCopyDataFrom()
 {
     QScopedPointer<Entry> entry(new Entry());
@@ -29,6 +29,15 @@ class TestEntry : public QObject
 private slots:
     void initTestCase();
     void testHistoryItemDeletion();
+    void testHistoryDataSharing();
+    void testSealedAttributes();
+    void testCompactHistory();
+    void testCompactHistoryUpdate();
+    void benchmarkHistoryMemory();
+    void testComponentNotifications();
+    void benchmarkEntryMemory();
+    void testAttributeOrder();
+    void benchmarkAttributeLookup();
     void testCopyDataFrom();
     void testClone();
     void testResolveUrl();
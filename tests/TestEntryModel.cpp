@@ -20,6 +20,7 @@
 
 #include <QSignalSpy>
 
+#include "core/Database.h"
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
 #include "core/Group.h"
@@ -128,6 +129,73 @@ void TestEntryModel::test()
     delete model;
 }
 
+void TestEntryModel::testBulkUpdate()
+{
+    Database db;
+    auto group = new Group();
+    group->setParent(db.rootGroup());
+
+    auto entry1 = new Entry();
+    entry1->setGroup(group);
+    auto entry2 = new Entry();
+    entry2->setGroup(group);
+
+    EntryModel* model = new EntryModel(this);
+    ModelTest* modelTest = new ModelTest(model, this);
+    model->setGroup(group);
+    QCOMPARE(model->rowCount(), 2);
+
+    QSignalSpy spyAboutToAdd(model, SIGNAL(rowsAboutToBeInserted(QModelIndex, int, int)));
+    QSignalSpy spyAboutToRemove(model, SIGNAL(rowsAboutToBeRemoved(QModelIndex, int, int)));
+    QSignalSpy spyDataChanged(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)));
+    QSignalSpy spyReset(model, SIGNAL(modelReset()));
+
+    {
+        Database::BulkUpdate bulkUpdate(&db);
+        for (int i = 0; i < 10; ++i) {
+            auto entry = new Entry();
+            entry->setGroup(group);
+            entry->setTitle(QString("Entry %1").arg(i));
+        }
+        delete entry1;
+        entry2->setTitle("changed");
+        QCOMPARE(spyReset.count(), 0);
+    }
+
+    QCOMPARE(spyAboutToAdd.count(), 0);
+    QCOMPARE(spyAboutToRemove.count(), 0);
+    QCOMPARE(spyDataChanged.count(), 0);
+    QCOMPARE(spyReset.count(), 1);
+    QCOMPARE(model->rowCount(), 11);
+    QCOMPARE(model->data(model->index(0, 1)).toString(), QString("changed"));
+
+    // Search results lose entries deleted during a bulk update
+    auto group2 = new Group();
+    group2->setParent(db.rootGroup());
+    model->setEntries(group->entries());
+    QCOMPARE(model->rowCount(), 11);
+    {
+        Database::BulkUpdate bulkUpdate(&db);
+        delete entry2;
+    }
+    QCOMPARE(model->rowCount(), 10);
+
+    // ...but keep entries that are only relocated, as a merge does
+    Entry* relocated = group->entries().first();
+    {
+        Database::BulkUpdate bulkUpdate(&db);
+        relocated->setGroup(group2);
+    }
+    QCOMPARE(model->rowCount(), 10);
+    QVERIFY(model->indexFromEntry(relocated).isValid());
+
+    delete relocated;
+    QCOMPARE(model->rowCount(), 9);
+
+    delete modelTest;
+    delete model;
+}
+
 void TestEntryModel::testAttachmentsModel()
 {
     EntryAttachments* entryAttachments = new EntryAttachments(this);
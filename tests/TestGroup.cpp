@@ -108,6 +108,25 @@ void TestGroup::testParenting()
     QVERIFY(db->rootGroup()->children().at(1) == g6);
     QVERIFY(db->rootGroup()->children().at(2) == g5);
 
+    QCOMPARE(db->rootGroup()->indexInParent(), -1);
+    QCOMPARE(g1->indexInParent(), 0);
+    QCOMPARE(g6->indexInParent(), 1);
+    QCOMPARE(g5->indexInParent(), 2);
+    QCOMPARE(g3->indexInParent(), 1);
+
+    g5->setParent(db->rootGroup(), 0);
+    QCOMPARE(g5->indexInParent(), 0);
+    QCOMPARE(g1->indexInParent(), 1);
+    QCOMPARE(g6->indexInParent(), 2);
+
+    g2->setParent(g3);
+    QCOMPARE(g3->indexInParent(), 0);
+    QCOMPARE(g4->indexInParent(), 0);
+    QCOMPARE(g2->indexInParent(), 1);
+    g2->setParent(g1, 0);
+    QCOMPARE(g2->indexInParent(), 0);
+    QCOMPARE(g3->indexInParent(), 1);
+
     QSignalSpy spy(db, SIGNAL(groupDataChanged(Group*)));
     g2->setName("test");
     g4->setName("test");
@@ -953,6 +972,9 @@ void TestGroup::testChildrenSort()
     QCOMPARE(children[7]->name(), QString("Test12"));
     QCOMPARE(children[8]->name(), QString("Test999"));
     QCOMPARE(children[9]->name(), QString("z"));
+    for (int i = 0; i < children.size(); ++i) {
+        QCOMPARE(children[i]->indexInParent(), i);
+    }
     children = subParent->children();
     QCOMPARE(children.size(), 9);
     QCOMPARE(children[0]->name(), QString("sub_000"));
@@ -1081,6 +1103,24 @@ void TestGroup::testHierarchy()
     QVERIFY(hierarchy.size() == 2);
     QVERIFY(hierarchy.contains("group2"));
     QVERIFY(hierarchy.contains("group3"));
+
+    QCOMPARE(group3->fullPath(), group3->hierarchy().join('/'));
+    QCOMPARE(group3->fullPath(), QString("group1/group2/group3"));
+
+    // Renaming and moving a group updates the paths of all its descendants
+    group2->setName("renamed");
+    QCOMPARE(group2->fullPath(), QString("group1/renamed"));
+    QCOMPARE(group3->fullPath(), QString("group1/renamed/group3"));
+
+    Group* group4 = new Group();
+    group4->setName("group4");
+    group4->setParent(&group1);
+    group2->setParent(group4);
+    QCOMPARE(group3->fullPath(), QString("group1/group4/renamed/group3"));
+
+    QScopedPointer<Group> clone(group4->clone());
+    QCOMPARE(clone->fullPath(), QString("group4"));
+    QCOMPARE(clone->children().first()->children().first()->fullPath(), QString("group4/renamed/group3"));
 }
 
 void TestGroup::testApplyGroupIconRecursively()
@@ -1319,3 +1359,65 @@ void TestGroup::testMove()
     QCOMPARE(root->entries().at(2), entry1);
     QCOMPARE(root->entries().at(3), entry0);
 }
+
+void TestGroup::testWalk()
+{
+    Database database;
+    Group* root = database.rootGroup();
+
+    Group* group1 = new Group();
+    group1->setParent(root);
+    Group* group11 = new Group();
+    group11->setParent(group1);
+    Group* group2 = new Group();
+    group2->setParent(root);
+
+    Entry* entry0 = new Entry();
+    entry0->setGroup(root);
+    Entry* entry11 = new Entry();
+    entry11->setGroup(group11);
+    Entry* entry2 = new Entry();
+    entry2->setGroup(group2);
+    Entry* entry1 = new Entry();
+    entry1->setGroup(group1);
+
+    Entry* historyItem = new Entry();
+    entry1->addHistoryItem(historyItem);
+
+    // Pre-order, same as the list based accessors
+    QList<Group*> groups;
+    QVERIFY(!root->walkGroups([&groups](Group* group) -> bool {
+        groups.append(group);
+        return false;
+    }));
+    QCOMPARE(groups, QList<Group*>() << root << group1 << group11 << group2);
+    QCOMPARE(groups, root->groupsRecursive(true));
+    QCOMPARE(root->groupsRecursive(false), QList<Group*>() << group1 << group11 << group2);
+
+    QCOMPARE(root->entriesRecursive(), QList<Entry*>() << entry0 << entry1 << entry11 << entry2);
+    // History items are not part of the walk
+    QVERIFY(!root->entriesRecursive().contains(historyItem));
+    QCOMPARE(entry1->historyCount(), 1);
+
+    // The walk stops as soon as the visitor returns true
+    int visited = 0;
+    QVERIFY(root->walkEntries([&visited, entry11](const Entry* entry) -> bool {
+        ++visited;
+        return entry == entry11;
+    }));
+    QCOMPARE(visited, 3);
+
+    QCOMPARE(root->findEntryByUuid(entry2->uuid()), entry2);
+    QCOMPARE(root->findGroupByUuid(group11->uuid()), group11);
+
+    // The database entry list follows structure changes
+    QCOMPARE(database.entries(), root->entriesRecursive());
+    entry0->setGroup(group2);
+    QCOMPARE(database.entries(), QList<Entry*>() << entry1 << entry11 << entry2 << entry0);
+    group2->setParent(group1, 0);
+    QCOMPARE(database.entries(), QList<Entry*>() << entry1 << entry2 << entry0 << entry11);
+    group2->moveEntryUp(entry0);
+    QCOMPARE(database.entries(), QList<Entry*>() << entry1 << entry0 << entry2 << entry11);
+    delete group1;
+    QVERIFY(database.entries().isEmpty());
+}
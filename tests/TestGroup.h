@@ -50,6 +50,7 @@ private slots:
     void testApplyGroupIconRecursively();
     void testUsernamesRecursive();
     void testMove();
+    void testWalk();
 };
 
 #endif // KEEPASSX_TESTGROUP_H
@@ -148,3 +148,91 @@ void TestGroupModel::test()
     delete modelTest;
     delete model;
 }
+
+void TestGroupModel::testFetchMore()
+{
+    Database* db = new Database();
+    Group* groupRoot = db->rootGroup();
+    groupRoot->setName("groupRoot");
+
+    Group* group1 = new Group();
+    group1->setName("group1");
+    group1->setParent(groupRoot);
+
+    Group* group11 = new Group();
+    group11->setName("group11");
+    group11->setParent(group1);
+
+    Group* group2 = new Group();
+    group2->setName("group2");
+    group2->setParent(groupRoot);
+
+    GroupModel* model = new GroupModel(db, this);
+
+    // only the root group has a row until groups are fetched
+    QModelIndex indexRoot = model->index(0, 0);
+    QCOMPARE(model->rowCount(), 1);
+    QCOMPARE(model->rowCount(indexRoot), 0);
+    QVERIFY(model->hasChildren(indexRoot));
+    QVERIFY(model->canFetchMore(indexRoot));
+
+    QSignalSpy spyAdded(model, SIGNAL(rowsInserted(QModelIndex, int, int)));
+    QSignalSpy spyRemoved(model, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+    QSignalSpy spyMoved(model, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)));
+
+    model->fetchMore(indexRoot);
+    QCOMPARE(spyAdded.count(), 1);
+    QCOMPARE(spyAdded.at(0).at(1).toInt(), 0);
+    QCOMPARE(spyAdded.at(0).at(2).toInt(), 1);
+    QVERIFY(!model->canFetchMore(indexRoot));
+    QCOMPARE(model->rowCount(indexRoot), 2);
+
+    QModelIndex index1 = model->index(0, 0, indexRoot);
+    QModelIndex index2 = model->index(1, 0, indexRoot);
+    QCOMPARE(model->rowCount(index1), 0);
+    QVERIFY(model->canFetchMore(index1));
+    QVERIFY(!model->hasChildren(index2));
+    QVERIFY(!model->canFetchMore(index2));
+
+    // changes below groups that were not fetched yet are not signaled
+    Group* group12 = new Group();
+    group12->setName("group12");
+    group12->setParent(group1);
+    QCOMPARE(spyAdded.count(), 1);
+    QCOMPARE(model->rowCount(index1), 0);
+
+    // an empty group does not need to be fetched
+    Group* group21 = new Group();
+    group21->setName("group21");
+    group21->setParent(group2);
+    QCOMPARE(spyAdded.count(), 2);
+    QCOMPARE(model->rowCount(index2), 1);
+
+    // moving out of a group that was not fetched inserts the row
+    group11->setParent(group2, 0);
+    QCOMPARE(spyAdded.count(), 3);
+    QCOMPARE(spyMoved.count(), 0);
+    QCOMPARE(model->rowCount(index2), 2);
+    QCOMPARE(model->data(model->index(0, 0, index2)).toString(), QString("group11"));
+
+    // moving into a group that was not fetched removes the row
+    group21->setParent(group1);
+    QCOMPARE(spyRemoved.count(), 1);
+    QCOMPARE(spyMoved.count(), 0);
+    QCOMPARE(model->rowCount(index2), 1);
+
+    group11->setParent(groupRoot);
+    QCOMPARE(spyMoved.count(), 1);
+    QCOMPARE(model->rowCount(indexRoot), 3);
+
+    // looking up a group fetches its parents
+    QModelIndex index21 = model->index(group21);
+    QVERIFY(index21.isValid());
+    QCOMPARE(index21.row(), 1);
+    QCOMPARE(index21.parent(), index1);
+    QCOMPARE(model->rowCount(index1), 2);
+    QCOMPARE(model->data(index21).toString(), QString("group21"));
+
+    delete model;
+    delete db;
+}
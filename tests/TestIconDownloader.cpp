@@ -0,0 +1,236 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestIconDownloader.h"
+
+#include "core/Config.h"
+#include "core/Global.h"
+#include "core/IconDownloadQueue.h"
+#include "core/IconDownloader.h"
+
+#include <QBuffer>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+#include <QTimer>
+
+QTEST_GUILESS_MAIN(TestIconDownloader)
+
+namespace
+{
+    /*
+     * Minimal stand-in for a web server on the loopback interface.
+     *
+     * Answers requests for /favicon.ico with the given icon, or with 404 if
+     * there is none, after an optional delay. Requests answered at the same
+     * time are counted over all instances.
+     */
+    class IconServer
+    {
+    public:
+        explicit IconServer(const QImage& icon, int delay = 0)
+            : m_delay(delay)
+        {
+            if (!icon.isNull()) {
+                QBuffer buffer(&m_icon);
+                buffer.open(QIODevice::WriteOnly);
+                icon.save(&buffer, "PNG");
+            }
+
+            QObject::connect(&m_server, &QTcpServer::newConnection, [this] {
+                while (m_server.hasPendingConnections()) {
+                    auto socket = m_server.nextPendingConnection();
+                    QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket] { readRequest(socket); });
+                    QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                }
+            });
+            m_server.listen(QHostAddress::LocalHost);
+        }
+
+        QString url(const QString& path = {}) const
+        {
+            return QString("http://127.0.0.1:%1%2").arg(m_server.serverPort()).arg(path);
+        }
+
+        QStringList requests;
+        static int active;
+        static int maxActive;
+
+    private:
+        void readRequest(QTcpSocket* socket)
+        {
+            // Wait for the complete request header
+            const auto request = socket->property("request").toByteArray() + socket->readAll();
+            socket->setProperty("request", request);
+            if (!request.contains("\r\n\r\n") || socket->property("answered").toBool()) {
+                return;
+            }
+            socket->setProperty("answered", true);
+
+            const auto path = QString::fromLatin1(request.split(' ').value(1));
+            requests << path;
+            maxActive = qMax(maxActive, ++active);
+
+            QTimer::singleShot(m_delay, socket, [this, socket, path] {
+                --active;
+                if (path == "/favicon.ico" && !m_icon.isEmpty()) {
+                    socket->write("HTTP/1.1 200 OK\r\nContent-Type: image/png\r\nContent-Length: "
+                                  + QByteArray::number(m_icon.size()) + "\r\nConnection: close\r\n\r\n" + m_icon);
+                } else {
+                    socket->write("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+                }
+                socket->disconnectFromHost();
+            });
+        }
+
+        QTcpServer m_server;
+        QByteArray m_icon;
+        int m_delay;
+    };
+
+    int IconServer::active = 0;
+    int IconServer::maxActive = 0;
+
+    QImage createIcon(int size)
+    {
+        QImage icon(size, size, QImage::Format_ARGB32);
+        icon.fill(Qt::darkGreen);
+        return icon;
+    }
+} // namespace
+
+void TestIconDownloader::initTestCase()
+{
+    Config::createTempFileInstance();
+    // Only talk to the local stand-in servers
+    config()->set(Config::Security_IconDownloadFallback, false);
+}
+
+void TestIconDownloader::testSiteKey()
+{
+    QCOMPARE(IconDownloadQueue::siteKey("https://example.com/login?next=1"), QString("https://example.com"));
+    QCOMPARE(IconDownloadQueue::siteKey("HTTPS://user@Example.COM:8443/path#top"),
+             QString("https://example.com:8443"));
+    QCOMPARE(IconDownloadQueue::siteKey("http://example.com"), QString("http://example.com"));
+    QCOMPARE(IconDownloadQueue::siteKey("example.com/path"), QString("https://example.com"));
+    QCOMPARE(IconDownloadQueue::siteKey("https://sub.example.com"), QString("https://sub.example.com"));
+    QVERIFY(IconDownloadQueue::siteKey("").isEmpty());
+    QVERIFY(IconDownloadQueue::siteKey("file:///tmp/icon.png").isEmpty());
+}
+
+void TestIconDownloader::testDownload()
+{
+    IconServer server(createIcon(256));
+
+    IconDownloader downloader;
+    QSignalSpy spy(&downloader, SIGNAL(finished(const QString&, const QImage&)));
+    downloader.setUrl(server.url("/login"));
+    QCOMPARE(downloader.host(), QString("127.0.0.1"));
+
+    downloader.download();
+    QTRY_COMPARE(spy.count(), 1);
+
+    // Large icons are scaled down by the downloader
+    QCOMPARE(spy.first().at(0).toString(), server.url("/login"));
+    QCOMPARE(spy.first().at(1).value<QImage>().size(), QSize(128, 128));
+    QCOMPARE(server.requests, QStringList() << "/favicon.ico");
+}
+
+void TestIconDownloader::testSharedDownload()
+{
+    IconServer server1(createIcon(16));
+    IconServer server2(createIcon(32));
+
+    IconDownloadQueue queue;
+    QSignalSpy finishedSpy(&queue, SIGNAL(finished(const QStringList&, const QImage&)));
+    QSignalSpy allFinishedSpy(&queue, SIGNAL(allFinished()));
+
+    const QStringList urls1 = {server1.url("/login"), server1.url("/account?id=1"), server1.url()};
+    const QStringList urls2 = {server2.url("/")};
+    for (const auto& url : urls1 + urls2) {
+        queue.add(url);
+    }
+    queue.add(server1.url("/login"));
+    QCOMPARE(queue.urlsRemaining(), 4);
+
+    queue.download();
+    QTRY_COMPARE(allFinishedSpy.count(), 1);
+    QCOMPARE(queue.urlsRemaining(), 0);
+
+    // Every site was fetched once and its result shared by all of its URLs
+    QCOMPARE(finishedSpy.count(), 2);
+    for (const auto& signal : asConst(finishedSpy)) {
+        const auto urls = signal.at(0).toStringList();
+        const auto size = signal.at(1).value<QImage>().size();
+        if (urls == urls1) {
+            QCOMPARE(size, QSize(16, 16));
+        } else {
+            QCOMPARE(urls, urls2);
+            QCOMPARE(size, QSize(32, 32));
+        }
+    }
+    QCOMPARE(server1.requests, QStringList() << "/favicon.ico");
+    QCOMPARE(server2.requests, QStringList() << "/favicon.ico");
+}
+
+void TestIconDownloader::testDownloadFailed()
+{
+    const QImage noIcon;
+    IconServer server(noIcon);
+
+    IconDownloadQueue queue;
+    QSignalSpy finishedSpy(&queue, SIGNAL(finished(const QStringList&, const QImage&)));
+    QSignalSpy allFinishedSpy(&queue, SIGNAL(allFinished()));
+    queue.add("file:///tmp/icon.png");
+    queue.add(server.url("/login"));
+
+    // URLs without a host fail right away
+    queue.download();
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(finishedSpy.first().at(0).toStringList(), QStringList() << "file:///tmp/icon.png");
+    QVERIFY(finishedSpy.first().at(1).value<QImage>().isNull());
+
+    QTRY_COMPARE(allFinishedSpy.count(), 1);
+    QCOMPARE(finishedSpy.count(), 2);
+    QCOMPARE(finishedSpy.last().at(0).toStringList(), QStringList() << server.url("/login"));
+    QVERIFY(finishedSpy.last().at(1).value<QImage>().isNull());
+    QCOMPARE(server.requests, QStringList() << "/favicon.ico");
+}
+
+void TestIconDownloader::testHostLimit()
+{
+    // Both servers run on the same host
+    IconServer server1(createIcon(16), 200);
+    IconServer server2(createIcon(16), 200);
+    IconServer::active = 0;
+    IconServer::maxActive = 0;
+
+    IconDownloadQueue queue;
+    QSignalSpy finishedSpy(&queue, SIGNAL(finished(const QStringList&, const QImage&)));
+    QSignalSpy allFinishedSpy(&queue, SIGNAL(allFinished()));
+    queue.setMaxDownloadsPerHost(1);
+    queue.add(server1.url());
+    queue.add(server2.url());
+
+    queue.download();
+    QTRY_COMPARE(allFinishedSpy.count(), 1);
+    QCOMPARE(finishedSpy.count(), 2);
+    QCOMPARE(IconServer::maxActive, 1);
+    QCOMPARE(server1.requests.size(), 1);
+    QCOMPARE(server2.requests.size(), 1);
+}
@@ -19,9 +19,13 @@
 #include "TestGlobal.h"
 #include "mock/MockClock.h"
 
+#include <QThread>
+
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
+#include "crypto/CryptoHash.h"
 #include "format/KdbxXmlReader.h"
+#include "format/KeePass2Reader.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
 #include "mock/MockChallengeResponseKey.h"
@@ -194,7 +198,7 @@ void TestKeePass2Format::testXmlGroup2()
 
 void TestKeePass2Format::testXmlEntry1()
 {
-    const Entry* entry = m_xmlDb->rootGroup()->entries().at(0);
+    Entry* entry = m_xmlDb->rootGroup()->entries().at(0);
 
     QCOMPARE(entry->uuid(), QUuid::fromRfc4122(QByteArray::fromBase64("+wSUOv6qf0OzW8/ZHAs2sA==")));
     QCOMPARE(entry->historyItems().size(), 2);
@@ -304,7 +308,7 @@ void TestKeePass2Format::testXmlEntry2()
 
 void TestKeePass2Format::testXmlEntryHistory()
 {
-    const Entry* entryMain = m_xmlDb->rootGroup()->entries().at(0);
+    Entry* entryMain = m_xmlDb->rootGroup()->entries().at(0);
     QCOMPARE(entryMain->historyItems().size(), 2);
 
     {
@@ -800,6 +804,86 @@ void TestKeePass2Format::testDuplicateAttachments()
     QCOMPARE(db->rootGroup()->entries()[2]->attachments()->value("c1"), attachment2);
     QCOMPARE(db->rootGroup()->entries()[2]->attachments()->value("c2"), attachment2);
     QCOMPARE(db->rootGroup()->entries()[2]->attachments()->value("c3"), attachment3);
+
+    // Identical content is read into a single shared blob
+    const auto blob = db->rootGroup()->entries()[0]->attachments()->blob("a");
+    QVERIFY(blob);
+    QCOMPARE(blob->digest(), CryptoHash::hash(attachment1, CryptoHash::Sha256));
+    QCOMPARE(db->rootGroup()->entries()[1]->attachments()->blob("b2"), blob);
+    QCOMPARE(db->rootGroup()->entries()[1]->historyItems()[2]->attachments()->blob("b1"), blob);
+}
+
+void TestKeePass2Format::testKdbxManyEntries()
+{
+    // Enough entries in nested groups to be built on several threads, attached in document order
+    auto sourceDb = QSharedPointer<Database>::create();
+    sourceDb->setKey(QSharedPointer<CompositeKey>::create());
+
+    Group* parent = sourceDb->rootGroup();
+    for (int i = 0; i < 10; ++i) {
+        auto group = new Group();
+        group->setUuid(QUuid::createUuid());
+        group->setName(QString("Group %1").arg(i));
+        group->setParent(i % 2 == 0 ? sourceDb->rootGroup() : parent);
+        parent = group;
+
+        for (int j = 0; j < 50; ++j) {
+            auto entry = new Entry();
+            entry->setUuid(QUuid::createUuid());
+            entry->setGroup(group);
+            entry->setTitle(QString("Entry %1-%2").arg(i).arg(j));
+            entry->setPassword(QString("pass\r\nword %1").arg(j));
+            entry->setNotes("line 1\nline 2 & <3>");
+            entry->attributes()->set("custom", QString("value %1").arg(j), j % 2 == 0);
+            entry->beginUpdate();
+            entry->setUsername(QString("user %1").arg(j));
+            entry->endUpdate();
+        }
+    }
+
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+
+    bool hasError = false;
+    QString errorString;
+    writeKdbx(&buffer, sourceDb.data(), hasError, errorString);
+    if (hasError) {
+        QFAIL(qPrintable(QString("Error while writing database: %1").arg(errorString)));
+    }
+
+    buffer.seek(0);
+    auto targetDb = QSharedPointer<Database>::create();
+    KeePass2Reader reader;
+    reader.setParallelParsing(true);
+    reader.readDatabase(&buffer, QSharedPointer<CompositeKey>::create(), targetDb.data());
+    if (reader.hasError()) {
+        QFAIL(qPrintable(QString("Error while reading database: %1").arg(reader.errorString())));
+    }
+
+    const QList<Group*> sourceGroups = sourceDb->rootGroup()->groupsRecursive(true);
+    const QList<Group*> targetGroups = targetDb->rootGroup()->groupsRecursive(true);
+    QCOMPARE(targetGroups.size(), sourceGroups.size());
+    for (int i = 0; i < sourceGroups.size(); ++i) {
+        QCOMPARE(targetGroups[i]->uuid(), sourceGroups[i]->uuid());
+
+        const QList<Entry*> sourceEntries = sourceGroups[i]->entries();
+        const QList<Entry*> targetEntries = targetGroups[i]->entries();
+        QCOMPARE(targetEntries.size(), sourceEntries.size());
+        for (int j = 0; j < sourceEntries.size(); ++j) {
+            Entry* source = sourceEntries[j];
+            Entry* target = targetEntries[j];
+            QCOMPARE(target->uuid(), source->uuid());
+            QCOMPARE(target->title(), source->title());
+            QCOMPARE(target->username(), source->username());
+            QCOMPARE(target->password(), source->password());
+            QCOMPARE(target->notes(), source->notes());
+            QCOMPARE(target->attributes()->value("custom"), source->attributes()->value("custom"));
+            QCOMPARE(target->attributes()->isProtected("custom"), source->attributes()->isProtected("custom"));
+            QCOMPARE(target->historyItems().size(), source->historyItems().size());
+            QCOMPARE(target->historyItems()[0]->password(), source->historyItems()[0]->password());
+            QCOMPARE(target->thread(), QThread::currentThread());
+        }
+    }
 }
 
 /**
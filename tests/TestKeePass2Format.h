@@ -65,6 +65,7 @@ private slots:
     void testKdbxKeyChange();
     void testKdbxKeyChange_data();
     void testDuplicateAttachments();
+    void testKdbxManyEntries();
 
 protected:
     virtual void initTestCaseImpl() = 0;
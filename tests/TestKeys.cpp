@@ -36,6 +36,27 @@
 QTEST_GUILESS_MAIN(TestKeys)
 Q_DECLARE_METATYPE(FileKey::Type);
 
+namespace
+{
+    // AES-KDF that counts how often the key derivation actually runs
+    class CountingAesKdf : public AesKdf
+    {
+    public:
+        explicit CountingAesKdf(bool legacyKdbx3 = false)
+            : AesKdf(legacyKdbx3)
+        {
+        }
+
+        bool transform(const QByteArray& raw, QByteArray& result) const override
+        {
+            ++transformCount;
+            return AesKdf::transform(raw, result);
+        }
+
+        mutable int transformCount = 0;
+    };
+} // namespace
+
 void TestKeys::initTestCase()
 {
     QVERIFY(Crypto::init());
@@ -217,10 +238,74 @@ void TestKeys::benchmarkTransformKey()
 
     QBENCHMARK
     {
+        // A new seed on every run bypasses the transformed key cache
+        kdf.randomizeSeed();
         Q_UNUSED(compositeKey->transform(kdf, result));
     };
 }
 
+void TestKeys::testTransformCache()
+{
+    auto compositeKey = QSharedPointer<CompositeKey>::create();
+    compositeKey->addKey(QSharedPointer<PasswordKey>::create("password"));
+
+    CountingAesKdf kdf;
+    kdf.setSeed(QByteArray(32, '\x4B'));
+    kdf.setRounds(1000);
+
+    QByteArray result1;
+    QByteArray result2;
+    QVERIFY(compositeKey->transform(kdf, result1));
+    QCOMPARE(kdf.transformCount, 1);
+    QVERIFY(compositeKey->transform(kdf, result2));
+    QCOMPARE(kdf.transformCount, 1);
+    QCOMPARE(result2, result1);
+
+    QByteArray expected;
+    QVERIFY(kdf.AesKdf::transform(compositeKey->rawKey(), expected));
+    QCOMPARE(result1, expected);
+
+    // Results are copies, wiping them leaves the cached key intact
+    result1.fill('\0');
+    result2.fill('\0');
+    QVERIFY(compositeKey->transform(kdf, result1));
+    QCOMPARE(kdf.transformCount, 1);
+    QCOMPARE(result1, expected);
+
+    // The legacy KDBX3 path is cached as well
+    CountingAesKdf legacyKdf(true);
+    legacyKdf.setSeed(kdf.seed());
+    legacyKdf.setRounds(1000);
+    QVERIFY(compositeKey->transform(legacyKdf, result2));
+    QVERIFY(compositeKey->transform(legacyKdf, result2));
+    QCOMPARE(legacyKdf.transformCount, 1);
+
+    // Every KDF parameter is part of the cache key
+    AesKdf otherRounds;
+    otherRounds.setSeed(kdf.seed());
+    otherRounds.setRounds(1001);
+    QVERIFY(compositeKey->transform(otherRounds, result2));
+    QVERIFY(result2 != result1);
+
+    AesKdf otherSeed;
+    otherSeed.setSeed(QByteArray(32, '\x4C'));
+    otherSeed.setRounds(1000);
+    QVERIFY(compositeKey->transform(otherSeed, result2));
+    QVERIFY(result2 != result1);
+
+    // Adding a key component changes the result
+    compositeKey->addKey(QSharedPointer<PasswordKey>::create("other"));
+    QVERIFY(compositeKey->transform(kdf, result2));
+    QCOMPARE(kdf.transformCount, 2);
+    QVERIFY(result2 != result1);
+
+    // Transformations including challenge-response components always run the KDF
+    compositeKey->addChallengeResponseKey(QSharedPointer<MockChallengeResponseKey>::create(QByteArray("response")));
+    QVERIFY(compositeKey->transform(kdf, result1));
+    QVERIFY(compositeKey->transform(kdf, result1));
+    QCOMPARE(kdf.transformCount, 4);
+}
+
 void TestKeys::testCompositeKeyComponents()
 {
     auto passwordKeyEnc = QSharedPointer<PasswordKey>::create("password");
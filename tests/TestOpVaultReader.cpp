@@ -32,6 +32,7 @@
 #include <QList>
 #include <QPair>
 #include <QStringList>
+#include <QTemporaryDir>
 #include <QTest>
 #include <QUuid>
 
@@ -134,3 +135,71 @@ void TestOpVaultReader::testReadIntoDatabase()
         QVERIFY2(!group->isEmpty(), qPrintable(QStringLiteral("Group %1 is empty").arg(group->name())));
     }
 }
+
+void TestOpVaultReader::benchmarkReadLargeVault()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    // Item keys and data are not bound to the item UUID, so copies of the
+    // sample items under new UUIDs make a valid vault of any size
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QDir opVaultDir(tempDir.path());
+    QVERIFY(opVaultDir.mkpath("large.opvault/default"));
+    QVERIFY(opVaultDir.cd("large.opvault"));
+
+    int sampleEntries = 0;
+    {
+        QDir sampleDir(m_opVaultPath);
+        OpVaultReader reader;
+        QScopedPointer<Database> db(reader.readDatabase(sampleDir, "a"));
+        QVERIFY(db);
+        sampleEntries = db->rootGroup()->entriesRecursive().size();
+    }
+
+    const QDir sourceDir(m_opVaultPath + "/default");
+    const int copies = 1000;
+    for (const QString& fileName : sourceDir.entryList(QDir::Files)) {
+        const QString sourcePath = sourceDir.absoluteFilePath(fileName);
+        const QString targetPath = opVaultDir.absoluteFilePath("default/" + fileName);
+        if (!fileName.startsWith("band_")) {
+            QVERIFY(QFile::copy(sourcePath, targetPath));
+            continue;
+        }
+
+        QFile source(sourcePath);
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        QByteArray payload = source.readAll().trimmed();
+        payload = payload.mid(3, payload.size() - 5);
+        const QJsonObject band = QJsonDocument::fromJson(payload).object();
+        QVERIFY(!band.isEmpty());
+
+        QJsonObject largeBand;
+        for (const QJsonValue& value : band) {
+            for (int i = 0; i < copies; ++i) {
+                QJsonObject item = value.toObject();
+                const QString uuid = QString::fromLatin1(QUuid::createUuid().toRfc4122().toHex().toUpper());
+                item["uuid"] = uuid;
+                largeBand[uuid] = item;
+            }
+        }
+
+        QFile target(targetPath);
+        QVERIFY(target.open(QIODevice::WriteOnly));
+        target.write("ld(" + QJsonDocument(largeBand).toJson(QJsonDocument::Compact) + ");");
+    }
+
+    int entries = 0;
+    QBENCHMARK_ONCE
+    {
+        OpVaultReader reader;
+        QScopedPointer<Database> db(reader.readDatabase(opVaultDir, "a"));
+        QVERIFY(db);
+        entries = db->rootGroup()->entriesRecursive().size();
+    }
+    QCOMPARE(entries, sampleEntries * copies);
+}
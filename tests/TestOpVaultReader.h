@@ -28,6 +28,7 @@ class TestOpVaultReader : public QObject
 private slots:
     void initTestCase();
     void testReadIntoDatabase();
+    void benchmarkReadLargeVault();
 
 private:
     // absolute path to the .opvault directory
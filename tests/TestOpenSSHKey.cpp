@@ -23,6 +23,9 @@
 
 QTEST_GUILESS_MAIN(TestOpenSSHKey)
 
+// bcrypt_pbkdf.cpp
+int bcrypt_pbkdf(const QByteArray& pass, const QByteArray& salt, QByteArray& key, quint32 rounds, bool parallel);
+
 void TestOpenSSHKey::initTestCase()
 {
     QVERIFY(Crypto::init());
@@ -443,3 +446,50 @@ void TestOpenSSHKey::testGenerateRSA()
     QCOMPARE(key.type(), QString("ssh-rsa"));
     QCOMPARE(key.comment(), QString(""));
 }
+
+void TestOpenSSHKey::testBcryptPbkdfParallel()
+{
+    const QByteArray pass("correct horse battery staple");
+    const QByteArray salt = QByteArray::fromHex("6b6565706173737863");
+
+    // 32 bytes is a single block, 48 bytes (AES-256-CTR key and IV) spans two
+    for (int keyLength : {32, 48, 100}) {
+        QByteArray sequential(keyLength, '\0');
+        QByteArray parallel(keyLength, '\0');
+        QCOMPARE(bcrypt_pbkdf(pass, salt, sequential, 4, false), 0);
+        QCOMPARE(bcrypt_pbkdf(pass, salt, parallel, 4, true), 0);
+        QCOMPARE(parallel, sequential);
+    }
+}
+
+void TestOpenSSHKey::benchmarkBcryptPbkdf_data()
+{
+    QTest::addColumn<quint32>("rounds");
+    QTest::addColumn<bool>("parallel");
+
+    for (quint32 rounds : {16, 64, 128}) {
+        QTest::newRow(qPrintable(QString("%1 rounds, sequential").arg(rounds))) << rounds << false;
+        QTest::newRow(qPrintable(QString("%1 rounds, parallel").arg(rounds))) << rounds << true;
+    }
+}
+
+void TestOpenSSHKey::benchmarkBcryptPbkdf()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    QFETCH(quint32, rounds);
+    QFETCH(bool, parallel);
+
+    const QByteArray pass("correct horse battery staple");
+    const QByteArray salt(16, '\x4B');
+    QByteArray key(48, '\0');
+
+    QBENCHMARK
+    {
+        QCOMPARE(bcrypt_pbkdf(pass, salt, key, rounds, parallel), 0);
+    };
+}
@@ -39,6 +39,9 @@ private slots:
     void testDecryptRSAAES256CTR();
     void testDecryptUTF8();
     void testGenerateRSA();
+    void testBcryptPbkdfParallel();
+    void benchmarkBcryptPbkdf_data();
+    void benchmarkBcryptPbkdf();
 };
 
 #endif // TESTOPENSSHKEY_H
@@ -18,6 +18,7 @@
 #include "TestPasswordGenerator.h"
 #include "core/PasswordGenerator.h"
 #include "crypto/Crypto.h"
+#include "crypto/Random.h"
 
 #include <QRegularExpression>
 #include <QTest>
@@ -141,3 +142,77 @@ void TestPasswordGenerator::testLookalikeExclusion()
     regex.setPattern("^[^lI01﹒]+$");
     QVERIFY(regex.match(password).hasMatch());
 }
+
+void TestPasswordGenerator::testGeneratePasswords()
+{
+    PasswordGenerator generator;
+    generator.setCharClasses(PasswordGenerator::CharClass::LowerLetters | PasswordGenerator::CharClass::Numbers);
+    generator.setFlags(PasswordGenerator::GeneratorFlag::CharFromEveryGroup);
+    generator.setLength(8);
+    QVERIFY(generator.isValid());
+
+    QVERIFY(generator.generatePasswords(0).isEmpty());
+
+    const QStringList passwords = generator.generatePasswords(1000);
+    QCOMPARE(passwords.size(), 1000);
+    QRegularExpression regex(R"(^(?=.*[a-z])(?=.*\d)[a-z\d]{8}$)");
+    for (const QString& password : passwords) {
+        QVERIFY2(regex.match(password).hasMatch(), qPrintable(password));
+    }
+    QVERIFY(passwords.toSet().size() > 990);
+}
+
+void TestPasswordGenerator::benchmarkGeneratePasswords_data()
+{
+    QTest::addColumn<int>("mode");
+
+    // "unbuffered" draws every character from randomGen() like generatePassword() used to
+    QTest::newRow("unbuffered") << 0;
+    QTest::newRow("single") << 1;
+    QTest::newRow("batch") << 2;
+}
+
+void TestPasswordGenerator::benchmarkGeneratePasswords()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+
+    if (env.isEmpty() || env == "0" || env == "no") {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    QFETCH(int, mode);
+
+    PasswordGenerator generator;
+    generator.setCharClasses(PasswordGenerator::CharClass::DefaultCharset);
+    generator.setLength(20);
+
+    QVector<QChar> passwordChars;
+    for (char ch = 'a'; ch <= 'z'; ++ch) {
+        passwordChars.append(QChar(ch));
+        passwordChars.append(QChar(ch).toUpper());
+    }
+    for (char ch = '0'; ch <= '9'; ++ch) {
+        passwordChars.append(QChar(ch));
+    }
+
+    const quint32 charCount = static_cast<quint32>(passwordChars.size());
+
+    QBENCHMARK
+    {
+        if (mode == 0) {
+            for (int i = 0; i < 10000; ++i) {
+                QString password;
+                for (int j = 0; j < 20; ++j) {
+                    password.append(passwordChars[randomGen()->randomUInt(charCount)]);
+                }
+                Q_UNUSED(password);
+            }
+        } else if (mode == 1) {
+            for (int i = 0; i < 10000; ++i) {
+                Q_UNUSED(generator.generatePassword());
+            }
+        } else {
+            Q_UNUSED(generator.generatePasswords(10000));
+        }
+    };
+}
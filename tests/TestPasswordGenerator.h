@@ -29,6 +29,9 @@ private slots:
     void testAdditionalChars();
     void testCharClasses();
     void testLookalikeExclusion();
+    void testGeneratePasswords();
+    void benchmarkGeneratePasswords_data();
+    void benchmarkGeneratePasswords();
 };
 
 #endif // KEEPASSXC_TESTPASSWORDGENERATOR_H
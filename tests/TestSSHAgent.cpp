@@ -19,10 +19,56 @@
 #include "TestGlobal.h"
 #include "core/Config.h"
 #include "crypto/Crypto.h"
+#include "crypto/ssh/BinaryStream.h"
 #include "sshagent/SSHAgent.h"
 
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSemaphore>
+#include <QtConcurrent>
+
 QTEST_GUILESS_MAIN(TestSSHAgent)
 
+namespace
+{
+    /**
+     * Minimal stand-in for an agent: answers every request with SSH_AGENT_SUCCESS
+     * and reports how many requests arrived on each connection.
+     */
+    QList<int> runStandInAgent(const QString& socketName, int expectedRequests, QSemaphore* listening)
+    {
+        QList<int> requestsPerConnection;
+
+        QLocalServer server;
+        const bool isListening = server.listen(socketName);
+        listening->release();
+        if (!isListening) {
+            return requestsPerConnection;
+        }
+
+        int total = 0;
+        while (total < expectedRequests && server.waitForNewConnection(5000)) {
+            QLocalSocket* socket = server.nextPendingConnection();
+            BinaryStream stream(socket);
+            stream.setTimeout(5000);
+
+            int count = 0;
+            QByteArray request;
+            while (total < expectedRequests && stream.readString(request)) {
+                stream.writeString(QByteArray(1, 6));
+                stream.flush();
+                ++count;
+                ++total;
+            }
+
+            requestsPerConnection << count;
+            socket->waitForDisconnected(5000);
+        }
+
+        return requestsPerConnection;
+    }
+} // namespace
+
 void TestSSHAgent::initTestCase()
 {
     QVERIFY(Crypto::init());
@@ -209,6 +255,39 @@ void TestSSHAgent::testConfirmConstraint()
     QVERIFY(agent.checkIdentity(m_key, keyInAgent) && !keyInAgent);
 }
 
+void TestSSHAgent::testPipelinedIdentities()
+{
+    QString socketName =
+        QDir::temp().absoluteFilePath(QString("keepassxc-agent-standin-%1").arg(QCoreApplication::applicationPid()));
+    QLocalServer::removeServer(socketName);
+
+    const int keyCount = 3;
+    QSemaphore listening;
+    QFuture<QList<int>> standIn = QtConcurrent::run(runStandInAgent, socketName, keyCount, &listening);
+    listening.acquire();
+
+    SSHAgent agent;
+    agent.setEnabled(true);
+    agent.setAuthSockOverride(socketName);
+
+    QVERIFY(agent.isAgentRunning());
+
+    KeeAgentSettings settings;
+    QList<SSHAgent::Identity> identities;
+    for (int i = 0; i < keyCount; ++i) {
+        identities.append(SSHAgent::Identity{m_key, settings, false, {}});
+    }
+
+    QVERIFY(agent.addIdentities(identities, m_uuid));
+    for (const auto& identity : identities) {
+        QVERIFY(identity.added);
+        QVERIFY(identity.error.isEmpty());
+    }
+
+    // all requests must have been sent over one connection
+    QCOMPARE(standIn.result(), QList<int>() << keyCount);
+}
+
 void TestSSHAgent::cleanupTestCase()
 {
     if (m_agentProcess.state() != QProcess::NotRunning) {
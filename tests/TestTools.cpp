@@ -17,9 +17,17 @@
 
 #include "TestTools.h"
 
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QLocale>
+#include <QTemporaryDir>
 #include <QTest>
 
+#include "config-keepassx.h"
+#include "core/Trace.h"
+
 QTEST_GUILESS_MAIN(TestTools)
 
 namespace
@@ -89,3 +97,47 @@ void TestTools::testEnvSubstitute()
     QCOMPARE(Tools::envSubstitute("start/$EMPTY$$EMPTY$HOME/end", environment), QString("start/$/home/user/end"));
 #endif
 }
+
+void TestTools::testTrace()
+{
+#ifndef WITH_XC_TRACING
+    QSKIP("Tracing is not enabled in this build.");
+#else
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString fileName = tempDir.filePath("trace.json");
+
+    {
+        TRACE_SCOPE("not recorded");
+    }
+    QVERIFY(!Trace::isEnabled());
+    QVERIFY(Trace::start(fileName));
+    QVERIFY(Trace::isEnabled());
+    QVERIFY(!Trace::start(fileName));
+
+    {
+        TRACE_SCOPE("outer");
+        TRACE_SCOPE("inner");
+    }
+
+    QVERIFY(Trace::finish());
+    QVERIFY(!Trace::isEnabled());
+    QVERIFY(!Trace::finish());
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QJsonObject trace = QJsonDocument::fromJson(file.readAll()).object();
+    const QJsonArray events = trace["traceEvents"].toArray();
+    QCOMPARE(events.size(), 2);
+
+    // Spans are recorded when they end
+    const QJsonObject inner = events.at(0).toObject();
+    const QJsonObject outer = events.at(1).toObject();
+    QCOMPARE(inner["name"].toString(), QString("inner"));
+    QCOMPARE(outer["name"].toString(), QString("outer"));
+    QCOMPARE(outer["ph"].toString(), QString("X"));
+    QCOMPARE(outer["tid"].toInt(), inner["tid"].toInt());
+    QVERIFY(outer["ts"].toDouble() <= inner["ts"].toDouble());
+    QVERIFY(outer["dur"].toDouble() >= inner["dur"].toDouble());
+#endif
+}
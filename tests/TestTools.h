@@ -28,6 +28,7 @@ private slots:
     void testIsHex();
     void testIsBase64();
     void testEnvSubstitute();
+    void testTrace();
 };
 
 #endif // KEEPASSX_TESTTOOLS_H
@@ -0,0 +1,189 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmarks.h"
+
+#include <QBuffer>
+#include <QTest>
+
+#include "config-keepassx.h"
+#include "core/CsvParser.h"
+#include "core/Database.h"
+#include "core/EntrySearcher.h"
+#include "core/Group.h"
+#include "core/Merger.h"
+#include "core/PasswordHealth.h"
+#include "crypto/Crypto.h"
+#include "format/CsvExporter.h"
+#include "format/KeePass2Reader.h"
+#include "format/KeePass2Writer.h"
+#include "gui/entry/EntryModel.h"
+#include "util/TemporaryFile.h"
+#ifdef WITH_XC_BROWSER
+#include "browser/BrowserService.h"
+#include "browser/BrowserSettings.h"
+#endif
+
+QTEST_GUILESS_MAIN(Benchmarks)
+
+void Benchmarks::initTestCase()
+{
+    QVERIFY(Crypto::init());
+
+    const int entryCount = qEnvironmentVariableIntValue("BENCHMARK_ENTRIES");
+    if (entryCount > 0) {
+        m_options.entryCount = entryCount;
+        m_options.groupCount = qMax(entryCount / 50, 1);
+        m_options.attachmentCount = qMax(entryCount / 100, 1);
+    }
+
+    m_db = DatabaseGenerator(m_options).generate();
+    QCOMPARE(m_db->entries().size(), m_options.entryCount);
+}
+
+void Benchmarks::benchmarkWriteKdbx()
+{
+    QBENCHMARK
+    {
+        QBuffer buffer;
+        buffer.open(QBuffer::ReadWrite);
+        KeePass2Writer writer;
+        QVERIFY2(writer.writeDatabase(&buffer, m_db.data()), qPrintable(writer.errorString()));
+    }
+}
+
+void Benchmarks::benchmarkReadKdbx()
+{
+    QBuffer buffer;
+    buffer.open(QBuffer::ReadWrite);
+    KeePass2Writer writer;
+    QVERIFY2(writer.writeDatabase(&buffer, m_db.data()), qPrintable(writer.errorString()));
+
+    QBENCHMARK
+    {
+        buffer.seek(0);
+        Database db;
+        KeePass2Reader reader;
+        QVERIFY2(reader.readDatabase(&buffer, m_db->key(), &db), qPrintable(reader.errorString()));
+    }
+}
+
+void Benchmarks::benchmarkSearch_data()
+{
+    QTest::addColumn<QString>("searchString");
+
+    QTest::newRow("Default fields") << QString("entry 12");
+    QTest::newRow("Username") << QString("user:user12");
+    QTest::newRow("URL") << QString("url:example.com");
+    QTest::newRow("Group path") << QString("group:/*/group 1*");
+    QTest::newRow("Several terms") << QString("user:user1 url:https -title:abc");
+}
+
+void Benchmarks::benchmarkSearch()
+{
+    QFETCH(QString, searchString);
+
+    EntrySearcher searcher;
+    QBENCHMARK
+    {
+        searcher.search(searchString, m_db->rootGroup());
+    }
+}
+
+void Benchmarks::benchmarkMerge()
+{
+    // The same options generate the same database, change every tenth entry of the source
+    auto source = DatabaseGenerator(m_options).generate();
+    auto target = DatabaseGenerator(m_options).generate();
+    const QList<Entry*> entries = source->entries();
+    for (int i = 0; i < entries.size(); i += 10) {
+        TimeInfo timeInfo = entries.at(i)->timeInfo();
+        entries.at(i)->setPassword(QString("changed %1").arg(i));
+        timeInfo.setLastModificationTime(timeInfo.lastModificationTime().addDays(1));
+        entries.at(i)->setTimeInfo(timeInfo);
+    }
+
+    // Merging changes the target, so it can only be measured once
+    QStringList changes;
+    QBENCHMARK_ONCE
+    {
+        Merger merger(source.data(), target.data());
+        changes = merger.merge();
+    }
+    QVERIFY(!changes.isEmpty());
+}
+
+void Benchmarks::benchmarkBrowserSearch()
+{
+#ifdef WITH_XC_BROWSER
+    browserSettings()->setBestMatchOnly(false);
+    const QString url = m_db->entries().at(m_options.entryCount / 2)->url();
+
+    QList<Entry*> result;
+    QBENCHMARK
+    {
+        result = browserService()->searchEntries(m_db, url, url);
+    }
+    QVERIFY(!result.isEmpty());
+#else
+    QSKIP("Browser integration is not enabled.");
+#endif
+}
+
+void Benchmarks::benchmarkEntryModel()
+{
+    const QList<Entry*> entries = m_db->entries();
+    EntryModel model;
+    QBENCHMARK
+    {
+        model.setEntries(entries);
+        for (int row = 0; row < model.rowCount(); ++row) {
+            for (int column = 0; column < model.columnCount(); ++column) {
+                model.data(model.index(row, column), Qt::DisplayRole);
+            }
+        }
+    }
+}
+
+void Benchmarks::benchmarkCsvParser()
+{
+    TemporaryFile file;
+    QVERIFY(file.open());
+    CsvExporter exporter;
+    QVERIFY2(exporter.exportDatabase(&file, m_db), qPrintable(exporter.errorString()));
+    file.close();
+
+    CsvParser parser;
+    QVERIFY(parser.parse(&file));
+    QBENCHMARK
+    {
+        QVERIFY(parser.reparse());
+    }
+    QCOMPARE(parser.getCsvRows(), m_options.entryCount + 1);
+}
+
+void Benchmarks::benchmarkHealthChecker()
+{
+    const QList<Entry*> entries = m_db->entries();
+    QBENCHMARK
+    {
+        HealthChecker checker(m_db);
+        for (const Entry* entry : entries) {
+            checker.evaluate(entry);
+        }
+    }
+}
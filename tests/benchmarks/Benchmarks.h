@@ -0,0 +1,56 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BENCHMARKS_H
+#define KEEPASSXC_BENCHMARKS_H
+
+#include <QObject>
+#include <QSharedPointer>
+
+#include "util/DatabaseGenerator.h"
+
+class Database;
+
+/**
+ * Performance benchmarks on a generated database.
+ *
+ * The database size can be changed with the BENCHMARK_ENTRIES environment
+ * variable. Run with "-o results.xml,xml" (or the run-benchmarks target)
+ * for machine-readable results.
+ */
+class Benchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void benchmarkWriteKdbx();
+    void benchmarkReadKdbx();
+    void benchmarkSearch_data();
+    void benchmarkSearch();
+    void benchmarkMerge();
+    void benchmarkBrowserSearch();
+    void benchmarkEntryModel();
+    void benchmarkCsvParser();
+    void benchmarkHealthChecker();
+
+private:
+    DatabaseGenerator::Options m_options;
+    QSharedPointer<Database> m_db;
+};
+
+#endif // KEEPASSXC_BENCHMARKS_H
@@ -17,6 +17,7 @@
 
 #include "TestGuiPixmaps.h"
 #include "TestGlobal.h"
+#include "core/Clock.h"
 #include "core/DatabaseIcons.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
@@ -79,4 +80,61 @@ void TestGuiPixmaps::testGroupIcons()
     QCOMPARE(pixmap.cacheKey(), db->metadata()->customIconPixmap(iconUuid).cacheKey());
 }
 
+void TestGuiPixmaps::testCustomIconCache()
+{
+    QScopedPointer<Database> db(new Database());
+    auto metadata = db->metadata();
+
+    QList<QUuid> iconUuids;
+    for (int i = 0; i < 20; ++i) {
+        QImage icon(64, 64, QImage::Format_RGB32);
+        icon.fill(qRgb(i, 0, 50));
+        iconUuids << QUuid::createUuid();
+        metadata->addCustomIcon(iconUuids.last(), icon);
+    }
+
+    // Pixmaps are created once per size and badge
+    auto pixmap = metadata->customIconPixmap(iconUuids[0]);
+    QCOMPARE(metadata->customIconPixmap(iconUuids[0]).cacheKey(), pixmap.cacheKey());
+    QCOMPARE(pixmap.width(), qRound(databaseIcons()->iconSize(IconSize::Default) * pixmap.devicePixelRatio()));
+
+    auto largePixmap = metadata->customIconPixmap(iconUuids[0], IconSize::Large);
+    QVERIFY(largePixmap.cacheKey() != pixmap.cacheKey());
+    QCOMPARE(metadata->customIconPixmap(iconUuids[0], IconSize::Large).cacheKey(), largePixmap.cacheKey());
+    QCOMPARE(largePixmap.width(),
+             qRound(databaseIcons()->iconSize(IconSize::Large) * largePixmap.devicePixelRatio()));
+
+    auto expiredPixmap = metadata->customIconPixmap(iconUuids[0], IconSize::Default, DatabaseIcons::Badges::Expired);
+    QVERIFY(expiredPixmap.cacheKey() != pixmap.cacheKey());
+    QCOMPARE(expiredPixmap.size(), pixmap.size());
+    QCOMPARE(metadata->customIconPixmap(iconUuids[0], IconSize::Default, DatabaseIcons::Badges::Expired).cacheKey(),
+             expiredPixmap.cacheKey());
+
+    // The remaining icons are scaled in the background
+    QTest::qWait(100);
+    for (const auto& uuid : asConst(iconUuids)) {
+        QCOMPARE(metadata->customIconPixmap(uuid).size(), pixmap.size());
+    }
+
+    // Expired entries get the badged pixmap from the cache
+    Entry* entry = new Entry();
+    entry->setGroup(db->rootGroup());
+    entry->setIcon(iconUuids[0]);
+    QCOMPARE(entry->iconPixmap().cacheKey(), pixmap.cacheKey());
+    entry->setExpires(true);
+    entry->setExpiryTime(Clock::currentDateTimeUtc().addDays(-1));
+    QCOMPARE(entry->iconPixmap().cacheKey(), expiredPixmap.cacheKey());
+
+    // Pixmaps are dropped along with their icon
+    metadata->removeCustomIcon(iconUuids[0]);
+    QVERIFY(metadata->customIconPixmap(iconUuids[0]).isNull());
+
+    QImage icon(64, 64, QImage::Format_RGB32);
+    icon.fill(qRgb(0, 50, 0));
+    metadata->addCustomIcon(iconUuids[0], icon);
+    auto newPixmap = metadata->customIconPixmap(iconUuids[0]);
+    QVERIFY(newPixmap.cacheKey() != pixmap.cacheKey());
+    QCOMPARE(newPixmap.toImage().pixel(0, 0), qRgb(0, 50, 0));
+}
+
 QTEST_MAIN(TestGuiPixmaps)
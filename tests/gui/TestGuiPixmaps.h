@@ -31,6 +31,7 @@ private slots:
     void testDatabaseIcons();
     void testEntryIcons();
     void testGroupIcons();
+    void testCustomIconCache();
 };
 
 #endif // KEEPASSX_TESTGUIPIXMAPS_H
@@ -0,0 +1,177 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseGenerator.h"
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+#include "crypto/kdf/AesKdf.h"
+#include "keys/PasswordKey.h"
+
+namespace
+{
+    const QString Characters("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789");
+    const QDateTime BaseTime(QDate(2020, 1, 1), QTime(0, 0), Qt::UTC);
+
+    TimeInfo timeInfo(int offset)
+    {
+        TimeInfo timeInfo;
+        const QDateTime time = BaseTime.addSecs(offset);
+        timeInfo.setCreationTime(time);
+        timeInfo.setLastModificationTime(time);
+        timeInfo.setLastAccessTime(time);
+        timeInfo.setLocationChanged(time);
+        return timeInfo;
+    }
+} // namespace
+
+DatabaseGenerator::Options::Options()
+    : groupCount(200)
+    , entryCount(10000)
+    , historyCount(3)
+    , attachmentCount(100)
+    , attachmentSize(16 * 1024)
+    , customAttributeCount(2)
+    , protectedRatio(0.5)
+    , reusedPasswordRatio(0.1)
+    , password("benchmark")
+    , seed(1)
+{
+}
+
+DatabaseGenerator::DatabaseGenerator(const Options& options)
+    : m_options(options)
+    , m_random(options.seed)
+{
+}
+
+QSharedPointer<Database> DatabaseGenerator::generate()
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create(m_options.password));
+
+    // Cheap key derivation so benchmarks measure the database code
+    auto kdf = QSharedPointer<AesKdf>::create();
+    kdf->setRounds(1);
+
+    auto db = QSharedPointer<Database>::create();
+    db->setKdf(kdf);
+    db->setKey(key);
+    db->metadata()->setHistoryMaxItems(qMax(m_options.historyCount, 1));
+
+    Group* root = db->rootGroup();
+    root->setUpdateTimeinfo(false);
+    root->setUuid(randomUuid());
+    root->setTimeInfo(timeInfo(0));
+
+    // Random tree, each group is added below one of the groups created before it
+    QList<Group*> groups({root});
+    for (int i = 0; i < m_options.groupCount; ++i) {
+        auto group = new Group();
+        group->setUpdateTimeinfo(false);
+        group->setUuid(randomUuid());
+        group->setName(QString("Group %1").arg(i));
+        group->setTimeInfo(timeInfo(i));
+        group->setParent(groups.at(static_cast<int>(randomInt(groups.size()))));
+        groups.append(group);
+    }
+
+    const int usernameCount = qMax(m_options.entryCount / 10, 1);
+    const int attachmentStride =
+        m_options.attachmentCount > 0 ? qMax(m_options.entryCount / m_options.attachmentCount, 1) : 0;
+    QStringList passwords;
+    int attachments = 0;
+    for (int i = 0; i < m_options.entryCount; ++i) {
+        auto entry = new Entry();
+        entry->setUpdateTimeinfo(false);
+        entry->setUuid(randomUuid());
+        entry->setTitle(QString("Entry %1 %2").arg(i).arg(randomString(8)));
+        entry->setUsername(QString("user%1").arg(randomInt(usernameCount)));
+        entry->setUrl(QString("https://%1.example.com/login").arg(randomString(8).toLower()));
+        entry->setNotes(randomString(64));
+
+        if (!passwords.isEmpty() && chance(m_options.reusedPasswordRatio)) {
+            entry->setPassword(passwords.at(static_cast<int>(randomInt(passwords.size()))));
+        } else {
+            passwords.append(randomString(16));
+            entry->setPassword(passwords.last());
+        }
+
+        for (int j = 0; j < m_options.customAttributeCount; ++j) {
+            entry->attributes()->set(QString("Custom %1").arg(j), randomString(16), chance(m_options.protectedRatio));
+        }
+
+        if (attachmentStride > 0 && i % attachmentStride == 0 && attachments < m_options.attachmentCount) {
+            entry->attachments()->set("attachment.bin", randomBytes(m_options.attachmentSize));
+            ++attachments;
+        }
+
+        // Older versions differ in their password
+        for (int j = 0; j < m_options.historyCount; ++j) {
+            auto historyItem = entry->clone(Entry::CloneNoFlags);
+            historyItem->setUpdateTimeinfo(false);
+            historyItem->setPassword(randomString(16));
+            historyItem->setTimeInfo(timeInfo(i + j));
+            entry->addHistoryItem(historyItem);
+        }
+
+        entry->setTimeInfo(timeInfo(i + m_options.historyCount));
+        entry->setGroup(groups.at(static_cast<int>(randomInt(groups.size()))));
+    }
+
+    return db;
+}
+
+/**
+ * Not std::uniform_int_distribution, its results differ between standard libraries.
+ */
+quint32 DatabaseGenerator::randomInt(quint32 bound)
+{
+    return static_cast<quint32>(m_random() % bound);
+}
+
+bool DatabaseGenerator::chance(double ratio)
+{
+    return m_random() < ratio * 4294967296.0;
+}
+
+QString DatabaseGenerator::randomString(int length)
+{
+    QString string;
+    string.reserve(length);
+    for (int i = 0; i < length; ++i) {
+        string.append(Characters.at(static_cast<int>(randomInt(Characters.size()))));
+    }
+    return string;
+}
+
+QByteArray DatabaseGenerator::randomBytes(int length)
+{
+    QByteArray bytes;
+    bytes.reserve(length);
+    for (int i = 0; i < length; ++i) {
+        bytes.append(static_cast<char>(m_random() & 0xFF));
+    }
+    return bytes;
+}
+
+QUuid DatabaseGenerator::randomUuid()
+{
+    return QUuid::fromRfc4122(randomBytes(16));
+}
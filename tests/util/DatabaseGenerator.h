@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DATABASEGENERATOR_H
+#define KEEPASSXC_DATABASEGENERATOR_H
+
+#include <QSharedPointer>
+#include <QStringList>
+#include <QUuid>
+
+#include <random>
+
+class Database;
+
+/**
+ * Builds synthetic databases for benchmarks.
+ *
+ * The same options always produce the same database, including UUIDs,
+ * time stamps and random field contents, so results can be compared
+ * between builds.
+ */
+class DatabaseGenerator
+{
+public:
+    struct Options
+    {
+        Options();
+
+        int groupCount;
+        int entryCount;
+        // history items of every entry
+        int historyCount;
+        // number of entries with an attachment, spread evenly over all entries
+        int attachmentCount;
+        int attachmentSize;
+        // custom attributes of every entry
+        int customAttributeCount;
+        // share of custom attributes that are protected
+        double protectedRatio;
+        // share of entries reusing the password of another entry
+        double reusedPasswordRatio;
+        QString password;
+        quint32 seed;
+    };
+
+    explicit DatabaseGenerator(const Options& options = Options());
+
+    QSharedPointer<Database> generate();
+
+private:
+    quint32 randomInt(quint32 bound);
+    bool chance(double ratio);
+    QString randomString(int length);
+    QByteArray randomBytes(int length);
+    QUuid randomUuid();
+
+    Options m_options;
+    std::mt19937 m_random;
+};
+
+#endif // KEEPASSXC_DATABASEGENERATOR_H